@@ -0,0 +1,98 @@
+//-------------------------------------------------------------------------------------
+// BatchRunner.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * Runs a batch of independent, indexed tasks on every core with work stealing.
+ * Each worker starts with an equal slice of the index range and takes tasks from the front of it.
+ * A worker that runs dry steals the back half of another worker's remaining slice, so a few slow
+ * tasks can't leave the other threads idle.
+ */
+class BatchRunner
+{
+public:
+	/**
+	 * A task. Called once for every index in the batch, with the index of the worker running it.
+	 */
+	typedef std::function<void(int workerIndex, std::uint64_t taskIndex)> Task;
+
+	/**
+	 * Constructor.
+	 * @param threadCount The number of worker threads, including the calling thread. 0 uses every core.
+	 */
+	explicit BatchRunner(int threadCount = 0);
+
+	/**
+	 * Runs a task for every index in [0, taskCount) and waits for all of them to finish.
+	 * @param taskCount The number of tasks in the batch.
+	 * @param task The task to run.
+	 */
+	void Run(std::uint64_t taskCount, const Task& task);
+
+	/**
+	 * Gets the number of worker threads.
+	 * @return The number of workers, including the calling thread.
+	 */
+	int GetThreadCount() const;
+
+	/**
+	 * Gets the number of successful steals during the last Run().
+	 * @return The number of steals.
+	 */
+	std::uint64_t GetStealCount() const;
+
+private:
+	/**
+	 * The slice of the index range a worker still has to run. Padded to a cache line so workers don't false share.
+	 */
+	struct Slice {
+		std::mutex lock;					// Guards begin and end.
+		std::uint64_t begin;				// The next index the owner runs.
+		std::uint64_t end;					// One past the last index of the slice.
+		char padding[64];					// Keeps neighbouring slices on separate cache lines.
+	};
+
+	/**
+	 * Runs tasks from a worker's own slice, stealing when it is empty, until no work is left.
+	 * @param workerIndex The index of the worker.
+	 * @param task The task to run.
+	 */
+	void Work(int workerIndex, const Task& task);
+
+	/**
+	 * Moves the back half of another worker's slice into the given worker's slice.
+	 * @param workerIndex The index of the thief.
+	 * @return True if any work was stolen.
+	 */
+	bool Steal(int workerIndex);
+
+private:
+	/**
+	 * The number of worker threads, including the calling thread.
+	 */
+	int m_threadCount;
+
+	/**
+	 * One slice per worker.
+	 */
+	std::unique_ptr<Slice[]> m_slices;
+
+	/**
+	 * The number of successful steals during the last run.
+	 */
+	std::atomic<std::uint64_t> m_stealCount;
+};
+#endif
@@ -0,0 +1,118 @@
+//-------------------------------------------------------------------------------------
+// ChangeJournal.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef CHANGEJOURNAL_H
+#define CHANGEJOURNAL_H
+
+#include <cstdint>
+#include <vector>
+
+// The number of changes the journal keeps. A subscriber that falls further behind has to rebuild everything.
+static int const CHANGE_JOURNAL_CAPACITY = 256;
+
+/**
+ * A rectangle of tiles that changed.
+ */
+struct DirtyRegion {
+	int firstColumn;						// The leftmost column of the rectangle.
+	int firstRow;							// The top row of the rectangle.
+	int lastColumn;							// The rightmost column of the rectangle.
+	int lastRow;							// The bottom row of the rectangle.
+	std::uint32_t version;					// The journal version the change was recorded as.
+	bool solidityChanged;					// True if a tile in the rectangle became passable or blocked.
+};
+
+/**
+ * A journal of the rectangles of tiles that changed, each stamped with a version.
+ * Systems that keep data derived from the tiles, such as renderers, light maps, path caches and flow fields,
+ * remember the version they last caught up with and ask for the changes since, so they only rebuild the touched
+ * area. The journal keeps the last CHANGE_JOURNAL_CAPACITY changes in a ring. A reset, e.g. when a new level is
+ * loaded, and falling too far behind both tell the subscriber to rebuild everything.
+ */
+class ChangeJournal
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	ChangeJournal();
+
+	/**
+	 * Forgets every change and starts a new version, so every subscriber rebuilds everything.
+	 * Call this when the whole grid is replaced.
+	 */
+	void Reset();
+
+	/**
+	 * Records a changed rectangle of tiles.
+	 * @param firstColumn The leftmost column of the rectangle.
+	 * @param firstRow The top row of the rectangle.
+	 * @param lastColumn The rightmost column of the rectangle.
+	 * @param lastRow The bottom row of the rectangle.
+	 * @param solidityChanged True if a tile in the rectangle became passable or blocked.
+	 * @return The version of the change.
+	 */
+	std::uint32_t Record(int firstColumn, int firstRow, int lastColumn, int lastRow, bool solidityChanged);
+
+	/**
+	 * Gets the version of the latest change or reset.
+	 * @return The version. Subscribers store it once they have caught up.
+	 */
+	std::uint32_t GetVersion() const;
+
+	/**
+	 * Gets the changes made after a version.
+	 * @param since The version the subscriber last caught up with.
+	 * @param regions Receives the changed rectangles, oldest first. The vector is cleared first.
+	 * @return True if the rectangles cover every change. False if the subscriber has to rebuild everything.
+	 */
+	bool GetChangesSince(std::uint32_t since, std::vector<DirtyRegion>& regions) const;
+
+	/**
+	 * Gets one rectangle bounding every change made after a version.
+	 * @param since The version the subscriber last caught up with.
+	 * @param bounds Receives the bounding rectangle, stamped with the latest version, with solidityChanged set if
+	 * any of the changes had it set. Only written if there were changes.
+	 * @return False if the subscriber has to rebuild everything, or nothing changed.
+	 */
+	bool GetDirtyBounds(std::uint32_t since, DirtyRegion& bounds) const;
+
+	/**
+	 * Checks if a subscriber can catch up from a version with the changes kept.
+	 * @param since The version the subscriber last caught up with.
+	 * @return False if the subscriber has to rebuild everything.
+	 */
+	bool CanCatchUp(std::uint32_t since) const;
+
+private:
+	/**
+	 * The kept changes, in a ring. The latest change is at (m_head - 1).
+	 */
+	std::vector<DirtyRegion> m_regions;
+
+	/**
+	 * The slot the next change is written to.
+	 */
+	int m_head;
+
+	/**
+	 * The number of changes kept.
+	 */
+	int m_count;
+
+	/**
+	 * The version of the latest change or reset.
+	 */
+	std::uint32_t m_version;
+
+	/**
+	 * The version of the last reset.
+	 */
+	std::uint32_t m_resetVersion;
+};
+#endif
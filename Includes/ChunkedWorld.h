@@ -0,0 +1,205 @@
+//-------------------------------------------------------------------------------------
+// ChunkedWorld.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef CHUNKEDWORLD_H
+#define CHUNKEDWORLD_H
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "LevelGrid.h"
+#include "Random.h"
+
+// The width and height of each chunk in tiles.
+static int const CHUNK_SIZE = 32;
+
+/**
+ * An unbounded dungeon made of fixed-size chunks.
+ * Chunks are generated from (seed, chunk coordinate) the first time they are needed and kept in a
+ * least-recently-used resident set. When the set is full the oldest chunk is evicted; if a spill
+ * directory is set, chunks that were modified are written there and read back instead of regenerated.
+ * Tile indices are world indices and can be negative.
+ */
+class ChunkedWorld
+{
+public:
+	/**
+	 * A function that fills a CHUNK_SIZE x CHUNK_SIZE grid for the given seed and chunk coordinate.
+	 */
+	typedef std::function<void(std::uint64_t seed, GridCoord chunk, LevelGrid& grid)> Generator;
+
+	/**
+	 * Constructor.
+	 * @param seed The world seed. Every chunk is derived from it.
+	 * @param maxResidentChunks The most chunks kept in memory at once.
+	 */
+	ChunkedWorld(std::uint64_t seed, int maxResidentChunks);
+
+	/**
+	 * Sets the function used to generate new chunks. Resident chunks are not regenerated.
+	 * @param generator The chunk generator.
+	 */
+	void SetGenerator(Generator generator);
+
+	/**
+	 * Sets a directory that modified chunks are written to when evicted. An empty path disables spilling.
+	 * @param directory The path of an existing, writable directory.
+	 */
+	void SetSpillDirectory(const std::string& directory);
+
+	/**
+	 * Gets the type of the tile at the given world indices, generating its chunk if needed.
+	 * @param columnIndex The world column of the tile.
+	 * @param rowIndex The world row of the tile.
+	 * @return The type of the tile.
+	 */
+	TILE GetTileType(int columnIndex, int rowIndex);
+
+	/**
+	 * Sets the type of the tile at the given world indices, generating its chunk if needed.
+	 * @param columnIndex The world column of the tile.
+	 * @param rowIndex The world row of the tile.
+	 * @param tileType The new type of the tile.
+	 */
+	void SetTileType(int columnIndex, int rowIndex, TILE tileType);
+
+	/**
+	 * Returns true if the tile at the given world indices blocks movement.
+	 * @param columnIndex The world column of the tile.
+	 * @param rowIndex The world row of the tile.
+	 * @return True if the tile is solid.
+	 */
+	bool IsSolid(int columnIndex, int rowIndex);
+
+	/**
+	 * Makes every chunk within the given radius of a tile resident, and marks them as recently used.
+	 * Call this as the player or camera moves so chunks are ready before they are needed.
+	 * @param columnIndex The world column at the center of the area.
+	 * @param rowIndex The world row at the center of the area.
+	 * @param chunkRadius The radius of the area, in chunks.
+	 */
+	void UpdateResidentArea(int columnIndex, int rowIndex, int chunkRadius);
+
+	/**
+	 * Gets the chunk with the given coordinate, loading or generating it if needed.
+	 * The returned pointer is only valid until the next call that may evict a chunk.
+	 * @param chunk The chunk coordinate.
+	 * @return The grid of the chunk.
+	 */
+	const LevelGrid* GetChunk(GridCoord chunk);
+
+	/**
+	 * Gets the number of chunks that are currently in memory.
+	 * @return The number of resident chunks.
+	 */
+	int GetResidentChunkCount() const;
+
+	/**
+	 * Gets the coordinate of the chunk containing the given world indices.
+	 * @param columnIndex The world column of the tile.
+	 * @param rowIndex The world row of the tile.
+	 * @return The chunk coordinate.
+	 */
+	static GridCoord GetChunkCoord(int columnIndex, int rowIndex);
+
+	/**
+	 * The default generator. Builds a walled room with one opening per side, lined up with the neighbouring chunks.
+	 * @param seed The world seed.
+	 * @param chunk The chunk coordinate.
+	 * @param grid The grid to fill.
+	 */
+	static void GenerateRoomChunk(std::uint64_t seed, GridCoord chunk, LevelGrid& grid);
+
+private:
+	/**
+	 * A resident chunk.
+	 */
+	struct Chunk {
+		LevelGrid grid;									// The tiles of the chunk.
+		std::list<std::uint64_t>::iterator lruPosition;	// The chunk's position in the LRU list.
+		bool isModified;								// True if the chunk differs from what the generator produces.
+	};
+
+	/**
+	 * Gets a resident chunk, loading or generating it if needed, and marks it as most recently used.
+	 * @param chunk The chunk coordinate.
+	 * @return The chunk.
+	 */
+	Chunk& Acquire(GridCoord chunk);
+
+	/**
+	 * Evicts least-recently-used chunks until the resident set fits its capacity, keeping the given chunk.
+	 * @param keep The key of the chunk that must stay resident.
+	 */
+	void EvictExcess(std::uint64_t keep);
+
+	/**
+	 * Builds the path of the spill file for a chunk.
+	 * @param key The chunk key.
+	 * @return The path of the file.
+	 */
+	std::string GetSpillPath(std::uint64_t key) const;
+
+	/**
+	 * Packs a chunk coordinate into a map key.
+	 * @param chunk The chunk coordinate.
+	 * @return The key.
+	 */
+	static std::uint64_t GetKey(GridCoord chunk);
+
+	/**
+	 * Unpacks a map key into a chunk coordinate.
+	 * @param key The key.
+	 * @return The chunk coordinate.
+	 */
+	static GridCoord GetCoord(std::uint64_t key);
+
+private:
+	/**
+	 * The world seed.
+	 */
+	std::uint64_t m_seed;
+
+	/**
+	 * The most chunks kept in memory at once.
+	 */
+	int m_maxResidentChunks;
+
+	/**
+	 * The function used to generate new chunks.
+	 */
+	Generator m_generator;
+
+	/**
+	 * The directory modified chunks are spilled to. Empty if spilling is disabled.
+	 */
+	std::string m_spillDirectory;
+
+	/**
+	 * All resident chunks by key.
+	 */
+	std::unordered_map<std::uint64_t, Chunk> m_chunks;
+
+	/**
+	 * Resident chunk keys, most recently used first.
+	 */
+	std::list<std::uint64_t> m_lru;
+
+	/**
+	 * The key of the chunk used last, so repeated lookups in one chunk skip the map.
+	 */
+	std::uint64_t m_lastKey;
+
+	/**
+	 * The chunk used last, or nullptr.
+	 */
+	Chunk* m_lastChunk;
+};
+#endif
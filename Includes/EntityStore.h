@@ -0,0 +1,356 @@
+//-------------------------------------------------------------------------------------
+// EntityStore.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef ENTITYSTORE_H
+#define ENTITYSTORE_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * A reference to an entity that stays valid while the entity lives, however the store is rearranged.
+ */
+struct EntityHandle {
+	int slot;								// The slot the entity was given. -1 for no entity.
+	std::uint32_t generation;				// The generation of the slot when the entity was created.
+};
+
+/**
+ * Entities kept as a structure of arrays: every component is its own contiguous array, and the living entities are
+ * packed at the front of all of them, so systems walk each array in order with no pointers to chase.
+ * Destroying an entity moves the last one into its place, so indices change; handles don't. A handle names a slot
+ * plus the slot's generation, which is bumped when the entity dies, so stale handles are detected.
+ * Drawing stays with the caller: each entity only stores the index of the sprite it is drawn with, and its frame.
+ * Entities either fly along their velocity with Integrate(), or walk to a target at their speed with Seek().
+ */
+class EntityStore
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	EntityStore();
+
+	/**
+	 * Makes room for a number of entities, so creating that many doesn't allocate.
+	 * @param count The number of entities.
+	 */
+	void Reserve(int count);
+
+	/**
+	 * Creates an entity at a position, at rest, with no health, no target, no flags and a single frame.
+	 * @param x The horizontal position.
+	 * @param y The vertical position.
+	 * @param spriteIndex The index of the sprite the entity is drawn with.
+	 * @return The handle of the entity.
+	 */
+	EntityHandle Create(float x, float y, int spriteIndex);
+
+	/**
+	 * Destroys an entity. The last entity takes its index.
+	 * @param handle The handle of the entity.
+	 * @return False if the entity was already destroyed.
+	 */
+	bool Destroy(EntityHandle handle);
+
+	/**
+	 * Destroys every entity.
+	 */
+	void Clear();
+
+	/**
+	 * Checks if a handle still refers to a living entity.
+	 * @param handle The handle to check.
+	 * @return True if the entity lives.
+	 */
+	bool IsAlive(EntityHandle handle) const;
+
+	/**
+	 * Gets the number of living entities. They are at indices 0 to GetCount() - 1 of every component array.
+	 * @return The number of entities.
+	 */
+	int GetCount() const;
+
+	/**
+	 * Gets the index of an entity in the component arrays.
+	 * @param handle The handle of the entity.
+	 * @return The index, or -1 if the entity was destroyed.
+	 */
+	int GetIndex(EntityHandle handle) const;
+
+	/**
+	 * Gets the handle of the entity at an index.
+	 * @param index The index of the entity.
+	 * @return The handle of the entity.
+	 */
+	EntityHandle GetHandle(int index) const;
+
+	/**
+	 * Moves the entity at an index.
+	 * @param index The index of the entity.
+	 * @param x The horizontal position.
+	 * @param y The vertical position.
+	 */
+	void SetPosition(int index, float x, float y);
+
+	/**
+	 * Sets the velocity of the entity at an index.
+	 * @param index The index of the entity.
+	 * @param x The horizontal velocity, per second.
+	 * @param y The vertical velocity, per second.
+	 */
+	void SetVelocity(int index, float x, float y);
+
+	/**
+	 * Sets how fast the entity at an index spins.
+	 * @param index The index of the entity.
+	 * @param degreesPerSecond The spin.
+	 */
+	void SetSpin(int index, float degreesPerSecond);
+
+	/**
+	 * Sets the speed the entity at an index walks to its targets at.
+	 * @param index The index of the entity.
+	 * @param speed The speed, per second.
+	 */
+	void SetSpeed(int index, float speed);
+
+	/**
+	 * Gives the entity at an index a position to walk to with Seek().
+	 * @param index The index of the entity.
+	 * @param x The horizontal position of the target.
+	 * @param y The vertical position of the target.
+	 */
+	void SetTarget(int index, float x, float y);
+
+	/**
+	 * Checks if the entity at an index is walking to a target.
+	 * @param index The index of the entity.
+	 * @return True until the entity reaches its target.
+	 */
+	bool HasTarget(int index) const;
+
+	/**
+	 * Sets the flags of the entity at an index. Their meaning is up to the caller.
+	 * @param index The index of the entity.
+	 * @param flags The flags.
+	 */
+	void SetFlags(int index, std::uint32_t flags);
+
+	/**
+	 * Sets the health of the entity at an index.
+	 * @param index The index of the entity.
+	 * @param health The health.
+	 */
+	void SetHealth(int index, int health);
+
+	/**
+	 * Deals damage to the entity at an index.
+	 * @param index The index of the entity.
+	 * @param damage The damage to deal.
+	 * @return True if the entity has no health left.
+	 */
+	bool Damage(int index, int damage);
+
+	/**
+	 * Sets the animation of the entity at an index, starting from the first frame.
+	 * @param index The index of the entity.
+	 * @param frameCount The number of frames.
+	 * @param framesPerSecond The speed the frames play at. 0 doesn't animate.
+	 */
+	void SetAnimation(int index, int frameCount, float framesPerSecond);
+
+	/**
+	 * Changes the sprite the entity at an index is drawn with, keeping its frame, e.g. to turn it to face another way.
+	 * @param index The index of the entity.
+	 * @param spriteIndex The index of the sprite.
+	 */
+	void SetSpriteIndex(int index, int spriteIndex);
+
+	/**
+	 * Moves every entity along its velocity, and turns it by its spin.
+	 * @param timeDelta The time elapsed since the last update, in seconds.
+	 */
+	void Integrate(float timeDelta);
+
+	/**
+	 * Walks every entity that has a target straight towards it at its speed, and points its velocity the way it walks.
+	 * An entity that reaches its target stops on it and its target is cleared, but it keeps its velocity, so it still
+	 * faces the way it came until it is given another target or stopped. Entities without a target don't move.
+	 * Seek() moves entities itself, so don't Integrate() the same store as well.
+	 * @param timeDelta The time elapsed since the last update, in seconds.
+	 */
+	void Seek(float timeDelta);
+
+	/**
+	 * Advances the frame of every animated entity.
+	 * @param timeDelta The time elapsed since the last update, in seconds.
+	 */
+	void Animate(float timeDelta);
+
+	/**
+	 * Gets the horizontal positions.
+	 * @return A pointer to GetCount() positions.
+	 */
+	const float* GetPositionsX() const;
+
+	/**
+	 * Gets the vertical positions.
+	 * @return A pointer to GetCount() positions.
+	 */
+	const float* GetPositionsY() const;
+
+	/**
+	 * Gets the horizontal velocities.
+	 * @return A pointer to GetCount() velocities.
+	 */
+	const float* GetVelocitiesX() const;
+
+	/**
+	 * Gets the vertical velocities.
+	 * @return A pointer to GetCount() velocities.
+	 */
+	const float* GetVelocitiesY() const;
+
+	/**
+	 * Gets the rotations, in degrees from 0 to 360.
+	 * @return A pointer to GetCount() rotations.
+	 */
+	const float* GetRotations() const;
+
+	/**
+	 * Gets the flags.
+	 * @return A pointer to GetCount() flags.
+	 */
+	const std::uint32_t* GetFlags() const;
+
+	/**
+	 * Gets the health.
+	 * @return A pointer to GetCount() health values.
+	 */
+	const int* GetHealth() const;
+
+	/**
+	 * Gets the current frames.
+	 * @return A pointer to GetCount() frame indices.
+	 */
+	const int* GetFrames() const;
+
+	/**
+	 * Gets the indices of the sprites the entities are drawn with.
+	 * @return A pointer to GetCount() sprite indices.
+	 */
+	const int* GetSpriteIndices() const;
+
+private:
+	/**
+	 * The horizontal position of every entity.
+	 */
+	std::vector<float> m_positionsX;
+
+	/**
+	 * The vertical position of every entity.
+	 */
+	std::vector<float> m_positionsY;
+
+	/**
+	 * The horizontal velocity of every entity, per second.
+	 */
+	std::vector<float> m_velocitiesX;
+
+	/**
+	 * The vertical velocity of every entity, per second.
+	 */
+	std::vector<float> m_velocitiesY;
+
+	/**
+	 * The rotation of every entity, in degrees.
+	 */
+	std::vector<float> m_rotations;
+
+	/**
+	 * The spin of every entity, in degrees per second.
+	 */
+	std::vector<float> m_spins;
+
+	/**
+	 * The speed every entity walks to its target at, per second.
+	 */
+	std::vector<float> m_speeds;
+
+	/**
+	 * The horizontal position of every entity's target.
+	 */
+	std::vector<float> m_targetsX;
+
+	/**
+	 * The vertical position of every entity's target.
+	 */
+	std::vector<float> m_targetsY;
+
+	/**
+	 * 1 if an entity is walking to its target, 0 if not.
+	 */
+	std::vector<std::uint8_t> m_hasTargets;
+
+	/**
+	 * The flags of every entity. Their meaning is up to the caller.
+	 */
+	std::vector<std::uint32_t> m_flags;
+
+	/**
+	 * The health of every entity.
+	 */
+	std::vector<int> m_health;
+
+	/**
+	 * The current frame of every entity.
+	 */
+	std::vector<int> m_frames;
+
+	/**
+	 * The number of frames of every entity.
+	 */
+	std::vector<int> m_frameCounts;
+
+	/**
+	 * The time every entity has shown its current frame for, in seconds.
+	 */
+	std::vector<float> m_frameTimes;
+
+	/**
+	 * The time every entity shows each frame for, in seconds. 0 doesn't animate.
+	 */
+	std::vector<float> m_frameDurations;
+
+	/**
+	 * The index of the sprite every entity is drawn with.
+	 */
+	std::vector<int> m_spriteIndices;
+
+	/**
+	 * The slot of every entity.
+	 */
+	std::vector<int> m_slots;
+
+	/**
+	 * The index of the entity in every slot, or -1 if the slot is free.
+	 */
+	std::vector<int> m_slotIndices;
+
+	/**
+	 * The generation of every slot. Bumped when its entity is destroyed.
+	 */
+	std::vector<std::uint32_t> m_slotGenerations;
+
+	/**
+	 * The free slots, ready for reuse.
+	 */
+	std::vector<int> m_freeSlots;
+};
+#endif
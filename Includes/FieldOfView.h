@@ -0,0 +1,179 @@
+//-------------------------------------------------------------------------------------
+// FieldOfView.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef FIELDOFVIEW_H
+#define FIELDOFVIEW_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+
+/**
+ * The tiles that can be seen from a tile, with solid tiles blocking sight, found by symmetric shadowcasting.
+ * Each of the four quadrants around the origin is scanned row by row outwards, narrowing the visible slopes as
+ * walls are met. A floor tile is only seen if its centre is inside the visible slopes, which makes sight
+ * symmetric: if A sees B, B sees A. That lets one field of view around the player answer both what the player
+ * lights and which enemies can see the player. Walls are seen if any part of them is, so lit rooms show their walls.
+ * Sight is read straight from the grid's packed solidity bits. The result is a bitset over the square window
+ * the radius covers, so a query never touches memory outside it.
+ */
+class FieldOfView
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	FieldOfView();
+
+	/**
+	 * Finds the tiles that can be seen from a tile.
+	 * @param grid The grid to look across. Tiles outside it block sight.
+	 * @param origin The tile to look from. It is always visible if it's on the grid.
+	 * @param radius The furthest distance seen, in tiles.
+	 */
+	void Compute(const LevelGrid& grid, GridCoord origin, int radius);
+
+	/**
+	 * Removes every visible tile.
+	 */
+	void Clear();
+
+	/**
+	 * Checks if a tile was seen by the last Compute().
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 * @return True if the tile is visible.
+	 */
+	bool IsVisible(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Checks if a tile corner touches a passable tile that was seen. Light is blended between corners, so this
+	 * lights the floor the origin can see without leaking light through walls onto the floor behind them.
+	 * @param columnIndex The column of the tile whose top left corner to check.
+	 * @param rowIndex The row of the tile whose top left corner to check.
+	 * @return True if one of the four tiles around the corner is a visible, passable tile.
+	 */
+	bool IsCornerVisible(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the number of tiles seen by the last Compute().
+	 * @return The number of visible tiles.
+	 */
+	int GetVisibleCount() const;
+
+private:
+	/**
+	 * A row of a quadrant still to be scanned. Slopes are column / depth through the tile edges, as exact fractions.
+	 */
+	struct ScanRow {
+		int depth;							// The distance of the row from the origin.
+		int startNumerator;					// The slope the visible part of the row starts at.
+		int startDenominator;				// Always positive.
+		int endNumerator;					// The slope the visible part of the row ends at.
+		int endDenominator;					// Always positive.
+	};
+
+	/**
+	 * Scans one quadrant.
+	 * @param quadrant The quadrant, 0 to 3 for up, right, down and left.
+	 */
+	void ScanQuadrant(int quadrant);
+
+	/**
+	 * Checks if a tile blocks sight. Tiles outside the grid do.
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 * @return True if the tile blocks sight.
+	 */
+	bool IsOpaque(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Marks a tile visible, if it's on the grid. The caller keeps to the radius.
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 * @param isOpaque True if the tile blocks sight.
+	 */
+	void Reveal(int columnIndex, int rowIndex, bool isOpaque);
+
+	/**
+	 * Gets the bit of a tile in the window.
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 * @param word Receives the index of the word.
+	 * @param bit Receives the mask of the bit.
+	 * @return False if the tile is outside the window.
+	 */
+	bool GetBit(int columnIndex, int rowIndex, int& word, std::uint64_t& bit) const;
+
+private:
+	/**
+	 * The solidity bits of the grid being looked across, row by row. Only valid during Compute().
+	 */
+	const std::uint64_t* m_solid;
+
+	/**
+	 * The number of words per grid row.
+	 */
+	int m_solidWordsPerRow;
+
+	/**
+	 * The width of the grid, in tiles.
+	 */
+	int m_gridWidth;
+
+	/**
+	 * The height of the grid, in tiles.
+	 */
+	int m_gridHeight;
+
+	/**
+	 * The tile looked from.
+	 */
+	GridCoord m_origin;
+
+	/**
+	 * The furthest distance seen, in tiles.
+	 */
+	int m_radius;
+
+	/**
+	 * The furthest column within the radius at every depth, so rows are cut to the circle before they're scanned.
+	 */
+	std::vector<int> m_columnLimits;
+
+	/**
+	 * The side of the window, (2 * radius) + 1 tiles.
+	 */
+	int m_windowSize;
+
+	/**
+	 * The number of words per window row.
+	 */
+	int m_wordsPerRow;
+
+	/**
+	 * A bit per visible tile of the window, row by row.
+	 */
+	std::vector<std::uint64_t> m_visible;
+
+	/**
+	 * A bit per visible, passable tile of the window, row by row.
+	 */
+	std::vector<std::uint64_t> m_visibleOpen;
+
+	/**
+	 * The rows still to be scanned in the current quadrant. Kept so queries don't allocate.
+	 */
+	std::vector<ScanRow> m_rows;
+
+	/**
+	 * The number of visible tiles.
+	 */
+	int m_visibleCount;
+};
+#endif
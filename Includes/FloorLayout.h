@@ -0,0 +1,134 @@
+//-------------------------------------------------------------------------------------
+// FloorLayout.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef FLOORLAYOUT_H
+#define FLOORLAYOUT_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGenerator.h"
+#include "LevelGrid.h"
+
+// The number of rows of rooms a floor can have.
+static int const FLOOR_LAYOUT_ROWS = 3;
+
+// The number of columns of rooms a floor can have.
+static int const FLOOR_LAYOUT_COLUMNS = 10;
+
+// The value of layout cells that hold no room.
+static int const FLOOR_NO_ROOM = -1;
+
+// The number of floors the generator keeps.
+static int const FLOOR_LAYOUT_CACHE_SIZE = 4;
+
+// Directions between neighbouring rooms, as bits of FloorRoom::doors.
+enum class FLOOR_DOOR {
+	UP,
+	RIGHT,
+	DOWN,
+	LEFT,
+	COUNT
+};
+
+/**
+ * A room of a floor, with its tiles generated up front.
+ */
+struct FloorRoom {
+	GridCoord cell;							// The column and row of the room in the floor's layout.
+	int parent;								// The room this one branches off, or FLOOR_NO_ROOM for the first room.
+	std::uint8_t doors;						// One bit per FLOOR_DOOR the room connects through.
+	GridCoord entrance;						// The floor tile inside the room's entrance, where the player arrives.
+	LevelGrid grid;							// The tiles of the room.
+};
+
+/**
+ * The room graph of a floor. Rooms 0 to mainPathLength - 1 lead from the floor's first room to its last one,
+ * each connected to the next. The rooms after those are side rooms that branch off a room they are connected to.
+ */
+struct FloorLayout {
+	std::uint64_t seed;											// The seed the floor was generated from.
+	int floorNumber;											// The number of the floor.
+	int cells[FLOOR_LAYOUT_ROWS][FLOOR_LAYOUT_COLUMNS];			// The room in each cell of the layout, or FLOOR_NO_ROOM.
+	int mainPathLength;											// The number of rooms on the path through the floor.
+	std::vector<FloorRoom> rooms;								// Every room of the floor.
+};
+
+/**
+ * Generates floor layouts and remembers the last few.
+ * A floor only depends on (seed, floor number): the room graph comes from a random walk over the layout cells, and
+ * every room's tiles are generated with a LevelGenerator when the floor is, so moving between rooms is a lookup
+ * and a copy of the room's grid. The most recently used FLOOR_LAYOUT_CACHE_SIZE floors are kept.
+ */
+class FloorLayoutGenerator
+{
+public:
+	/**
+	 * Constructor.
+	 * @param roomWidth The number of columns in every room.
+	 * @param roomHeight The number of rows in every room.
+	 */
+	FloorLayoutGenerator(int roomWidth = GRID_WIDTH, int roomHeight = GRID_HEIGHT);
+
+	/**
+	 * Gets a floor, generating it if it isn't one of the floors kept.
+	 * @param seed The seed of the floor.
+	 * @param floorNumber The number of the floor, from 1.
+	 * @return The floor. The reference stays valid until another floor is generated.
+	 */
+	const FloorLayout& GetFloor(std::uint64_t seed, int floorNumber);
+
+	/**
+	 * Gets the number of floors generated, i.e. GetFloor() calls that missed the kept floors.
+	 * @return The number of generated floors.
+	 */
+	std::uint64_t GetGeneratedCount() const;
+
+private:
+	/**
+	 * Generates a floor.
+	 * @param seed The seed of the floor.
+	 * @param floorNumber The number of the floor.
+	 * @param layout The floor to fill.
+	 */
+	void Generate(std::uint64_t seed, int floorNumber, FloorLayout& layout);
+
+	/**
+	 * Adds a room to a floor, connected to the room it branches off.
+	 * @param layout The floor.
+	 * @param cell The layout cell of the new room. Must be empty.
+	 * @param parent The room the new room branches off, or FLOOR_NO_ROOM.
+	 */
+	void AddRoom(FloorLayout& layout, GridCoord cell, int parent);
+
+private:
+	/**
+	 * Generates the tiles of every room.
+	 */
+	LevelGenerator m_roomGenerator;
+
+	/**
+	 * The floors kept. Slots are reused, so their rooms keep their capacity.
+	 */
+	std::vector<FloorLayout> m_floors;
+
+	/**
+	 * When each kept floor was last used. 0 means the slot is empty.
+	 */
+	std::vector<std::uint64_t> m_lastUsed;
+
+	/**
+	 * Counts GetFloor() calls, to find the least recently used floor.
+	 */
+	std::uint64_t m_useCounter;
+
+	/**
+	 * The number of floors generated.
+	 */
+	std::uint64_t m_generatedCount;
+};
+#endif
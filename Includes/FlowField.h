@@ -0,0 +1,131 @@
+//-------------------------------------------------------------------------------------
+// FlowField.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+
+// The distance of tiles that can't reach the target.
+static int const FLOW_UNREACHABLE = 0x7FFFFFFF;
+
+// The direction stored for tiles that have no step to take.
+static std::uint8_t const FLOW_NO_DIRECTION = 8;
+
+/**
+ * A Dijkstra map: the path cost from every tile to one target tile, plus the first step of the best path.
+ * It is shared by every agent heading for the same target, so each agent reads its next step in O(1)
+ * instead of running its own search. Moves and costs match Pathfinder: 8-connected, no corner cutting.
+ * The field is only rebuilt when the target moves to another tile or the grid's walkability changes.
+ * A rebuild is a single Dijkstra pass using a bucket queue, which is linear in the number of tiles.
+ */
+class FlowField
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	FlowField();
+
+	/**
+	 * Rebuilds the field if the target has moved to another tile, or the field was invalidated.
+	 * @param grid The grid to build the field over. Solid tiles are blocked.
+	 * @param target The tile every step leads towards.
+	 * @return True if the field was rebuilt.
+	 */
+	bool Update(const LevelGrid& grid, GridCoord target);
+
+	/**
+	 * Marks the field as out of date, so the next Update() rebuilds it. Call this when walkability changes.
+	 */
+	void Invalidate();
+
+	/**
+	 * Gets the path cost from a tile to the target.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The cost, or FLOW_UNREACHABLE if the tile is outside the grid or can't reach the target.
+	 */
+	int GetDistance(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the tile to step to from a tile to get closer to the target.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @param next Receives the tile to step to.
+	 * @return True if there is a step to take. False at the target, or if the target can't be reached.
+	 */
+	bool GetNextStep(int columnIndex, int rowIndex, GridCoord& next) const;
+
+	/**
+	 * Gets the tile the field leads towards.
+	 * @return The target tile.
+	 */
+	GridCoord GetTarget() const;
+
+	/**
+	 * Gets the direction of the first step from every tile, stored row by row.
+	 * @return A pointer to one direction per tile of the grid the field was built over. FLOW_NO_DIRECTION means no step.
+	 */
+	const std::uint8_t* GetDirections() const;
+
+	/**
+	 * Gets the tile a direction leads to.
+	 * @param tile The tile to step from.
+	 * @param direction The direction, as returned by GetDirections(). Must not be FLOW_NO_DIRECTION.
+	 * @return The neighbouring tile in that direction.
+	 */
+	static GridCoord Step(GridCoord tile, std::uint8_t direction);
+
+private:
+	/**
+	 * Rebuilds the whole field.
+	 * @param grid The grid to build the field over.
+	 * @param target The tile every step leads towards.
+	 */
+	void Build(const LevelGrid& grid, GridCoord target);
+
+private:
+	/**
+	 * The width of the grid the field was built over.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid the field was built over.
+	 */
+	int m_height;
+
+	/**
+	 * The tile the field leads towards.
+	 */
+	GridCoord m_target;
+
+	/**
+	 * True if the field has to be rebuilt before it is used.
+	 */
+	bool m_isDirty;
+
+	/**
+	 * The path cost from every tile to the target, stored row by row.
+	 */
+	std::vector<int> m_distance;
+
+	/**
+	 * The direction of the first step from every tile, as an index into the neighbour offsets, or FLOW_NO_DIRECTION.
+	 */
+	std::vector<std::uint8_t> m_direction;
+
+	/**
+	 * The bucket queue used while building. Bucket (cost % count) holds the tiles reached at that cost.
+	 */
+	std::vector<std::vector<int>> m_buckets;
+};
+#endif
@@ -12,18 +12,33 @@
 #define GAME_H
 
 #include "Player.h"
-#include "Item.h"
 #include "Level.h"
-#include "Gold.h"
-#include "Key.h"
-#include "Gem.h"
-#include "Potion.h"
-#include "Heart.h"
-#include "Slime.h"
-#include "Humanoid.h"
+#include "SpatialGrid.h"
+#include "LightMap.h"
+#include "LightField.h"
+#include "EntityStore.h"
 
 static float const FPS = 60.0;						// Constant for fixed time - step loop. We'll lock it at 60fps.
 static float const MS_PER_STEP = 1.0f / FPS;		// Roughly (0.017) @ 60fps.
+static double const PATH_REQUEST_FRAME_MICROSECONDS = 1000.0;	// Time each frame may spend on queued path requests.
+static double const NEXT_HOP_FRAME_MICROSECONDS = 1000.0;		// Time each frame may spend rebuilding the next-hop table.
+static int const LIGHT_CELL_SIZE = 50;				// The side of a light grid cell in pixels. Light is blended across cells.
+static float const OBJECT_GRID_CELL_SIZE = TILE_SIZE * 4.f;	// The side of the cells objects are bucketed into for culling.
+static int const PLAYER_SIGHT_RADIUS = 8;			// The distance in tiles the player sees, and is seen by enemies from. Covers the player's light.
+static int const TORCH_SIGHT_RADIUS = 4;			// The distance in tiles a torch sees. Covers its light.
+static int const LIGHT_COLOR_STEP = 6;				// The brightness each level of coloured light adds on top of the darkness.
+static LightColor const TORCH_LIGHT_COLOR = { 6, 4, 2 };		// A warm glow that reddens as it fades.
+static LightColor const PROJECTILE_LIGHT_COLOR = { 1, 3, 5 };	// A cold glow carried by the player's projectiles.
+static float const PROJECTILE_SPEED = 500.f;		// The distance a projectile flies per second.
+static float const PROJECTILE_SPIN = 400.f;			// The degrees a projectile turns per second.
+static int const ENTITY_FRAME_COUNT = 8;			// The frames in an item's strip and an enemy's walking strip. Idle strips have one.
+static float const ENTITY_FRAMES_PER_SECOND = 12.f;	// The speed item and enemy strips play at.
+static float const ITEM_PICKUP_DISTANCE = 40.f;		// How close the player has to get to an item to pick it up.
+static int const GOLD_PICKUP_VALUE = 15;			// The gold a gold pickup gives.
+static int const GEM_PICKUP_SCORE = 50;				// The score a gem gives.
+static int const HEART_PICKUP_HEALTH = 15;			// The health a heart gives.
+static int const PROJECTILE_DAMAGE = 25;			// The damage a projectile deals to an enemy.
+static std::uint32_t const ENEMY_HAS_SEEN_PLAYER = 1;	// Set in an enemy's flags once it has seen the player. It hunts from then on.
 
 class Game
 {
@@ -31,8 +46,10 @@ public:
 	/**
 	 * Constructor.
 	 * @param window A pointer to the main render window.
+	 * @param seed The seed every random stream in the game is derived from.
+	 * @param isEndless True to play in an endless dungeon streamed in around the player, instead of the level file.
 	 */
-	Game(sf::RenderWindow* window);
+	Game(sf::RenderWindow* window, std::uint64_t seed, bool isEndless = false);
 
 	/**
 	 * Initializes the game object by initializing all objects the main game uses.
@@ -71,6 +88,20 @@ private:
 	 */
 	void PopulateLevel();
 
+	/**
+	 * Spawns an item.
+	 * @param type The type of item.
+	 * @param position The position to spawn it at.
+	 */
+	void SpawnItem(ITEM type, sf::Vector2f position);
+
+	/**
+	 * Spawns an enemy, standing still until it sees the player. Every enemy rolls its stats from its own stream.
+	 * @param type The type of enemy.
+	 * @param position The position to spawn it at.
+	 */
+	void SpawnEnemy(ENEMY type, sf::Vector2f position);
+
 	/**
 	 * Loads all sprites needed for the UI.
 	 */
@@ -93,9 +124,19 @@ private:
 	void DrawString(std::string text, sf::Vector2f position, unsigned int size = 10);
 
 	/**
-	 * Constructs the grid of sprites that are used to draw the game light system.
+	 * Constructs the grid of vertices that is used to draw the game light system.
+	 * The grid covers the level, or in endless mode just the view around the player.
+	 * @param playerPosition The position of the player within the level.
 	 */
-	void ConstructLightGrid();
+	void ConstructLightGrid(sf::Vector2f playerPosition);
+
+	/**
+	 * Gets where the light grid starts in endless mode, where it covers the view and a cell around it.
+	 * The origin moves a whole cell at a time, and stays lined up with the level's tiles.
+	 * @param playerPosition The position of the player within the level.
+	 * @return The position of the light grid's top left cell.
+	 */
+	sf::Vector2f GetEndlessLightGridOrigin(sf::Vector2f playerPosition) const;
 
 	/**
 	 * Updates the level light.
@@ -106,8 +147,9 @@ private:
 	/**
 	 * Updates all items in the level.
 	 * @param playerPosition The position of the players within the level.
+	 * @param timeDelta The amount of time that has passed since the last update.
 	 */
-	void UpdateItems(sf::Vector2f playerPosition);
+	void UpdateItems(sf::Vector2f playerPosition, float timeDelta);
 
 	/**
 	 * Updates all enemies in the level.
@@ -116,12 +158,72 @@ private:
 	 */
 	void UpdateEnemies(sf::Vector2f playerPosition, float timeDelta);
 
+	/**
+	 * Turns every enemy to face the way it walks, switching between its walking and idle strips, and advances its frames.
+	 * @param timeDelta The amount of time that has passed since the last update.
+	 */
+	void AnimateEnemies(float timeDelta);
+
 	/**
 	 * Updates all projectiles in the level.
 	 * @param timeDetla The amount of time that has passed since the last update.
 	 */
 	void UpdateProjectiles(float timeDelta);
 
+	/**
+	 * Gets the position of the projectile at an index.
+	 * @param index The index of the projectile in the projectile store.
+	 * @return The position of the projectile.
+	 */
+	sf::Vector2f GetProjectilePosition(int index) const;
+
+	/**
+	 * Buckets every item, enemy and projectile by position, so drawing only visits the ones in view.
+	 */
+	void IndexObjects();
+
+	/**
+	 * Draws an item or enemy with the shared entity sprite, cut down to one frame of its strip.
+	 * @param textureID The ID of the texture holding the strip.
+	 * @param frameCount The number of frames in the strip.
+	 * @param frame The frame to draw.
+	 * @param position The position of the entity.
+	 * @param viewArea The area the main view shows. Entities outside it aren't drawn.
+	 * @return True if the entity was in view and drawn.
+	 */
+	bool DrawEntity(int textureID, int frameCount, int frame, sf::Vector2f position, const sf::FloatRect& viewArea);
+
+	/**
+	 * Gets the area of the level the main view shows when centred on a point.
+	 * @param center The centre of the view.
+	 * @return The area in world coordinates.
+	 */
+	sf::FloatRect GetViewArea(sf::Vector2f center) const;
+
+	/**
+	 * Gets the range of light grid cells that cover an area.
+	 * @param area The area in world coordinates.
+	 * @param firstColumn Receives the leftmost column.
+	 * @param firstRow Receives the top row.
+	 * @param lastColumn Receives the rightmost column. Less than firstColumn if no cell covers the area.
+	 * @param lastRow Receives the bottom row. Less than firstRow if no cell covers the area.
+	 */
+	void GetLightCellRange(const sf::FloatRect& area, int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const;
+
+	/**
+	 * Brings the coloured light up to date with the torches, the projectiles and any walls that changed.
+	 * @param changes The level's change journal, not yet caught up with.
+	 */
+	void UpdateLightField(const ChangeJournal& changes);
+
+	/**
+	 * Gets the coloured light at a light grid corner, the brightest of the tiles around it.
+	 * @param column The column of the corner.
+	 * @param row The row of the corner.
+	 * @return The colour to add to the corner.
+	 */
+	sf::Color GetCornerLight(int column, int row) const;
+
 private:
 	/**
 	 * The main application window.
@@ -149,14 +251,15 @@ private:
 	GAME_STATE m_gameState;
 
 	/**
-	 * A vector that holds all items within the level.
+	 * All items within the level, kept as contiguous components. An item's sprite index is its ITEM type.
 	 */
-	std::vector<std::unique_ptr<Item>> m_items;
+	EntityStore m_items;
 
 	/**
-	 * A vector that holds all the enemies within the level.
+	 * All enemies within the level, kept as contiguous components. An enemy's sprite index is
+	 * (ENEMY type * ANIMATION_STATE::COUNT) + its animation state.
 	 */
-	std::vector<std::unique_ptr<Enemy>> m_enemies;
+	EntityStore m_enemies;
 
 	/**
 	 * A bool that tracks the running state of the game. It's used in the main loop.
@@ -189,9 +292,92 @@ private:
 	sf::Text m_text;
 
 	/**
-	 * A vector containing all sprites that make up the lighting grid.
+	 * The quads that make up the lighting grid, row by row. Each cell's corners are coloured by the light map.
+	 */
+	sf::VertexArray m_lightVertices;
+
+	/**
+	 * The same quads as m_lightVertices, coloured by the light field and added on top of the darkness.
+	 */
+	sf::VertexArray m_colorLightVertices;
+
+	/**
+	 * The position of the light grid's top left cell.
+	 */
+	sf::Vector2f m_lightGridOrigin;
+
+	/**
+	 * The number of columns in the light grid.
+	 */
+	int m_lightGridColumns;
+
+	/**
+	 * The number of rows in the light grid.
+	 */
+	int m_lightGridRows;
+
+	/**
+	 * The darkness at every light grid cell corner, with the torches baked in.
+	 */
+	LightMap m_lightMap;
+
+	/**
+	 * The change journal version the light map's torches were baked at.
+	 */
+	std::uint32_t m_lightVersion;
+
+	/**
+	 * The brightness of every torch this frame. Kept so updates don't allocate.
+	 */
+	std::vector<float> m_torchBrightness;
+
+	/**
+	 * The coloured light flooded through the level from the torches and projectiles.
+	 */
+	LightField m_lightField;
+
+	/**
+	 * The light of every projectile in the light field. Projectiles all look the same, so the lights are matched to
+	 * them by index in the store, and only move as far as the projectiles do.
 	 */
-	std::vector<sf::Sprite> m_lightGrid;
+	std::vector<int> m_projectileLightIds;
+
+	/**
+	 * The tiles changed since the light was last updated. Kept so updates don't allocate.
+	 */
+	std::vector<DirtyRegion> m_lightChanges;
+
+	/**
+	 * The tiles the player can see this update. Lights the player's surroundings and wakes the enemies in sight.
+	 */
+	FieldOfView m_playerView;
+
+	/**
+	 * True if m_playerView is valid. There's no field of view in endless mode, so light passes walls and every enemy hunts.
+	 */
+	bool m_hasPlayerView;
+
+	/**
+	 * The tiles the torch being baked can see. Kept so baking doesn't allocate.
+	 */
+	FieldOfView m_torchView;
+
+	/**
+	 * The items, enemies and projectiles bucketed by position. Ids follow the draw order: the items by index in
+	 * their store, then the enemies, then the projectiles.
+	 */
+	SpatialGrid m_objectGrid;
+
+	/**
+	 * The number of items and enemies when the objects were last bucketed, so ids can be mapped back to the stores.
+	 */
+	int m_indexedItemCount;
+	int m_indexedEnemyCount;
+
+	/**
+	 * The ids of the objects found in view. Kept so drawing doesn't allocate.
+	 */
+	std::vector<int> m_visibleObjects;
 
 	/**
 	 * The size of the screen and window.
@@ -284,15 +470,40 @@ private:
 	int m_staminaStatTextureIDs[2];
 
 	/**
-	 * A vector of all the player's projectiles.
+	 * All the player's projectiles, kept as contiguous components so updating them is a linear pass.
 	 */
-	std::vector<std::unique_ptr<Projectile>> m_playerProjectiles;
+	EntityStore m_projectiles;
+
+	/**
+	 * The sprite every projectile is drawn with.
+	 */
+	sf::Sprite m_projectileSprite;
 
 	/**
 	 * The ID of the player's projectile texture.
 	 */
 	int m_projectileTextureID;
 
+	/**
+	 * The texture of every item type, by ITEM.
+	 */
+	int m_itemTextureIDs[static_cast<int>(ITEM::COUNT)];
+
+	/**
+	 * The texture of every enemy animation strip, by enemy sprite index.
+	 */
+	int m_enemyTextureIDs[static_cast<int>(ENEMY::COUNT) * static_cast<int>(ANIMATION_STATE::COUNT)];
+
+	/**
+	 * The sprite every item and enemy is drawn with, pointed at each one's strip in turn.
+	 */
+	sf::Sprite m_entitySprite;
+
+	/**
+	 * The name drawn over keys, the only items with one.
+	 */
+	sf::Text m_keyText;
+
 	/**
 	 * A boolean denoting if a new level was generated.
 	 */
@@ -303,6 +514,11 @@ private:
 	 */
 	std::shared_ptr<sf::Sprite> m_healthBarSprite;
 
+	/**
+	 * The full health bar's rectangle on the texture atlas. The sprite shows the left part of it.
+	 */
+	sf::IntRect m_healthBarRect;
+
 	/**
 	* Sprite for the health bar outline.
 	*/
@@ -313,6 +529,11 @@ private:
 	 */
 	std::shared_ptr<sf::Sprite> m_manaBarSprite;
 
+	/**
+	 * The full mana bar's rectangle on the texture atlas. The sprite shows the left part of it.
+	 */
+	sf::IntRect m_manaBarRect;
+
 	/**
 	* Sprite for the mana bar outline.
 	*/
@@ -322,5 +543,25 @@ private:
 	 * A vector of all ui sprites.
 	 */
 	std::vector<std::shared_ptr<sf::Sprite>> m_uiSprites;
+
+	/**
+	 * The seed every random stream in the game is derived from.
+	 */
+	std::uint64_t m_seed;
+
+	/**
+	 * True if the game is played in an endless dungeon rather than the level file.
+	 */
+	bool m_isEndless;
+
+	/**
+	 * The number of loot drops so far. Each drop rolls from its own stream, indexed by this.
+	 */
+	std::uint64_t m_lootDropCount;
+
+	/**
+	 * The number of enemies spawned so far. Each enemy rolls its stats from its own stream, indexed by this.
+	 */
+	std::uint64_t m_enemySpawnCount;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,319 @@
+//-------------------------------------------------------------------------------------
+// HierarchicalPathfinder.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef HIERARCHICALPATHFINDER_H
+#define HIERARCHICALPATHFINDER_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+#include "Pathfinder.h"
+
+// The default width and height of a cluster in tiles.
+static int const HPA_CLUSTER_SIZE = 16;
+
+/**
+ * Hierarchical pathfinding (HPA*) for large grids.
+ * The grid is cut into square clusters. Wherever a run of open tiles crosses the border between two clusters,
+ * an entrance node is placed on each side, and the cost between every pair of nodes in a cluster is precomputed.
+ * A query links the start and goal into that small graph, searches it with A*, and returns a list of waypoints;
+ * the tile path between two waypoints is only refined when it is needed. Paths are near optimal, not optimal.
+ * When a tile changes only its cluster, and the neighbouring clusters if it lies on a border, are rebuilt.
+ * The grid is passed to every call rather than stored, and must be the grid the pathfinder was built for.
+ */
+class HierarchicalPathfinder
+{
+public:
+	/**
+	 * Constructor.
+	 * @param clusterSize The width and height of a cluster in tiles.
+	 */
+	explicit HierarchicalPathfinder(int clusterSize = HPA_CLUSTER_SIZE);
+
+	/**
+	 * Builds the abstract graph for a grid.
+	 * @param grid The grid to build for.
+	 */
+	void Build(const LevelGrid& grid);
+
+	/**
+	 * Rebuilds the clusters affected by a change to one tile. Call this after the tile has changed.
+	 * @param grid The grid, after the change.
+	 * @param columnIndex The column of the changed tile.
+	 * @param rowIndex The row of the changed tile.
+	 */
+	void OnTileChanged(const LevelGrid& grid, int columnIndex, int rowIndex);
+
+	/**
+	 * Finds the waypoints of a path through the abstract graph.
+	 * @param grid The grid the pathfinder was built for.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param waypoints Receives the entrance tiles the path passes through, followed by the goal. The start is not included.
+	 * @return True if a path was found.
+	 */
+	bool FindAbstractPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& waypoints);
+
+	/**
+	 * Refines the tile path between two consecutive waypoints.
+	 * @param grid The grid the pathfinder was built for.
+	 * @param from The waypoint to start from.
+	 * @param to The waypoint to reach.
+	 * @param path Receives the tiles from the tile after from up to and including to.
+	 * @return True if a path was found.
+	 */
+	bool RefineSegment(const LevelGrid& grid, GridCoord from, GridCoord to, std::vector<GridCoord>& path);
+
+	/**
+	 * Finds the waypoints of a path, but only refines the tiles up to the first one. The rest are refined on demand
+	 * with RefineSegment() as the path is walked, or by searching again from the first waypoint.
+	 * @param grid The grid the pathfinder was built for.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param path Receives the tiles from the tile after start up to and including the first waypoint.
+	 * @return True if a path was found.
+	 */
+	bool FindFirstSegment(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path);
+
+	/**
+	 * Gets the waypoints found by the last FindFirstSegment() or FindPath().
+	 * @return The entrance tiles the path passes through, followed by the goal.
+	 */
+	const std::vector<GridCoord>& GetWaypoints() const;
+
+	/**
+	 * Finds a full tile path, refining every segment of the abstract path.
+	 * @param grid The grid the pathfinder was built for.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param path Receives the tiles from the tile after start up to and including goal.
+	 * @return True if a path was found.
+	 */
+	bool FindPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path);
+
+	/**
+	 * Gets the number of entrance nodes in the abstract graph.
+	 * @return The number of nodes.
+	 */
+	int GetNodeCount() const;
+
+	/**
+	 * Gets the number of abstract nodes the last search expanded.
+	 * @return The number of expanded nodes.
+	 */
+	int GetExpandedNodeCount() const;
+
+private:
+	/**
+	 * The entrance nodes of one cluster and the costs between them.
+	 */
+	struct Cluster {
+		std::vector<GridCoord> nodes;		// The tile of every entrance node.
+		std::vector<int> costs;				// The cost from node i to node j at (i * nodes.size()) + j, or FLOW_UNREACHABLE.
+		std::vector<int> links;				// The ids of the nodes across the border from node i, at (i * 2) and (i * 2) + 1, or -1.
+	};
+
+	/**
+	 * An entry in the abstract open list.
+	 */
+	struct OpenNode {
+		int F;								// Estimated cost for the full path when the node was pushed.
+		int node;							// The id of the node.
+	};
+
+	/**
+	 * Orders the open list heap so the lowest F is on top.
+	 */
+	struct OpenNodeCompare {
+		bool operator()(const OpenNode& lhs, const OpenNode& rhs) const
+		{
+			return lhs.F > rhs.F;
+		}
+	};
+
+	/**
+	 * Finds the entrance nodes of a cluster and the costs between them.
+	 * @param grid The grid.
+	 * @param clusterIndex The cluster to build.
+	 */
+	void BuildCluster(const LevelGrid& grid, int clusterIndex);
+
+	/**
+	 * Adds the entrance nodes along one side of a cluster. Long runs of open tiles get a node at each end, short runs one in the middle.
+	 * @param grid The grid.
+	 * @param clusterIndex The cluster.
+	 * @param side The side of the cluster: 0 = top, 1 = right, 2 = bottom, 3 = left.
+	 * @param nodes The list to add the node tiles to.
+	 */
+	void AddSideEntrances(const LevelGrid& grid, int clusterIndex, int side, std::vector<GridCoord>& nodes) const;
+
+	/**
+	 * Finds the nodes across the border from every node of a cluster. Call this for a cluster and its neighbours after rebuilding it.
+	 * @param clusterIndex The cluster to link.
+	 */
+	void LinkCluster(int clusterIndex);
+
+	/**
+	 * Finds the cost from a tile to every tile of its cluster, without leaving the cluster. The result is left in m_localDistance.
+	 * @param grid The grid.
+	 * @param clusterIndex The cluster to search.
+	 * @param from The tile to search from. Must be inside the cluster and open.
+	 */
+	void SearchCluster(const LevelGrid& grid, int clusterIndex, GridCoord from);
+
+	/**
+	 * Gets the cost to a tile found by the last SearchCluster().
+	 * @param clusterIndex The cluster that was searched.
+	 * @param tile A tile inside the cluster.
+	 * @return The cost, or FLOW_UNREACHABLE.
+	 */
+	int GetLocalDistance(int clusterIndex, GridCoord tile) const;
+
+	/**
+	 * Gets the cluster a tile is in.
+	 * @param tile The tile. Must be inside the grid.
+	 * @return The index of the cluster.
+	 */
+	int GetClusterIndex(GridCoord tile) const;
+
+	/**
+	 * Finds the entrance node on a tile.
+	 * @param clusterIndex The cluster the tile is in.
+	 * @param tile The tile.
+	 * @return The index of the node in its cluster, or -1 if there is no node on the tile.
+	 */
+	int FindNode(int clusterIndex, GridCoord tile) const;
+
+	/**
+	 * Gets the tile of an abstract node.
+	 * @param node The id of the node.
+	 * @return The tile of the node.
+	 */
+	GridCoord GetNodeTile(int node) const;
+
+	/**
+	 * Updates a node's cost and queues it if the new route is cheaper.
+	 * @param node The id of the node reached.
+	 * @param parent The id of the node it was reached from.
+	 * @param cost The cost of the route to the node.
+	 */
+	void Relax(int node, int parent, int cost);
+
+	/**
+	 * Starts a new abstract search generation, clearing the stamps when they run out.
+	 */
+	void NextGeneration();
+
+private:
+	/**
+	 * The width and height of a cluster in tiles.
+	 */
+	int m_clusterSize;
+
+	/**
+	 * The most entrance nodes a cluster can have. Node ids are (clusterIndex * m_maxClusterNodes) + node index.
+	 */
+	int m_maxClusterNodes;
+
+	/**
+	 * The width of the grid in tiles.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid in tiles.
+	 */
+	int m_height;
+
+	/**
+	 * The number of clusters across the grid.
+	 */
+	int m_clusterColumns;
+
+	/**
+	 * The number of clusters down the grid.
+	 */
+	int m_clusterRows;
+
+	/**
+	 * Every cluster, stored row by row.
+	 */
+	std::vector<Cluster> m_clusters;
+
+	/**
+	 * The cost to every tile of the last cluster search, indexed by the tile's offset inside the cluster.
+	 */
+	std::vector<int> m_localDistance;
+
+	/**
+	 * The bucket queue of cluster searches.
+	 */
+	std::vector<std::vector<int>> m_buckets;
+
+	/**
+	 * The query's start and goal tiles, which are linked into the graph as two extra nodes.
+	 */
+	GridCoord m_start;
+	GridCoord m_goal;
+
+	/**
+	 * The cluster the query's goal is in.
+	 */
+	int m_goalCluster;
+
+	/**
+	 * The cost from the query's goal to every node of its cluster.
+	 */
+	std::vector<int> m_goalCosts;
+
+	/**
+	 * The cost from the query's start to every node of its cluster.
+	 */
+	std::vector<int> m_startCosts;
+
+	/**
+	 * The cost from the query's start to its goal inside their shared cluster, or FLOW_UNREACHABLE.
+	 */
+	int m_startToGoalCost;
+
+	/**
+	 * Abstract search data, indexed by node id.
+	 */
+	std::vector<int> m_G;
+	std::vector<int> m_H;
+	std::vector<int> m_F;
+	std::vector<int> m_parent;
+	std::vector<std::uint32_t> m_stamp;
+
+	/**
+	 * The abstract open list, kept as a binary heap.
+	 */
+	std::vector<OpenNode> m_open;
+
+	/**
+	 * The stamp of open nodes in the current search. Closed nodes are stamped with m_generation + 1.
+	 */
+	std::uint32_t m_generation;
+
+	/**
+	 * The number of abstract nodes the last search expanded.
+	 */
+	int m_expandedNodeCount;
+
+	/**
+	 * Refines segments between waypoints.
+	 */
+	Pathfinder m_pathfinder;
+
+	/**
+	 * Working lists for FindFirstSegment() and FindPath().
+	 */
+	std::vector<GridCoord> m_waypoints;
+	std::vector<GridCoord> m_segment;
+};
+#endif
@@ -1,25 +0,0 @@
-//-------------------------------------------------------------------------------------
-// Humanoid.h
-//
-// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
-// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
-// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
-// PARTICULAR PURPOSE.
-//
-// Written by Dale Green. Copyright (c) Packt Publishing. All rights reserved.
-//-------------------------------------------------------------------------------------
-#ifndef HUMANOID_H
-#define HUMANOID_H
-
-#include "Enemy.h"
-
-class Humanoid : public Enemy
-{
-public:
-
-	/**
-	 * Default constructor
-	 */
-	Humanoid();
-};
-#endif
\ No newline at end of file
@@ -1,24 +0,0 @@
-//-------------------------------------------------------------------------------------
-// Key.h
-//
-// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
-// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
-// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
-// PARTICULAR PURPOSE.
-//
-// Written by Dale Green. Copyright (c) Packt Publishing. All rights reserved.
-//-------------------------------------------------------------------------------------
-#ifndef KEY_H
-#define KEY_H
-
-#include "Item.h"
-
-class Key : public Item
-{
-public:
-	/**
-	 * Default constructor.
-	 */
-	Key();
-};
-#endif
\ No newline at end of file
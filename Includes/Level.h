@@ -12,26 +12,50 @@
 #define LEVEL_H
 
 #include "Torch.h"
-
-// Constants for the game grid size.
-static int const GRID_WIDTH = 19;
-static int const GRID_HEIGHT = 19;
+#include "LevelGrid.h"
+#include "Pathfinder.h"
+#include "HierarchicalPathfinder.h"
+#include "PathCache.h"
+#include "NextHopTable.h"
+#include "FloorLayout.h"
+#include "ChangeJournal.h"
+#include "TileLayer.h"
+#include "PathRequestQueue.h"
+#include "FlowField.h"
+#include "ChunkedWorld.h"
+#include "FieldOfView.h"
 
 // The width and height of each tile in pixels.
 static int const TILE_SIZE = 50;
 
-// The level tile type.
+// Levels with at least this many tiles are searched with hierarchical A* instead of plain A*.
+static int const HIERARCHICAL_PATH_MIN_TILES = 128 * 128;
+
+// In endless mode, the radius in chunks around the player that is kept generated.
+static int const STREAMING_RADIUS = 1;
+
+// In endless mode, the most chunks kept in memory at once.
+static int const MAX_RESIDENT_CHUNKS = 25;
+
+// A lightweight description of a single level tile.
+// Tiles are returned by value; the level stores its data per attribute in a LevelGrid.
 struct Tile {
 	TILE type;							// The type of tile this is.
 	int columnIndex;					// The column index of the tile.
 	int rowIndex;						// The row index of the tile.
-	sf::Sprite sprite;					// The tile sprite.
-	int H;								// Heuristic / movement cost to goal.
-	int G;								// Movement cost. (Total of entire path)
-	int F;								// Estimated cost for full path. (G + H)
-	Tile* parentNode;					// Node to reach this node.
 };
 
+// Two tiles are the same tile if they share indices.
+inline bool operator==(const Tile& lhs, const Tile& rhs)
+{
+	return (lhs.columnIndex == rhs.columnIndex) && (lhs.rowIndex == rhs.rowIndex);
+}
+
+inline bool operator!=(const Tile& lhs, const Tile& rhs)
+{
+	return !(lhs == rhs);
+}
+
 class Level
 {
 public:
@@ -47,6 +71,19 @@ public:
 	 */
 	Level(sf::RenderWindow& window);
 
+	/**
+	 * Constructor.
+	 * Only the size of the screen is needed to calculate the level position, so no window has to exist.
+	 * @param screenSize The size of the area the level is centered in.
+	 */
+	Level(sf::Vector2u screenSize);
+
+	/**
+	 * Gets the headless tile grid of the level.
+	 * @return A reference to the level grid.
+	 */
+	const LevelGrid& GetGrid() const;
+
 	/**
 	 * Returns true if the given tile index is solid.
 	 * @param columnIndex The tile's column index.
@@ -61,9 +98,15 @@ public:
 	 * @param columnIndex The tile's column index.
 	 * @param rowIndex The tile's row index.
 	 * @param index The new index of the tile.
+	 * Wall tiles in the surrounding 3x3 area are re-tiled so they keep joining up.
 	 */
 	void SetTile(int columnIndex, int rowIndex, TILE tileType);
 
+	/**
+	 * Assigns the correct wall variant to every wall tile in the level, based on the walls around it.
+	 */
+	void Autotile();
+
 	/**
 	 * Draws the level grid to the provided render window.
 	 * @param window The render window to draw the level to.
@@ -80,26 +123,156 @@ public:
 	TILE GetTileType(int columnIndex, int rowIndex) const;
 
 	/**
-	 * Loads a level from a text file.
+	 * Loads a level from a text file, or from a binary level file if the name ends in LEVEL_FILE_EXTENSION.
 	 * @param fileName The path to the level file to load.
 	 * return true if the level loaded succesfully.
 	 */
 	bool LoadLevelFromFile(std::string fileName);
 
+	/**
+	 * Generates a floor, or fetches it if it was generated before, and enters its first room.
+	 * @param seed The seed of the floor.
+	 * @param floorNumber The number of the floor, from 1.
+	 */
+	void GenerateFloor(std::uint64_t seed, int floorNumber);
+
+	/**
+	 * Enters a room of the current floor. The room's tiles were generated with the floor, so this only copies them.
+	 * @param roomNumber The room to enter.
+	 * @return True if the floor has that room.
+	 */
+	bool EnterRoom(int roomNumber);
+
+	/**
+	 * Moves on to the next room on the path through the floor, or to the first room of the next floor after the last one.
+	 * A level loaded from a file stands in for the first room of its floor.
+	 * @param spawnPosition Receives the position just inside the new room's entrance.
+	 */
+	void EnterNextRoom(sf::Vector2f& spawnPosition);
+
+	/**
+	 * Gets the room in a cell of the current floor's layout.
+	 * @param layoutColumn The column of the cell, below FLOOR_LAYOUT_COLUMNS.
+	 * @param layoutRow The row of the cell, below FLOOR_LAYOUT_ROWS.
+	 * @return The room number, or FLOOR_NO_ROOM if the cell is empty or outside the layout.
+	 */
+	int GetRoomAt(int layoutColumn, int layoutRow) const;
+
 	/**
 	 * Gets the tile at the given position.
 	 * @param position The coordinates of the position to check.
-	 * @return A pointer to the tile at the given location.
+	 * @return The tile at the given location. Positions outside the level give a TILE::EMPTY tile.
 	 */
-	Tile* GetTile(sf::Vector2f position);
+	Tile GetTile(sf::Vector2f position) const;
 
 	/**
 	* Gets the tile at the given position in the level array.
 	* @param columnIndex The column that the tile is in.
 	* @param rowIndex The row that the tile is in.
-	* @return A pointer to the tile if valid.
+	* @return The tile. Invalid indices give a TILE::EMPTY tile.
 	*/
-	Tile* GetTile(int columnIndex, int rowIndex);
+	Tile GetTile(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the position of the center of a tile.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The position of the center of the tile.
+	 */
+	sf::Vector2f GetActualTileLocation(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Finds the shortest path between two positions with Jump Point Search, moving between tile centers.
+	 * Levels of HIERARCHICAL_PATH_MIN_TILES tiles or more use hierarchical A*, whose paths are near shortest. Only the
+	 * leg to its first waypoint is refined into tiles, so the path can end short of the goal; search again from its
+	 * end to refine the next leg.
+	 * Levels of NEXT_HOP_MAX_TILES tiles or fewer walk a precomputed next-hop table instead, with no search, except
+	 * while UpdateNextHopTable() is still rebuilding it after a tile changed.
+	 * Only the fixed level grid is searched; in endless mode no path is found.
+	 * Jump Point Search results are cached until a tile along the path becomes passable or blocked.
+	 * @param from The position to start from.
+	 * @param to The position to reach.
+	 * @param path Receives the centers of the tiles on the path, from the tile after the start up to and including the goal,
+	 * or the first waypoint on hierarchical levels. The vector is cleared first, and keeps its capacity between calls.
+	 * @return True if a path was found.
+	 */
+	bool FindPath(sf::Vector2f from, sf::Vector2f to, std::vector<sf::Vector2f>& path);
+
+	/**
+	 * Gets the cache of path results, to read its hit rate and saved search time.
+	 * @return The path cache.
+	 */
+	const PathCache& GetPathCache() const;
+
+	/**
+	 * Gets the journal of changed tiles. Every SetTile() records the tile and the walls around it, and loading a
+	 * level resets the journal. Systems that derive data from the tiles use it to rebuild only what changed.
+	 * @return The change journal.
+	 */
+	const ChangeJournal& GetChangeJournal() const;
+
+	/**
+	 * Rebuilds the flow field towards the player if the player has moved to another tile, or walkability has changed.
+	 * Call once per update, before enemies read their steps. Does nothing in endless mode.
+	 * @param playerPosition The position of the player.
+	 */
+	void UpdateFlowField(sf::Vector2f playerPosition);
+
+	/**
+	 * Gets the next step towards the player from the flow field, in O(1).
+	 * @param position The position to step from.
+	 * @param target Receives the center of the tile to step to.
+	 * @return True if there is a step to take. False on the player's tile, or if the player can't be reached.
+	 */
+	bool GetFlowStep(sf::Vector2f position, sf::Vector2f& target) const;
+
+	/**
+	 * Finds the tiles that can be seen from a position, with walls blocking sight.
+	 * @param position The position to look from.
+	 * @param radius The furthest distance seen, in tiles.
+	 * @param view Receives the visible tiles. Cleared in endless mode.
+	 * @return False in endless mode, where there is no fixed grid to look across.
+	 */
+	bool ComputeFieldOfView(sf::Vector2f position, int radius, FieldOfView& view) const;
+
+	/**
+	 * Submits a path request that is solved over the coming frames by UpdatePathRequests().
+	 * Requests starting closest to the player are served first.
+	 * @param from The position to start from.
+	 * @param to The position to reach.
+	 * @param playerPosition The position of the player.
+	 * @return The ticket to poll with TakePathResult().
+	 */
+	PathTicket RequestPath(sf::Vector2f from, sf::Vector2f to, sf::Vector2f playerPosition);
+
+	/**
+	 * Gets the state of a path request.
+	 * @param ticket The ticket returned by RequestPath().
+	 * @return The state of the request.
+	 */
+	PATH_REQUEST_STATUS GetPathRequestStatus(PathTicket ticket) const;
+
+	/**
+	 * Takes the result of a finished path request. The ticket becomes invalid once the request has finished.
+	 * @param ticket The ticket returned by RequestPath().
+	 * @param path Receives the centers of the tiles on the path, from the tile after the start up to and including the goal.
+	 * @return True if the request has finished and a path was found.
+	 */
+	bool TakePathResult(PathTicket ticket, std::vector<sf::Vector2f>& path);
+
+	/**
+	 * Spends up to a frame's budget on rebuilding the next-hop table after walkability changed. Call once per update,
+	 * so the rebuild is spread over frames instead of landing on a path query. Does nothing in endless mode.
+	 * @param maxMicroseconds The most time to spend this frame, or zero for no time limit.
+	 */
+	void UpdateNextHopTable(double maxMicroseconds);
+
+	/**
+	 * Spends up to a frame's budget on the queued path requests. Call once per update. Does nothing in endless mode.
+	 * @param maxExpansions The most nodes to expand this frame.
+	 * @param maxMicroseconds The most time to spend this frame, or zero for no time limit.
+	 */
+	void UpdatePathRequests(int maxExpansions, double maxMicroseconds);
 
 	/**
 	 * Gets the position of the level grid relative to the window.
@@ -180,6 +353,32 @@ public:
 	*/
 	int AddTile(std::string fileName, TILE tileType);
 
+	/**
+	 * Switches the level to an endless dungeon made of chunks that are generated around the player.
+	 * Tile indices then address the whole world and can be negative.
+	 * @param seed The seed the chunks are generated from.
+	 * @param spillDirectory (Optional) A directory modified chunks are written to when they are evicted.
+	 */
+	void EnableEndlessMode(std::uint64_t seed, const std::string& spillDirectory = "");
+
+	/**
+	 * Returns true if the level is an endless, chunked dungeon.
+	 * @return True if endless mode is enabled.
+	 */
+	bool IsEndless() const;
+
+	/**
+	 * Gets a position to start on in the endless dungeon: the floor tile nearest the centre of the first chunk.
+	 * @return The position of the center of the tile. Only meaningful once endless mode is enabled.
+	 */
+	sf::Vector2f GetEndlessSpawnPosition();
+
+	/**
+	 * Streams chunks in and out around the given position. Does nothing unless endless mode is enabled.
+	 * @param position The position the level should be generated around, usually the player's.
+	 */
+	void UpdateStreaming(sf::Vector2f position);
+
 private:
 
 	/**
@@ -190,24 +389,116 @@ private:
 	 */
 	bool IsWall(int columnIndex, int rowIndex);
 
+	/**
+	 * Calculates the position of the level so that the grid is centered in the screen area.
+	 */
+	void CalculateOrigin();
+
+	/**
+	 * Re-centers the level and rebuilds the path data and torches after a new grid was loaded.
+	 */
+	void OnGridLoaded();
+
+	/**
+	 * Gets the current floor's layout, generating it if needed, and copies its cells into m_roomLayout.
+	 * @return The layout of the current floor.
+	 */
+	const FloorLayout& GetFloorLayout();
+
+	/**
+	 * Checks if the level is large enough to be searched with hierarchical A*.
+	 * @return True if the level has at least HIERARCHICAL_PATH_MIN_TILES tiles.
+	 */
+	bool UsesHierarchicalPaths() const;
+
+	/**
+	 * Draws the tiles of the endless world that are inside the window's view.
+	 * @param window The render window to draw to.
+	 */
+	void DrawEndless(sf::RenderWindow& window);
+
 private:
 	/**
-	 * A 2D array that describes the level data.
-	 * The type is Tile, which holds a sprite and an index.
+	 * The tile grid of the level. This is the authoritative copy of the tile types.
+	 */
+	LevelGrid m_grid;
+
+	/**
+	 * The pathfinder used for path searches over the level grid. It owns the per-tile search data.
+	 */
+	Pathfinder m_pathfinder;
+
+	/**
+	 * The hierarchical pathfinder used for path searches over large level grids. Only built for those grids.
+	 */
+	HierarchicalPathfinder m_hierarchicalPathfinder;
+
+	/**
+	 * Path results keyed by start and goal tile, reused until a tile along them changes.
 	 */
-	Tile m_grid[GRID_WIDTH][GRID_HEIGHT];
+	PathCache m_pathCache;
 
 	/**
-	 * A vector off all the sprites in the level.
+	 * The first step between every pair of tiles. Only built for small level grids.
+	 */
+	NextHopTable m_nextHops;
+
+	/**
+	 * Path requests that are solved a slice at a time across frames.
+	 */
+	PathRequestQueue m_pathRequests;
+
+	/**
+	 * The rectangles of tiles changed since the level was loaded.
+	 */
+	ChangeJournal m_changes;
+
+	/**
+	 * The tiles of the last path found, kept so path queries don't allocate.
+	 */
+	std::vector<GridCoord> m_pathTiles;
+
+	/**
+	 * The distance field towards the player that enemies follow.
+	 */
+	FlowField m_flowField;
+
+	/**
+	 * A sprite for each tile type, indexed by TILE. The endless world's tiles share these when drawn.
 	 */
 	std::vector<sf::Sprite> m_tileSprites;
 
+	/**
+	 * The level grid's tiles as vertex arrays, one per texture, kept up to date from the change journal.
+	 */
+	TileLayer m_tileLayer;
+
+	/**
+	 * The size of the area that the level is centered in.
+	 */
+	sf::Vector2u m_screenSize;
+
+	/**
+	 * The chunked world used in endless mode, or nullptr.
+	 */
+	std::unique_ptr<ChunkedWorld> m_world;
+
 	/**
 	 * The position of the level relative to the window.
 	 * This is to the top-left of the level grid.
 	 */
 	sf::Vector2i m_origin;
 
+	/**
+	 * Generates the floors and keeps the last few, with the tiles of all their rooms.
+	 */
+	FloorLayoutGenerator m_floorLayouts;
+
+	/**
+	 * The seed the current floor was generated from.
+	 */
+	std::uint64_t m_floorSeed;
+
 	/**
 	* The floor number that the player is currently on.
 	*/
@@ -219,7 +510,7 @@ private:
 	int m_roomNumber;
 
 	/**
-	* A 2D array that contains the room layout for the current floor.
+	* A 2D array that contains the room layout for the current floor. Each cell holds a room number, or FLOOR_NO_ROOM.
 	*/
 	int m_roomLayout[3][10];
 
@@ -228,11 +519,6 @@ private:
 	 */
 	int m_textureIDs[static_cast<int>(TILE::COUNT)];
 
-	/**
-	 * The indices of the tile containing the levels door.
-	 */
-	sf::Vector2i m_doorTileIndices;
-
 	/**
 	 * A vector of all tiles in the level.
 	 */
@@ -0,0 +1,176 @@
+//-------------------------------------------------------------------------------------
+// LevelConnectivity.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LEVELCONNECTIVITY_H
+#define LEVELCONNECTIVITY_H
+
+#include <vector>
+#include "LevelGrid.h"
+
+// The component of solid tiles and tiles outside the grid.
+static int const NO_COMPONENT = -1;
+
+/**
+ * The result of validating a level.
+ */
+struct ConnectivityReport {
+	int componentCount;					// The number of separate passable areas.
+	int pocketCount;					// Passable areas that can't be reached from the entrance.
+	int pocketTileCount;				// The passable tiles in those areas.
+	bool isValid;						// True if the entrance, the door and every required tile can reach each other.
+};
+
+/**
+ * Labels the connected passable areas of a grid.
+ * Labelling works on runs of passable tiles rather than single tiles: each row of the solidity bitmap is split into
+ * runs with bit scans, every run is joined with the runs it touches in the row above using union-find, and the
+ * roots are then numbered. Moves that don't cut corners can only join tiles that share an edge, so four way
+ * connectivity gives exactly the areas a walker can reach. A labeller keeps its buffers between grids.
+ */
+class LevelConnectivity
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	LevelConnectivity();
+
+	/**
+	 * Labels the connected passable areas of a grid.
+	 * @param grid The grid to label. Solid tiles are blocked.
+	 * @return The number of areas.
+	 */
+	int Label(const LevelGrid& grid);
+
+	/**
+	 * Labels a grid and checks that its entrance, its door and a set of other tiles can all reach each other.
+	 * The entrance and door are walls, so the passable tile next to each is used.
+	 * @param grid The grid to check.
+	 * @param requiredTiles Other tiles that must be reachable, such as where the key is placed.
+	 * @return The report. The labels stay available until the next call.
+	 */
+	ConnectivityReport Validate(const LevelGrid& grid, const std::vector<GridCoord>& requiredTiles = std::vector<GridCoord>());
+
+	/**
+	 * Gets the area a tile is in, from the last labelling.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The area, or NO_COMPONENT if the tile is solid or outside the grid.
+	 */
+	int GetComponent(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the number of tiles in an area, from the last labelling.
+	 * @param component The area.
+	 * @return The number of tiles.
+	 */
+	int GetComponentSize(int component) const;
+
+	/**
+	 * Turns every passable tile that can't reach a tile into a wall, then labels the grid again.
+	 * The walls are WALL_SINGLE; autotile the grid afterwards.
+	 * @param grid The grid to change. Must be the grid that was last labelled.
+	 * @param keep A passable tile of the area to keep.
+	 * @return The number of tiles filled.
+	 */
+	int FillPockets(LevelGrid& grid, GridCoord keep);
+
+	/**
+	 * Carves a straight corridor from every area that can't reach a tile to the nearest tile that can, then labels the
+	 * grid again. The border of the grid is never carved. Autotile the grid afterwards.
+	 * @param grid The grid to change. Must be the grid that was last labelled.
+	 * @param keep A passable tile of the area to join the others to.
+	 * @return The number of tiles carved.
+	 */
+	int CarvePockets(LevelGrid& grid, GridCoord keep);
+
+	/**
+	 * Finds the passable tile next to a wall tile such as a door.
+	 * @param grid The grid.
+	 * @param tile The wall tile.
+	 * @param inside Receives the first passable tile sharing an edge with it.
+	 * @return True if there is one.
+	 */
+	static bool GetInsideTile(const LevelGrid& grid, GridCoord tile, GridCoord& inside);
+
+private:
+	/**
+	 * A run of passable tiles in a row.
+	 */
+	struct Run {
+		int row;							// The row of the run.
+		int begin;							// The first column of the run.
+		int end;							// One past the last column of the run.
+	};
+
+	/**
+	 * Gets the root of a run's set, halving the path on the way.
+	 * @param run The index of the run.
+	 * @return The index of the root run.
+	 */
+	int FindRoot(int run);
+
+	/**
+	 * Finds the first column at or after a column whose solidity bit has the given value.
+	 * @param bits The solidity bits of the row.
+	 * @param from The column to start at.
+	 * @param isSolid The value to look for.
+	 * @return The column, or the width of the grid if there is none.
+	 */
+	int FindBit(const std::uint64_t* bits, int from, bool isSolid) const;
+
+	/**
+	 * Gets the run a tile is in.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The index of the run, or -1 if the tile is solid or outside the grid.
+	 */
+	int FindRun(int columnIndex, int rowIndex) const;
+
+private:
+	/**
+	 * The width of the last labelled grid.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the last labelled grid.
+	 */
+	int m_height;
+
+	/**
+	 * The number of 64 bit words in a row of the last labelled grid's bitmap.
+	 */
+	int m_wordsPerRow;
+
+	/**
+	 * Every run, row by row and left to right.
+	 */
+	std::vector<Run> m_runs;
+
+	/**
+	 * The index of the first run of every row, plus one past the last run.
+	 */
+	std::vector<int> m_rowRuns;
+
+	/**
+	 * The union-find parent of every run. Parents always have a lower index than their children.
+	 */
+	std::vector<int> m_parents;
+
+	/**
+	 * The area of every run.
+	 */
+	std::vector<int> m_runComponents;
+
+	/**
+	 * The number of tiles in every area.
+	 */
+	std::vector<int> m_componentSizes;
+};
+#endif
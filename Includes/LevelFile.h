@@ -0,0 +1,171 @@
+//-------------------------------------------------------------------------------------
+// LevelFile.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LEVELFILE_H
+#define LEVELFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "LevelGrid.h"
+
+// The extension used for binary level files.
+static char const* const LEVEL_FILE_EXTENSION = ".pcgl";
+
+// The current version of the binary level format.
+static std::uint32_t const LEVEL_FILE_VERSION = 1;
+
+/**
+ * The fixed-size header at the start of a binary level file.
+ * All values are stored in the byte order of the machine that wrote the file (little endian on every supported platform).
+ * The header is followed by the torch indices, the tile types and the solidity bitmap, each starting at the given offset.
+ */
+struct LevelFileHeader {
+	char magic[4];							// Always "PCGL".
+	std::uint32_t version;					// LEVEL_FILE_VERSION.
+	std::uint32_t width;					// The number of columns in the level.
+	std::uint32_t height;					// The number of rows in the level.
+	std::uint64_t seed;						// The seed the level was generated from, or 0 if it was hand authored.
+	std::int32_t doorColumn;				// The column of the door tile.
+	std::int32_t doorRow;					// The row of the door tile.
+	std::uint32_t torchCount;				// The number of torches.
+	std::uint32_t wordsPerRow;				// The number of 64 bit words in each row of the solidity bitmap.
+	std::uint64_t torchOffset;				// Offset of torchCount (column, row) pairs of 32 bit ints.
+	std::uint64_t typeOffset;				// Offset of width * height tile types, one byte each, row by row.
+	std::uint64_t solidOffset;				// Offset of wordsPerRow * height solidity words, row by row.
+};
+
+static_assert(sizeof(LevelFileHeader) == 64, "LevelFileHeader must not contain padding.");
+
+/**
+ * A read-only, memory-mapped binary level file.
+ * Opening a file only maps it and checks the header; the tile payload is read straight from the mapping
+ * the first time it is touched, so no parsing or copying happens up front.
+ */
+class LevelFile
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	LevelFile();
+
+	/**
+	 * Destructor. Unmaps the file.
+	 */
+	~LevelFile();
+
+	LevelFile(const LevelFile&) = delete;
+	LevelFile& operator=(const LevelFile&) = delete;
+
+	/**
+	 * Maps a binary level file and validates its header.
+	 * @param fileName The path to the file.
+	 * @return True if the file was mapped and its header and sizes are valid.
+	 */
+	bool Open(const std::string& fileName);
+
+	/**
+	 * Unmaps the file, if one is open.
+	 */
+	void Close();
+
+	/**
+	 * Checks if a file is currently mapped.
+	 * @return True if a file is open.
+	 */
+	bool IsOpen() const;
+
+	/**
+	 * Gets the header of the open file.
+	 * @return The header. Only valid while the file is open.
+	 */
+	const LevelFileHeader& GetHeader() const;
+
+	/**
+	 * Gets the tile types of a single row, straight from the mapping.
+	 * The bytes are not validated; LevelGrid::LoadFromLevelFile() rejects files holding unknown types.
+	 * @param rowIndex The row to fetch. Must be valid.
+	 * @return A pointer to width tile types, one byte each.
+	 */
+	const std::uint8_t* GetTypeRow(int rowIndex) const;
+
+	/**
+	 * Gets the solidity bits of a single row, straight from the mapping.
+	 * @param rowIndex The row to fetch. Must be valid.
+	 * @return A pointer to wordsPerRow words.
+	 */
+	const std::uint64_t* GetSolidRow(int rowIndex) const;
+
+	/**
+	 * Gets the indices of one of the level's torches.
+	 * @param index The torch to fetch, less than the header's torchCount.
+	 * @return The column and row of the torch tile.
+	 */
+	GridCoord GetTorchIndices(int index) const;
+
+	/**
+	 * Writes a grid to a binary level file.
+	 * @param fileName The path of the file to write.
+	 * @param grid The grid to write.
+	 * @return True if the file was written successfully.
+	 */
+	static bool Write(const std::string& fileName, const LevelGrid& grid);
+
+	/**
+	 * Writes a grid as a binary level file image to a stream.
+	 * @param stream The binary stream to write to.
+	 * @param grid The grid to write.
+	 * @return True if the image was written successfully.
+	 */
+	static bool Write(std::ostream& stream, const LevelGrid& grid);
+
+	/**
+	 * Gets the size of the binary level file image of a grid.
+	 * @param width The number of columns in the grid.
+	 * @param height The number of rows in the grid.
+	 * @param torchCount The number of torches in the grid.
+	 * @return The size of the image in bytes.
+	 */
+	static std::uint64_t GetImageSize(int width, int height, int torchCount);
+
+	/**
+	 * Checks if a path names a binary level file, by its extension.
+	 * @param fileName The path to check.
+	 * @return True if the path ends in LEVEL_FILE_EXTENSION.
+	 */
+	static bool IsLevelFileName(const std::string& fileName);
+
+private:
+	/**
+	 * Checks that the mapped header describes a file that fits inside the mapping.
+	 * @return True if the header is valid.
+	 */
+	bool ValidateHeader() const;
+
+	/**
+	 * Checks that a block of the file lies after the header and inside the mapping.
+	 * @param offset The offset of the block.
+	 * @param bytes The size of the block.
+	 * @return True if the block fits.
+	 */
+	bool FitsInFile(std::uint64_t offset, std::uint64_t bytes) const;
+
+private:
+	/**
+	 * The start of the mapped file, or nullptr if no file is open.
+	 */
+	const std::uint8_t* m_data;
+
+	/**
+	 * The size of the mapped file in bytes.
+	 */
+	std::size_t m_size;
+};
+#endif
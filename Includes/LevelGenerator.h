@@ -0,0 +1,125 @@
+//-------------------------------------------------------------------------------------
+// LevelGenerator.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LEVELGENERATOR_H
+#define LEVELGENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelConnectivity.h"
+#include "LevelGrid.h"
+#include "Random.h"
+
+// The number of torches placed in every generated level.
+static int const LEVEL_TORCH_COUNT = 5;
+
+/**
+ * Generates maze floors. The output only depends on the seed and the level size,
+ * so a floor can be generated on any thread and come out bit-identical.
+ * A generator keeps its working buffers between calls; use one generator per thread.
+ */
+class LevelGenerator
+{
+public:
+	/**
+	 * Constructor.
+	 * Mazes need odd dimensions, so even sizes are rounded down. The smallest size is 5 x 5.
+	 * @param width The number of columns in generated levels.
+	 * @param height The number of rows in generated levels.
+	 */
+	LevelGenerator(int width = GRID_WIDTH, int height = GRID_HEIGHT);
+
+	/**
+	 * Generates a floor into the given grid, resizing it to the generator's level size.
+	 * Before the floor is decorated, it is checked that its entrance can reach its door, and passable pockets
+	 * that can't be reached are filled in.
+	 * @param seed The seed of the floor.
+	 * @param grid The grid to fill.
+	 * @return True if the floor passed the check. A floor that failed is left unfinished and should be discarded.
+	 */
+	bool Generate(std::uint64_t seed, LevelGrid& grid);
+
+	/**
+	 * Gets the result of the last floor's connectivity check, taken before its pockets were filled.
+	 * @return The report.
+	 */
+	const ConnectivityReport& GetLastReport() const;
+
+	/**
+	 * Gets the width of generated levels.
+	 * @return The number of columns in generated levels.
+	 */
+	int GetWidth() const;
+
+	/**
+	 * Gets the height of generated levels.
+	 * @return The number of rows in generated levels.
+	 */
+	int GetHeight() const;
+
+private:
+	/**
+	 * Carves a maze through a grid of walls, using an iterative recursive backtracker over the odd cells.
+	 * @param random The floor's random stream.
+	 * @param grid The grid to carve.
+	 */
+	void CarveMaze(Random& random, LevelGrid& grid);
+
+	/**
+	 * Removes some of the walls between neighbouring corridors, so the maze has loops.
+	 * @param random The floor's random stream.
+	 * @param grid The grid to change.
+	 */
+	void RemoveWalls(Random& random, LevelGrid& grid);
+
+	/**
+	 * Places the locked door in the top wall and the entrance in the bottom wall.
+	 * @param random The floor's random stream.
+	 * @param grid The grid to change.
+	 */
+	void PlaceFeatures(Random& random, LevelGrid& grid);
+
+	/**
+	 * Places the torches on the floor.
+	 * @param random The floor's random stream.
+	 * @param grid The grid to change.
+	 */
+	void PlaceTorches(Random& random, LevelGrid& grid);
+
+private:
+	/**
+	 * The number of columns in generated levels.
+	 */
+	int m_width;
+
+	/**
+	 * The number of rows in generated levels.
+	 */
+	int m_height;
+
+	/**
+	 * The cells on the current path of the maze carver. Reused between floors.
+	 */
+	std::vector<GridCoord> m_stack;
+
+	/**
+	 * The floor tiles torches can be placed on. Reused between floors.
+	 */
+	std::vector<GridCoord> m_floorTiles;
+
+	/**
+	 * Checks the connectivity of every floor. Reused between floors.
+	 */
+	LevelConnectivity m_connectivity;
+
+	/**
+	 * The result of the last floor's connectivity check.
+	 */
+	ConnectivityReport m_lastReport;
+};
+#endif
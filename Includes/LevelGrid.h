@@ -0,0 +1,353 @@
+//-------------------------------------------------------------------------------------
+// LevelGrid.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LEVELGRID_H
+#define LEVELGRID_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Util.h"
+
+class LevelFile;
+
+// Constants for the default game grid size.
+static int const GRID_WIDTH = 19;
+static int const GRID_HEIGHT = 19;
+
+// A column and row pair addressing a single cell of the level grid.
+struct GridCoord {
+	int x;								// The column index.
+	int y;								// The row index.
+};
+
+inline bool operator==(const GridCoord& lhs, const GridCoord& rhs)
+{
+	return (lhs.x == rhs.x) && (lhs.y == rhs.y);
+}
+
+inline bool operator!=(const GridCoord& lhs, const GridCoord& rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * The headless part of a level: the tile grid and the rules that operate on it.
+ * This class has no dependency on SFML so it can be used by batch tools that never open a window.
+ * The grid is stored as a structure of arrays so the hot per-cell data stays small:
+ * one byte per tile type, and one bit per tile in a row-packed solidity bitmap.
+ */
+class LevelGrid
+{
+public:
+	/**
+	 * Default constructor.
+	 * Creates a GRID_WIDTH x GRID_HEIGHT grid where every cell is TILE::EMPTY.
+	 */
+	LevelGrid();
+
+	/**
+	 * Constructor.
+	 * Creates a grid of the given size where every cell is TILE::EMPTY.
+	 * @param width The number of columns in the grid.
+	 * @param height The number of rows in the grid.
+	 */
+	LevelGrid(int width, int height);
+
+	/**
+	 * Resizes the grid, resetting every cell to TILE::EMPTY.
+	 * @param width The new number of columns in the grid.
+	 * @param height The new number of rows in the grid.
+	 */
+	void Resize(int width, int height);
+
+	/**
+	 * Gets the width of the grid in tiles.
+	 * @return The number of columns in the grid.
+	 */
+	int GetWidth() const;
+
+	/**
+	 * Gets the height of the grid in tiles.
+	 * @return The number of rows in the grid.
+	 */
+	int GetHeight() const;
+
+	/**
+	 * Checks if a given tile is valid.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return True if the tile is inside the grid.
+	 */
+	bool TileIsValid(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the type of the given tile.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The type of the tile, or TILE::EMPTY if the indices are not valid.
+	 */
+	TILE GetTileType(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Sets the type of the given tile. Invalid indices and types are ignored.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @param tileType The new type of the tile.
+	 */
+	void SetTileType(int columnIndex, int rowIndex, TILE tileType);
+
+	/**
+	 * Returns true if the given tile blocks movement.
+	 * Tiles outside of the grid are not solid.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return True if the given tile is solid.
+	 */
+	bool IsSolid(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Return true if the given tile is a floor tile.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return True if the given tile is a floor tile.
+	 */
+	bool IsFloor(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Checks if a given tile is a wall block.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return True if the given tile is a wall tile.
+	 */
+	bool IsWall(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Assigns the correct wall variant to every wall tile from the 4 neighbours it joins to.
+	 * Rows are processed a 64 tile word at a time from packed wall bitmaps.
+	 * Door and entrance tiles keep their type but count as walls for their neighbours.
+	 */
+	void Autotile();
+
+	/**
+	 * Assigns the correct wall variant to the wall tiles inside a rectangle. Out of range parts are ignored.
+	 * @param firstColumn The leftmost column of the rectangle.
+	 * @param firstRow The top row of the rectangle.
+	 * @param lastColumn The rightmost column of the rectangle.
+	 * @param lastRow The bottom row of the rectangle.
+	 */
+	void AutotileRegion(int firstColumn, int firstRow, int lastColumn, int lastRow);
+
+	/**
+	 * Gets the tile types of a single row.
+	 * @param rowIndex The row to fetch. Must be valid.
+	 * @return A pointer to GetWidth() tile types, one byte each.
+	 */
+	const std::uint8_t* GetTypeRow(int rowIndex) const;
+
+	/**
+	 * Gets the solidity bits of a single row. Bit (columnIndex % 64) of word (columnIndex / 64) is set if the tile is solid.
+	 * @param rowIndex The row to fetch. Must be valid.
+	 * @return A pointer to GetWordsPerRow() words.
+	 */
+	const std::uint64_t* GetSolidRow(int rowIndex) const;
+
+	/**
+	 * Gets the number of 64 bit words used to store one row of the solidity bitmap.
+	 * @return The number of words per bitmap row.
+	 */
+	int GetWordsPerRow() const;
+
+	/**
+	 * Gets the solidity bits of a single column, from a copy of the bitmap stored column by column.
+	 * Bit (rowIndex % 64) of word (rowIndex / 64) is set if the tile is solid. Bits past the last row are set.
+	 * @param columnIndex The column to fetch. Must be valid.
+	 * @return A pointer to GetWordsPerColumn() words.
+	 */
+	const std::uint64_t* GetSolidColumn(int columnIndex) const;
+
+	/**
+	 * Gets the number of 64 bit words used to store one column of the column by column solidity bitmap.
+	 * @return The number of words per bitmap column.
+	 */
+	int GetWordsPerColumn() const;
+
+	/**
+	 * Loads the grid from a level file. Files ending in LEVEL_FILE_EXTENSION are loaded as binary level files,
+	 * anything else as a text level file.
+	 * @param fileName The path to the level file to load.
+	 * @return True if the level loaded successfully.
+	 */
+	bool LoadFromFile(const std::string& fileName);
+
+	/**
+	 * Loads the grid from a text file made of bracketed two digit tile ids, e.g. [05][19][19].
+	 * The size of the grid is taken from the file: one row per line, one tile per bracket. Torches follow as lines
+	 * of "torch <column> <row>"; those outside the grid are dropped.
+	 * @param fileName The path to the level file to load.
+	 * @return True if the level loaded successfully.
+	 */
+	bool LoadFromTextFile(const std::string& fileName);
+
+	/**
+	 * Saves the grid as a text file in the format read by LoadFromTextFile().
+	 * Torches are saved; the seed is not part of the text format and is not saved.
+	 * @param fileName The path of the file to write.
+	 * @return True if the file was written successfully.
+	 */
+	bool SaveToTextFile(const std::string& fileName) const;
+
+	/**
+	 * Loads the grid from an open binary level file. The tile types and solidity bitmap are copied
+	 * straight out of the mapping. Files holding unknown tile types, a solidity bitmap that disagrees with the types,
+	 * or a door or torch off the grid are rejected and leave the grid unchanged.
+	 * @param file The mapped level file.
+	 * @return True if the level loaded successfully.
+	 */
+	bool LoadFromLevelFile(const LevelFile& file);
+
+	/**
+	 * Gets the indices of the tile containing the level's door.
+	 * @return The column and row of the door tile.
+	 */
+	GridCoord GetDoorIndices() const;
+
+	/**
+	 * Sets the indices of the tile containing the level's door.
+	 * @param doorIndices The column and row of the door tile.
+	 */
+	void SetDoorIndices(GridCoord doorIndices);
+
+	/**
+	 * Gets the indices of all tiles that hold a torch.
+	 * @return A vector of torch tile indices.
+	 */
+	const std::vector<GridCoord>& GetTorchIndices() const;
+
+	/**
+	 * Sets the indices of all tiles that hold a torch.
+	 * @param torchIndices The torch tile indices.
+	 */
+	void SetTorchIndices(const std::vector<GridCoord>& torchIndices);
+
+	/**
+	 * Gets the seed the grid was generated from.
+	 * @return The seed, or 0 if the grid was hand authored.
+	 */
+	std::uint64_t GetSeed() const;
+
+	/**
+	 * Sets the seed the grid was generated from. It is stored in binary level files.
+	 * @param seed The seed.
+	 */
+	void SetSeed(std::uint64_t seed);
+
+	/**
+	 * Return true if the given tile type is a floor type.
+	 * @param tileType The type to check.
+	 * @return True if the given type is a floor type.
+	 */
+	static bool IsFloorType(TILE tileType);
+
+	/**
+	 * Return true if the given tile type blocks movement.
+	 * @param tileType The type to check.
+	 * @return True if the given type is solid.
+	 */
+	static bool IsSolidType(TILE tileType);
+
+	/**
+	 * Return true if walls next to the given tile type should join up with it.
+	 * @param tileType The type to check.
+	 * @return True for all wall, door and entrance types.
+	 */
+	static bool JoinsWalls(TILE tileType);
+
+	/**
+	 * Gets the wall variant that fits a set of joining neighbours.
+	 * @param mask The joining neighbours: 1 = up, 2 = right, 4 = down, 8 = left.
+	 * @return The wall tile type.
+	 */
+	static TILE GetWallVariant(int mask);
+
+private:
+	/**
+	 * Gets the offset of the given tile in the type array.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @return The row-major offset of the tile.
+	 */
+	int GetIndex(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Sets or clears the solidity bit of the given tile.
+	 * @param columnIndex The column that the tile is in.
+	 * @param rowIndex The row that the tile is in.
+	 * @param isSolid The new solidity of the tile.
+	 */
+	void SetSolidBit(int columnIndex, int rowIndex, bool isSolid);
+
+	/**
+	 * Packs the tiles of a row that walls join to into a bitmap. Rows outside the grid give an empty bitmap.
+	 * @param rowIndex The row to pack.
+	 * @param bits The GetWordsPerRow() words to write to.
+	 */
+	void PackJoinRow(int rowIndex, std::uint64_t* bits) const;
+
+private:
+	/**
+	 * The number of columns in the grid.
+	 */
+	int m_width;
+
+	/**
+	 * The number of rows in the grid.
+	 */
+	int m_height;
+
+	/**
+	 * The number of 64 bit words in each row of the solidity bitmap.
+	 */
+	int m_wordsPerRow;
+
+	/**
+	 * The number of 64 bit words in each column of the column by column solidity bitmap.
+	 */
+	int m_wordsPerColumn;
+
+	/**
+	 * The type of every tile in the level, stored row by row.
+	 */
+	std::vector<std::uint8_t> m_types;
+
+	/**
+	 * The solidity of every tile in the level, one bit per tile, stored row by row.
+	 */
+	std::vector<std::uint64_t> m_solid;
+
+	/**
+	 * The same bits as m_solid, stored column by column, so vertical runs can be scanned a word at a time.
+	 */
+	std::vector<std::uint64_t> m_solidColumns;
+
+	/**
+	 * The indices of the tile containing the levels door.
+	 */
+	GridCoord m_doorIndices;
+
+	/**
+	 * The indices of all tiles holding a torch.
+	 */
+	std::vector<GridCoord> m_torchIndices;
+
+	/**
+	 * The seed the grid was generated from, or 0.
+	 */
+	std::uint64_t m_seed;
+};
+#endif
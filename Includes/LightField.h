@@ -0,0 +1,238 @@
+//-------------------------------------------------------------------------------------
+// LightField.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LIGHTFIELD_H
+#define LIGHTFIELD_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+
+// The level of the brightest light. Light loses one level for every tile it travels.
+static int const LIGHT_LEVEL_MAX = 15;
+
+// The number of colour channels light is carried in.
+static int const LIGHT_CHANNEL_COUNT = 3;
+
+/**
+ * The colour of a light, as a level from 0 to LIGHT_LEVEL_MAX per channel.
+ */
+struct LightColor {
+	std::uint8_t red;						// The level of the red channel.
+	std::uint8_t green;						// The level of the green channel.
+	std::uint8_t blue;						// The level of the blue channel.
+};
+
+/**
+ * Coloured light flooded out from emitters through the passable tiles of a grid, one level lost per step.
+ * Each channel spreads on its own, so a warm light turns redder as its green and blue die out first.
+ * Walls stop light; a wall only holds light if an emitter sits on it, e.g. a wall torch, which lights the floor
+ * next to it. Changes are applied incrementally with a pair of breadth first queues: light that was removed,
+ * or lost its source when a wall went up, is cleared outwards from where it changed, and whatever still lights
+ * the cleared tiles from their edge floods back in. Only the tiles the changed light reached are visited.
+ */
+class LightField
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	LightField();
+
+	/**
+	 * Sizes the field to a grid and removes every light. Every tile starts dark.
+	 * @param grid The grid light floods across. Pass the same grid to every other call.
+	 */
+	void Reset(const LevelGrid& grid);
+
+	/**
+	 * Adds a light. A light off the grid lights nothing until it is moved onto it.
+	 * @param grid The grid light floods across.
+	 * @param tile The tile the light is on.
+	 * @param color The colour and level of the light.
+	 * @return The id of the light. Ids of removed lights are reused.
+	 */
+	int AddLight(const LevelGrid& grid, GridCoord tile, LightColor color);
+
+	/**
+	 * Moves a light to another tile. A light moved off the grid lights nothing until it is moved back onto it.
+	 * @param grid The grid light floods across.
+	 * @param id The id of the light.
+	 * @param tile The tile to move to.
+	 */
+	void MoveLight(const LevelGrid& grid, int id, GridCoord tile);
+
+	/**
+	 * Changes the colour of a light. Does nothing if the colour is the same.
+	 * @param grid The grid light floods across.
+	 * @param id The id of the light.
+	 * @param color The new colour and level.
+	 */
+	void SetLightColor(const LevelGrid& grid, int id, LightColor color);
+
+	/**
+	 * Removes a light.
+	 * @param grid The grid light floods across.
+	 * @param id The id of the light.
+	 */
+	void RemoveLight(const LevelGrid& grid, int id);
+
+	/**
+	 * Brings a tile up to date after it became passable or blocked, e.g. by Level::SetTile().
+	 * @param grid The grid light floods across, already changed.
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 */
+	void UpdateTile(const LevelGrid& grid, int columnIndex, int rowIndex);
+
+	/**
+	 * Gets the light on a tile.
+	 * @param columnIndex The column of the tile.
+	 * @param rowIndex The row of the tile.
+	 * @return The level of every channel. Tiles outside the grid are dark.
+	 */
+	LightColor GetLight(int columnIndex, int rowIndex) const;
+
+	/**
+	 * Gets the number of lights.
+	 * @return The number of lights.
+	 */
+	int GetLightCount() const;
+
+	/**
+	 * Gets the number of tiles the last change visited, across every channel.
+	 * @return The number of tiles visited.
+	 */
+	int GetLastVisitCount() const;
+
+private:
+	/**
+	 * A light.
+	 */
+	struct Light {
+		int tile;							// The index of the tile the light is on, or -1 if it is off the grid.
+		LightColor color;					// The colour and level of the light.
+		int nextLight;						// The id of the next light on the same tile, or -1.
+	};
+
+	/**
+	 * A tile whose light is being cleared.
+	 */
+	struct RemovedLight {
+		int tile;							// The index of the tile.
+		int level;							// The level the tile had before it was cleared.
+	};
+
+	/**
+	 * Gets the index of a tile.
+	 * @param tile The tile.
+	 * @return The index, or -1 if the tile is off the grid.
+	 */
+	int GetTileIndex(GridCoord tile) const;
+
+	/**
+	 * Adds a light to the list of lights on its tile.
+	 * @param id The id of the light.
+	 */
+	void LinkLight(int id);
+
+	/**
+	 * Removes a light from the list of lights on its tile.
+	 * @param id The id of the light.
+	 */
+	void UnlinkLight(int id);
+
+	/**
+	 * Recomputes the light given off on a tile from the lights on it, and floods the difference.
+	 * @param grid The grid light floods across.
+	 * @param tile The index of the tile.
+	 */
+	void UpdateEmission(const LevelGrid& grid, int tile);
+
+	/**
+	 * Clears the light of one channel on a tile and every tile it lit, then queues what still lights them.
+	 * @param channel The channel to clear.
+	 * @param tile The index of the tile.
+	 */
+	void ClearFrom(int channel, int tile);
+
+	/**
+	 * Floods one channel outwards from every queued tile.
+	 * @param grid The grid light floods across.
+	 * @param channel The channel to flood.
+	 */
+	void Flood(const LevelGrid& grid, int channel);
+
+	/**
+	 * Checks if light can pass through a tile.
+	 * @param grid The grid light floods across.
+	 * @param tile The index of the tile.
+	 * @return True if the tile is passable.
+	 */
+	bool IsPassable(const LevelGrid& grid, int tile) const;
+
+	/**
+	 * Gets the tiles next to a tile, up, right, down and left, that are on the grid.
+	 * @param tile The index of the tile.
+	 * @param neighbors Receives the indices of the tiles.
+	 * @return The number of tiles written.
+	 */
+	int GetNeighbors(int tile, int* neighbors) const;
+
+private:
+	/**
+	 * The width of the grid, in tiles.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid, in tiles.
+	 */
+	int m_height;
+
+	/**
+	 * The light level of every tile, a channel at a time, each row by row.
+	 */
+	std::vector<std::uint8_t> m_levels;
+
+	/**
+	 * The level given off on every tile by the lights on it, laid out like m_levels.
+	 */
+	std::vector<std::uint8_t> m_emission;
+
+	/**
+	 * Every light, by id.
+	 */
+	std::vector<Light> m_lights;
+
+	/**
+	 * The id of the first light on every tile, or -1. The rest follow through Light::nextLight.
+	 */
+	std::vector<int> m_firstLights;
+
+	/**
+	 * The ids of removed lights, ready for reuse.
+	 */
+	std::vector<int> m_freeIds;
+
+	/**
+	 * The tiles to flood outwards from. Kept so changes don't allocate.
+	 */
+	std::vector<int> m_floodQueue;
+
+	/**
+	 * The tiles whose light is being cleared. Kept so changes don't allocate.
+	 */
+	std::vector<RemovedLight> m_clearQueue;
+
+	/**
+	 * The number of tiles the last change visited.
+	 */
+	int m_lastVisitCount;
+};
+#endif
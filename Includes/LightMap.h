@@ -0,0 +1,179 @@
+//-------------------------------------------------------------------------------------
+// LightMap.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <vector>
+#include "FieldOfView.h"
+
+static float const PLAYER_LIGHT_INNER_RADIUS = 200.f;	// Cells closer to the player than this are fully lit.
+static float const PLAYER_LIGHT_OUTER_RADIUS = 250.f;	// Cells further from the player than this are fully dark, unless a torch lights them.
+static float const TORCH_LIGHT_RADIUS = 100.f;			// The distance a torch lights.
+static float const LIGHT_MAX_DARKNESS = 255.f;			// The darkness of an unlit cell.
+
+/**
+ * The darkness of every cell of a grid laid over the level, lit by the player and by torches.
+ * The player lights everything within PLAYER_LIGHT_INNER_RADIUS and fades out to full darkness at
+ * PLAYER_LIGHT_OUTER_RADIUS. Each torch then takes away a share of the darkness of the cells within
+ * TORCH_LIGHT_RADIUS, largest at the torch, scaled by the torch's brightness.
+ * Torches don't move, so the share each one takes from each cell is baked once when they are added. An update
+ * only recomputes the player's light in the cells around the player's old and new positions, and multiplies the
+ * baked shares by the torches' current brightness, so its cost doesn't grow with the number of cells.
+ * Light can be kept from passing through walls by giving the player and each torch a field of view. Cell corners
+ * are then only lit if they touch a tile the light can see, which needs the cells to line up with the level's tiles.
+ */
+class LightMap
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	LightMap();
+
+	/**
+	 * Lays the grid over an area and removes every torch. Every cell starts fully dark.
+	 * @param left The left edge of the top left cell.
+	 * @param top The top edge of the top left cell.
+	 * @param cellSize The side of a cell.
+	 * @param columns The number of cell columns.
+	 * @param rows The number of cell rows.
+	 */
+	void Reset(float left, float top, float cellSize, int columns, int rows);
+
+	/**
+	 * Removes every torch, keeping the grid.
+	 */
+	void ClearTorches();
+
+	/**
+	 * Adds a torch, baking its share of the darkness of every cell it lights.
+	 * @param x The horizontal position of the torch.
+	 * @param y The vertical position of the torch.
+	 * @param view The tiles the torch can see, or nullptr to light through walls.
+	 * @return The index of the torch, which its brightness is passed at in Update().
+	 */
+	int AddTorch(float x, float y, const FieldOfView* view = nullptr);
+
+	/**
+	 * Brings the darkness of every cell up to date.
+	 * @param playerX The horizontal position of the player.
+	 * @param playerY The vertical position of the player.
+	 * @param torchBrightness The brightness of every torch, in the order they were added. 1 is normal.
+	 * @param playerView The tiles the player can see, or nullptr to light through walls.
+	 */
+	void Update(float playerX, float playerY, const float* torchBrightness, const FieldOfView* playerView = nullptr);
+
+	/**
+	 * Gets the darkness of a cell as of the last update.
+	 * @param column The column of the cell.
+	 * @param row The row of the cell.
+	 * @return The darkness, from 0 for fully lit to LIGHT_MAX_DARKNESS.
+	 */
+	float GetDarkness(int column, int row) const;
+
+	/**
+	 * Gets the number of cell columns.
+	 * @return The number of columns.
+	 */
+	int GetColumnCount() const;
+
+	/**
+	 * Gets the number of cell rows.
+	 * @return The number of rows.
+	 */
+	int GetRowCount() const;
+
+	/**
+	 * Gets the number of torches.
+	 * @return The number of torches.
+	 */
+	int GetTorchCount() const;
+
+private:
+	/**
+	 * A rectangle of cells.
+	 */
+	struct CellRange {
+		int firstColumn;					// The leftmost column.
+		int firstRow;						// The top row.
+		int lastColumn;						// The rightmost column. Less than firstColumn if the range is empty.
+		int lastRow;						// The bottom row. Less than firstRow if the range is empty.
+	};
+
+	/**
+	 * Gets the cells whose corner is within a distance of a point, clamped to the grid.
+	 * @param x The horizontal position of the point.
+	 * @param y The vertical position of the point.
+	 * @param radius The distance.
+	 * @return The cells.
+	 */
+	CellRange GetCellRange(float x, float y, float radius) const;
+
+private:
+	/**
+	 * The left edge of the top left cell.
+	 */
+	float m_left;
+
+	/**
+	 * The top edge of the top left cell.
+	 */
+	float m_top;
+
+	/**
+	 * The side of a cell.
+	 */
+	float m_cellSize;
+
+	/**
+	 * The number of cell columns.
+	 */
+	int m_columns;
+
+	/**
+	 * The number of cell rows.
+	 */
+	int m_rows;
+
+	/**
+	 * The darkness the player's light leaves in every cell.
+	 */
+	std::vector<float> m_playerDarkness;
+
+	/**
+	 * The share of the player's darkness the torches leave in every cell. 1 where no torch reaches.
+	 */
+	std::vector<float> m_torchFactors;
+
+	/**
+	 * The cells the player lit in the last update. Only these need resetting when the player moves.
+	 */
+	CellRange m_playerCells;
+
+	/**
+	 * The squared horizontal distance from the player to every column. Kept so updates don't allocate.
+	 */
+	std::vector<float> m_columnDistances;
+
+	/**
+	 * The first baked cell of every torch, plus one past the last torch's.
+	 */
+	std::vector<int> m_torchCellStarts;
+
+	/**
+	 * The cells every torch lights, torch by torch.
+	 */
+	std::vector<int> m_bakedCells;
+
+	/**
+	 * The share of the darkness each baked cell's torch takes away at normal brightness.
+	 */
+	std::vector<float> m_bakedShares;
+};
+#endif
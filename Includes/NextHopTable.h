@@ -0,0 +1,135 @@
+//-------------------------------------------------------------------------------------
+// NextHopTable.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef NEXTHOPTABLE_H
+#define NEXTHOPTABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "FlowField.h"
+#include "LevelGrid.h"
+
+// The largest grid, in tiles, a table is built for: room for the shipped 19x19 floors and a little more. The table
+// takes one byte per pair of tiles, and a rebuild floods a field from every tile.
+static int const NEXT_HOP_MAX_TILES = 24 * 24;
+
+/**
+ * An all-pairs table of first steps: for every pair of tiles, the direction of the first step of a shortest path.
+ * A path query is then a walk through the table with no search at all. The table takes one byte per pair of
+ * tiles, so it is only built for small levels; the shipped 19x19 floors need 130KB.
+ * Each target tile gets its own flow field, and the fields are built in parallel with a BatchRunner.
+ * Moves and costs match Pathfinder. After walkability changes the table answers nothing until it is rebuilt, either
+ * all at once with Update(), or a slice per frame with UpdateSliced() so the rebuild never lands on a single frame.
+ */
+class NextHopTable
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	NextHopTable();
+
+	/**
+	 * Rebuilds the table if it was invalidated or the grid changed size.
+	 * @param grid The grid to build the table over. Solid tiles are blocked.
+	 * @param threadCount The number of threads to build with. 0 uses every core.
+	 * @return True if the table can answer queries. False if the grid has more than NEXT_HOP_MAX_TILES tiles.
+	 */
+	bool Update(const LevelGrid& grid, int threadCount = 0);
+
+	/**
+	 * Carries on rebuilding the table if it was invalidated or the grid changed size, for up to a time budget.
+	 * The fields are built one target at a time on the calling thread, and the table only answers once all are done.
+	 * @param grid The grid to build the table over. Pass the same grid until the rebuild finishes.
+	 * @param maxMicroseconds The most time to spend, or zero for no time limit.
+	 * @return True if the table can answer queries. False if it is still being rebuilt, or the grid is too large.
+	 */
+	bool UpdateSliced(const LevelGrid& grid, double maxMicroseconds);
+
+	/**
+	 * Marks the table as out of date, so it answers nothing until it is rebuilt. Call this when walkability changes.
+	 */
+	void Invalidate();
+
+	/**
+	 * Checks if the table is up to date and can answer queries.
+	 * @return True if the table is ready.
+	 */
+	bool IsReady() const;
+
+	/**
+	 * Gets the tile to step to from one tile to get closer to another.
+	 * @param from The tile to step from.
+	 * @param to The tile to reach.
+	 * @param next Receives the tile to step to.
+	 * @return True if there is a step to take. False if the tiles are the same, or to can't be reached.
+	 */
+	bool GetNextStep(GridCoord from, GridCoord to, GridCoord& next) const;
+
+	/**
+	 * Walks the table from one tile to another.
+	 * @param from The tile to start from.
+	 * @param to The tile to reach.
+	 * @param path Receives the tiles of the path, from the tile after from up to and including to.
+	 * @return True if a path was found.
+	 */
+	bool FindPath(GridCoord from, GridCoord to, std::vector<GridCoord>& path) const;
+
+	/**
+	 * Gets the memory the table takes.
+	 * @return The size of the table in bytes.
+	 */
+	size_t GetByteCount() const;
+
+private:
+	/**
+	 * Gets the index of a tile in the table.
+	 * @param tile The tile.
+	 * @return The index, or -1 if the tile is outside the grid.
+	 */
+	int GetTileIndex(GridCoord tile) const;
+
+	/**
+	 * Sizes the table to a grid, starting the rebuild over if the size changed.
+	 * @param grid The grid to build the table over.
+	 * @return False if the grid has more than NEXT_HOP_MAX_TILES tiles.
+	 */
+	bool Resize(const LevelGrid& grid);
+
+private:
+	/**
+	 * The width of the grid the table was built over.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid the table was built over.
+	 */
+	int m_height;
+
+	/**
+	 * True if the table has to be rebuilt before it is used.
+	 */
+	bool m_isDirty;
+
+	/**
+	 * The next target tile a sliced rebuild builds the field of.
+	 */
+	int m_nextTarget;
+
+	/**
+	 * The field a sliced rebuild builds each target with. Kept so rebuilding doesn't allocate.
+	 */
+	FlowField m_field;
+
+	/**
+	 * The direction of the first step, as used by FlowField. The step from tile f towards tile t is at (t * tiles) + f.
+	 */
+	std::vector<std::uint8_t> m_directions;
+};
+#endif
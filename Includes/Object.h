@@ -57,6 +57,16 @@ public:
 	 */
 	bool SetSprite(sf::Texture& texture, bool isSmooth, int frames = 1, int frameSpeed = 0);
 
+	/**
+	 * Creates and sets the object sprite from a region of a texture, such as an image on the texture atlas.
+	 * The frames are laid out left to right across the region.
+	 * @param region The texture and rectangle holding the frames.
+	 * @param frames The number of frames in the sprite. Defaults to 1.
+	 * @param frameSpeed The speed that the animation plays at. Defaults to 1.
+	 * @return true if the operation succeeded.
+	 */
+	bool SetSprite(const TextureRegion& region, bool isSmooth, int frames = 1, int frameSpeed = 0);
+
 	/**
 	 * Returns a reference the object's sprite.
 	 * @return A reference to the object's sprite.
@@ -82,6 +92,11 @@ public:
 	void SetAnimated(bool isAnimated);
 
 protected:
+	/**
+	 * Swaps the sprite's frames for another strip with the same frame layout, keeping the current frame.
+	 * @param region The texture and rectangle holding the new frames.
+	 */
+	void SetFrameRegion(const TextureRegion& region);
 
 	/**
 	 * The object's sprite.
@@ -132,6 +147,11 @@ private:
 	 */
 	int m_frameHeight;
 
+	/**
+	 * The top-left corner of the first frame on the sprite's texture.
+	 */
+	sf::Vector2i m_frameOrigin;
+
 	/**
 	 * An aggregate of the time passed between draw calls.
 	 */
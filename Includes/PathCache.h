@@ -0,0 +1,170 @@
+//-------------------------------------------------------------------------------------
+// PathCache.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+
+// The width and height in tiles of the regions whose walkability is versioned.
+static int const PATH_CACHE_REGION_SIZE = 16;
+
+// The number of paths the cache holds.
+static int const PATH_CACHE_SLOT_COUNT = 256;
+
+/**
+ * Counters describing how well the cache is doing.
+ */
+struct PathCacheStats {
+	std::uint64_t hitCount;				// Lookups answered from the cache.
+	std::uint64_t missCount;			// Lookups that found nothing for the tile pair.
+	std::uint64_t staleCount;			// Lookups that found a path, but a tile along it had changed since.
+	double searchMicroseconds;			// Time spent on the searches whose results were stored.
+	std::uint64_t storeCount;			// The number of results stored.
+};
+
+/**
+ * A cache of path results keyed by start and goal tile.
+ * The grid is split into square regions, each with a walkability version that is bumped whenever a tile in it
+ * becomes passable or blocked. A stored path remembers the version of every region it passes through, and is
+ * reused until one of them changes. Slots are picked by hashing the tile pair, and a new path replaces whatever
+ * was in its slot. Slots keep their capacity, so once warm the cache makes no heap allocations.
+ */
+class PathCache
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	PathCache();
+
+	/**
+	 * Sizes the cache for a grid and forgets every stored path. The counters are kept.
+	 * @param width The width of the grid in tiles.
+	 * @param height The height of the grid in tiles.
+	 */
+	void Reset(int width, int height);
+
+	/**
+	 * Bumps the walkability version of the region a tile is in. Call this when the tile becomes passable or blocked.
+	 * @param columnIndex The column of the changed tile.
+	 * @param rowIndex The row of the changed tile.
+	 */
+	void OnTileChanged(int columnIndex, int rowIndex);
+
+	/**
+	 * Looks up a stored path.
+	 * @param start The tile the path starts from.
+	 * @param goal The tile the path leads to.
+	 * @param path Receives a copy of the stored path if there is one that is still valid.
+	 * @return True if a valid path was found.
+	 */
+	bool Lookup(GridCoord start, GridCoord goal, std::vector<GridCoord>& path);
+
+	/**
+	 * Stores a path found by a search.
+	 * @param start The tile the path starts from.
+	 * @param goal The tile the path leads to.
+	 * @param path The tiles of the path, from the tile after start up to and including goal.
+	 * @param searchMicroseconds How long the search took, used to estimate the time hits save.
+	 */
+	void Store(GridCoord start, GridCoord goal, const std::vector<GridCoord>& path, double searchMicroseconds);
+
+	/**
+	 * Gets the counters.
+	 * @return The counters since the cache was created or the counters were last cleared.
+	 */
+	const PathCacheStats& GetStats() const;
+
+	/**
+	 * Estimates the search time hits have saved, from the average time of the searches that were stored.
+	 * @return The saved time in microseconds.
+	 */
+	double GetSavedMicroseconds() const;
+
+	/**
+	 * Clears the counters.
+	 */
+	void ClearStats();
+
+private:
+	/**
+	 * A region a stored path passes through, and its version when the path was stored.
+	 */
+	struct RegionVersion {
+		int region;							// The index of the region.
+		std::uint32_t version;				// The region's version when the path was stored.
+	};
+
+	/**
+	 * A stored path.
+	 */
+	struct Slot {
+		bool isValid;						// True if the slot holds a path.
+		GridCoord start;					// The tile the path starts from.
+		GridCoord goal;						// The tile the path leads to.
+		std::vector<GridCoord> path;		// The tiles of the path.
+		std::vector<RegionVersion> regions;	// Every region the path passes through.
+	};
+
+	/**
+	 * Gets the slot a tile pair is stored in.
+	 * @param start The tile the path starts from.
+	 * @param goal The tile the path leads to.
+	 * @return The slot.
+	 */
+	Slot& GetSlot(GridCoord start, GridCoord goal);
+
+	/**
+	 * Gets the region a tile is in.
+	 * @param tile The tile. Must be inside the grid.
+	 * @return The index of the region.
+	 */
+	int GetRegionIndex(GridCoord tile) const;
+
+	/**
+	 * Adds the region a tile is in to a slot, unless it is already the last one added.
+	 * @param slot The slot.
+	 * @param tile The tile.
+	 */
+	void AddRegion(Slot& slot, GridCoord tile) const;
+
+private:
+	/**
+	 * The width of the grid in tiles.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid in tiles.
+	 */
+	int m_height;
+
+	/**
+	 * The number of regions across the grid.
+	 */
+	int m_regionColumns;
+
+	/**
+	 * The walkability version of every region, stored row by row.
+	 */
+	std::vector<std::uint32_t> m_regionVersions;
+
+	/**
+	 * The stored paths.
+	 */
+	std::vector<Slot> m_slots;
+
+	/**
+	 * The counters.
+	 */
+	PathCacheStats m_stats;
+};
+#endif
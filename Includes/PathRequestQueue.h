@@ -0,0 +1,201 @@
+//-------------------------------------------------------------------------------------
+// PathRequestQueue.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef PATHREQUESTQUEUE_H
+#define PATHREQUESTQUEUE_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+#include "Pathfinder.h"
+
+// Identifies a submitted path request.
+typedef std::uint32_t PathTicket;
+
+// A ticket that never refers to a request.
+static PathTicket const INVALID_PATH_TICKET = 0;
+
+// The default number of node expansions the queue may spend per frame.
+static int const PATH_REQUEST_EXPANSION_BUDGET = 2000;
+
+// The number of node expansions run between checks of the time budget.
+static int const PATH_REQUEST_SLICE_SIZE = 128;
+
+// The state of a path request.
+enum class PATH_REQUEST_STATUS {
+	PENDING,
+	SEARCHING,
+	FOUND,
+	NOT_FOUND,
+	INVALID
+};
+
+/**
+ * A queue of path requests that are solved a slice at a time.
+ * Callers submit a request and get a ticket back, then poll the ticket on later frames. Each frame Update() spends
+ * at most a budget of node expansions and microseconds, and a search that runs out of budget resumes where it left
+ * off on the next frame. Requests with the lowest priority value are served first, so passing the distance to the
+ * player serves the nearest enemies first. Only one search runs at a time, so the queue owns a single Pathfinder.
+ */
+class PathRequestQueue
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	PathRequestQueue();
+
+	/**
+	 * Submits a path request.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param priority The order to serve the request in. Lower values are served first.
+	 * @return The ticket to poll for the result.
+	 */
+	PathTicket Submit(GridCoord start, GridCoord goal, float priority);
+
+	/**
+	 * Cancels a request. Its ticket becomes invalid.
+	 * @param ticket The ticket of the request.
+	 */
+	void Cancel(PathTicket ticket);
+
+	/**
+	 * Gets the state of a request.
+	 * @param ticket The ticket of the request.
+	 * @return The state, or INVALID if the ticket is unknown, cancelled or already taken.
+	 */
+	PATH_REQUEST_STATUS GetStatus(PathTicket ticket) const;
+
+	/**
+	 * Takes the result of a finished request. The ticket becomes invalid.
+	 * @param ticket The ticket of the request.
+	 * @param path Receives the tiles of the path, from the tile after start up to and including goal.
+	 * @return True if the request finished and a path was found. False if it is still running, failed, or the ticket is invalid.
+	 * A request that failed is released as well.
+	 */
+	bool TakeResult(PathTicket ticket, std::vector<GridCoord>& path);
+
+	/**
+	 * Works through the requests until the frame's budget is spent.
+	 * @param grid The grid to search. Solid tiles are blocked.
+	 * @param maxExpansions The most nodes to expand this frame.
+	 * @param maxMicroseconds The most time to spend this frame, or zero for no time limit.
+	 */
+	void Update(const LevelGrid& grid, int maxExpansions = PATH_REQUEST_EXPANSION_BUDGET, double maxMicroseconds = 0.0);
+
+	/**
+	 * Restarts the search in progress, whose partial results may no longer hold. Call this when walkability changes.
+	 */
+	void OnGridChanged();
+
+	/**
+	 * Gets the number of requests waiting for, or part way through, a search.
+	 * @return The number of unfinished requests.
+	 */
+	int GetPendingCount() const;
+
+	/**
+	 * Gets the number of nodes the last Update() expanded.
+	 * @return The number of expanded nodes.
+	 */
+	int GetLastExpandedNodeCount() const;
+
+private:
+	/**
+	 * A submitted request.
+	 */
+	struct Request {
+		std::uint16_t serial;				// Changes every time the slot is reused, so old tickets stop matching.
+		PATH_REQUEST_STATUS status;			// The state of the request.
+		GridCoord start;					// The tile to start from.
+		GridCoord goal;						// The tile to reach.
+		std::vector<GridCoord> path;		// The result, once found.
+	};
+
+	/**
+	 * An entry in the queue of requests waiting for a search.
+	 */
+	struct PendingRequest {
+		float priority;						// Lower values are served first.
+		std::uint32_t order;				// Submission order, so equal priorities are served first come first served.
+		PathTicket ticket;					// The request.
+	};
+
+	/**
+	 * Orders the pending heap so the lowest priority, then the earliest submission, is on top.
+	 */
+	struct PendingRequestCompare {
+		bool operator()(const PendingRequest& lhs, const PendingRequest& rhs) const
+		{
+			return (lhs.priority > rhs.priority) || ((lhs.priority == rhs.priority) && (lhs.order > rhs.order));
+		}
+	};
+
+	/**
+	 * Gets the request a ticket refers to.
+	 * @param ticket The ticket.
+	 * @return The request, or nullptr if the ticket is invalid.
+	 */
+	Request* GetRequest(PathTicket ticket);
+
+	/**
+	 * Gets the request a ticket refers to.
+	 * @param ticket The ticket.
+	 * @return The request, or nullptr if the ticket is invalid.
+	 */
+	const Request* GetRequest(PathTicket ticket) const;
+
+	/**
+	 * Releases a request's slot so it can be reused.
+	 * @param ticket The ticket of the request.
+	 */
+	void Release(PathTicket ticket);
+
+private:
+	/**
+	 * The searches are run by this pathfinder.
+	 */
+	Pathfinder m_pathfinder;
+
+	/**
+	 * Every request slot. A ticket is (serial << 16) | (slot index + 1).
+	 */
+	std::vector<Request> m_requests;
+
+	/**
+	 * Slots that can be reused.
+	 */
+	std::vector<int> m_freeSlots;
+
+	/**
+	 * Requests waiting for a search, kept as a binary heap.
+	 */
+	std::vector<PendingRequest> m_pending;
+
+	/**
+	 * The request being searched, or INVALID_PATH_TICKET.
+	 */
+	PathTicket m_activeTicket;
+
+	/**
+	 * True if the search in progress has to be started again.
+	 */
+	bool m_restartActive;
+
+	/**
+	 * The order of the next submitted request.
+	 */
+	std::uint32_t m_nextOrder;
+
+	/**
+	 * The number of nodes the last Update() expanded.
+	 */
+	int m_lastExpandedNodeCount;
+};
+#endif
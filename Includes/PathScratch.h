@@ -0,0 +1,39 @@
+//-------------------------------------------------------------------------------------
+// PathScratch.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef PATHSCRATCH_H
+#define PATHSCRATCH_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Per-tile working data for path searches, kept apart from the level grid so the tile data stays compact.
+ * Every array is indexed by the row-major tile offset, (rowIndex * width) + columnIndex.
+ */
+struct PathScratch {
+	std::vector<int> H;						// Heuristic / movement cost to goal.
+	std::vector<int> G;						// Movement cost. (Total of entire path)
+	std::vector<int> F;						// Estimated cost for full path. (G + H)
+	std::vector<int> parentNode;			// Offset of the node used to reach this node, or -1.
+	std::vector<std::uint32_t> stamp;		// Search generation that last touched this node.
+
+	/**
+	 * Resizes every array to hold the given number of tiles.
+	 * @param tileCount The number of tiles in the grid being searched.
+	 */
+	void Resize(int tileCount)
+	{
+		H.assign(tileCount, 0);
+		G.assign(tileCount, 0);
+		F.assign(tileCount, 0);
+		parentNode.assign(tileCount, -1);
+		stamp.assign(tileCount, 0);
+	}
+};
+#endif
@@ -0,0 +1,192 @@
+//-------------------------------------------------------------------------------------
+// Pathfinder.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+#include "PathScratch.h"
+
+// The cost of a straight and a diagonal step between two tiles.
+static int const PATH_STRAIGHT_COST = 10;
+static int const PATH_DIAGONAL_COST = 14;
+
+// The state of a search.
+enum class PATH_STATUS {
+	SEARCHING,
+	FOUND,
+	NOT_FOUND
+};
+
+/**
+ * Finds tile paths with A*.
+ * Moves are 8-connected; diagonal moves may not cut the corner of a solid tile.
+ * The open list is a binary heap, and open and closed nodes are marked with a per-search stamp in the
+ * PathScratch arrays, so nothing is cleared between searches. Once the pathfinder has been sized for a
+ * grid, and the path vector has grown to fit, queries make no heap allocations.
+ * A search can also be run in slices with BeginSearch() and ContinueSearch(), so it can be spread over frames.
+ */
+class Pathfinder
+{
+public:
+	/**
+	 * Default constructor.
+	 */
+	Pathfinder();
+
+	/**
+	 * Sizes the node pool and open list for grids with up to the given number of tiles.
+	 * FindPath() does this itself when needed, but calling it up front keeps the first query allocation free.
+	 * @param tileCount The number of tiles in the grids that will be searched.
+	 */
+	void Reserve(int tileCount);
+
+	/**
+	 * Finds the shortest path between two tiles.
+	 * @param grid The grid to search. Solid tiles are blocked.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param path Receives the tiles of the path, from the tile after start up to and including goal.
+	 * The vector is cleared first, and keeps its capacity between calls.
+	 * @return True if a path was found. False if the goal is solid, outside the grid, or can't be reached.
+	 */
+	bool FindPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path);
+
+	/**
+	 * Starts an A* search that is run in slices by ContinueSearch(). Any search in progress is abandoned,
+	 * and calling FindPath() or FindJumpPointPath() abandons this one.
+	 * @param grid The grid to search. Solid tiles are blocked.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @return SEARCHING, or the result if it is known straight away.
+	 */
+	PATH_STATUS BeginSearch(const LevelGrid& grid, GridCoord start, GridCoord goal);
+
+	/**
+	 * Runs the search started by BeginSearch() for up to a number of node expansions.
+	 * The grid must not change between slices; start the search again if it does.
+	 * @param grid The grid passed to BeginSearch().
+	 * @param maxExpansions The most nodes to expand in this slice.
+	 * @param path Receives the tiles of the path once it is found, from the tile after start up to and including goal.
+	 * @return SEARCHING if the slice ran out before the search finished, otherwise the result.
+	 */
+	PATH_STATUS ContinueSearch(const LevelGrid& grid, int maxExpansions, std::vector<GridCoord>& path);
+
+	/**
+	 * Finds the shortest path between two tiles with Jump Point Search.
+	 * Paths cost the same as FindPath(), but straight and diagonal runs across open floor are skipped in one jump
+	 * rather than expanded tile by tile. Straight runs are scanned 64 tiles at a time over the grid's solidity bitmaps.
+	 * @param grid The grid to search. Solid tiles are blocked.
+	 * @param start The tile to start from.
+	 * @param goal The tile to reach.
+	 * @param path Receives the tiles of the path, from the tile after start up to and including goal.
+	 * The vector is cleared first, and keeps its capacity between calls.
+	 * @return True if a path was found. False if the goal is solid, outside the grid, or can't be reached.
+	 */
+	bool FindJumpPointPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path);
+
+	/**
+	 * Gets the number of nodes the last search expanded. For a sliced search, this counts every slice so far.
+	 * @return The number of expanded nodes.
+	 */
+	int GetExpandedNodeCount() const;
+
+	/**
+	 * Gets the estimated cost between two tiles, using the octile distance.
+	 * @param from The first tile.
+	 * @param to The second tile.
+	 * @return The estimated cost.
+	 */
+	static int GetHeuristic(GridCoord from, GridCoord to);
+
+private:
+	/**
+	 * An entry in the open list.
+	 */
+	struct OpenNode {
+		int F;								// Estimated cost for the full path when the node was pushed.
+		int H;								// Heuristic, used to break ties towards the goal.
+		int node;							// The offset of the node.
+	};
+
+	/**
+	 * Orders the open list heap so the lowest F, then the lowest H, is on top.
+	 */
+	struct OpenNodeCompare {
+		bool operator()(const OpenNode& lhs, const OpenNode& rhs) const
+		{
+			return (lhs.F > rhs.F) || ((lhs.F == rhs.F) && (lhs.H > rhs.H));
+		}
+	};
+
+	/**
+	 * Jumps from a tile in one direction until a jump point is found or the way is blocked.
+	 * @param grid The grid being searched.
+	 * @param from The tile to jump from.
+	 * @param columnStep The column direction of the jump: -1, 0 or 1.
+	 * @param rowStep The row direction of the jump: -1, 0 or 1.
+	 * @param goal The goal of the search. It is always a jump point.
+	 * @param jumpPoint Receives the jump point.
+	 * @return True if a jump point was found.
+	 */
+	static bool Jump(const LevelGrid& grid, GridCoord from, int columnStep, int rowStep, GridCoord goal, GridCoord& jumpPoint);
+
+	/**
+	 * Scans a straight line of a solidity bitmap for the next jump point, 64 tiles at a time.
+	 * A tile is a jump point if it is the goal, or if a tile beside it is open while the tile behind that one is solid.
+	 * @param line The bitmap of the line being scanned.
+	 * @param before The bitmap of the line on one side, or nullptr if it is outside the grid.
+	 * @param after The bitmap of the line on the other side, or nullptr if it is outside the grid.
+	 * @param wordCount The number of words in each line.
+	 * @param from The position to scan from. It is not tested itself.
+	 * @param step The direction to scan: 1 or -1.
+	 * @param goal The position of the goal on this line, or -1.
+	 * @return The position of the jump point, or -1 if the line is blocked first.
+	 */
+	static int ScanLine(const std::uint64_t* line, const std::uint64_t* before, const std::uint64_t* after, int wordCount, int from, int step, int goal);
+
+	/**
+	 * Starts a new search generation, resetting the stamps when the counter would wrap.
+	 */
+	void NextGeneration();
+
+private:
+	/**
+	 * The per-tile search data.
+	 */
+	PathScratch m_scratch;
+
+	/**
+	 * The open list, kept as a binary heap. Nodes are pushed again rather than re-sorted when a cheaper route is found.
+	 */
+	std::vector<OpenNode> m_open;
+
+	/**
+	 * The stamp of open nodes in the current search. Closed nodes are stamped with m_generation + 1.
+	 */
+	std::uint32_t m_generation;
+
+	/**
+	 * The number of nodes the last search expanded.
+	 */
+	int m_expandedNodeCount;
+
+	/**
+	 * The state of the current search.
+	 */
+	PATH_STATUS m_status;
+
+	/**
+	 * The start and goal of the current search.
+	 */
+	GridCoord m_start;
+	GridCoord m_goal;
+};
+#endif
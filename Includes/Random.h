@@ -0,0 +1,138 @@
+//-------------------------------------------------------------------------------------
+// Random.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The top level random streams. Each system derives its numbers from its own stream so they can't disturb each other.
+enum class RANDOM_STREAM {
+	CHUNK,
+	ROOM,
+	LEVEL,
+	ENEMY,
+	TORCH,
+	LOOT,
+	COUNT
+};
+
+/**
+ * A seedable, splittable, counter-based random number generator.
+ * Value number n of a stream is Mix(key + n * GAMMA), where the key is derived from (seed, stream id).
+ * No value depends on the one before it, so streams can be split per room, chunk or entity and used on any
+ * thread in any order while still producing bit-identical results, and whole buffers can be filled at once.
+ */
+class Random
+{
+public:
+	/**
+	 * Default constructor. Creates stream 0 of seed 0.
+	 */
+	Random();
+
+	/**
+	 * Constructor.
+	 * @param seed The seed.
+	 * @param streamId The id of the stream to derive from the seed.
+	 */
+	Random(std::uint64_t seed, std::uint64_t streamId);
+
+	/**
+	 * Constructor.
+	 * @param seed The seed.
+	 * @param stream The top level stream to derive from the seed.
+	 */
+	Random(std::uint64_t seed, RANDOM_STREAM stream);
+
+	/**
+	 * Derives an independent child stream. The result only depends on this stream's key and the id,
+	 * not on how many values have been drawn.
+	 * @param id The id of the child stream, e.g. a room, chunk or entity index.
+	 * @return The child stream.
+	 */
+	Random Split(std::uint64_t id) const;
+
+	/**
+	 * Gets the next 64 random bits of the stream.
+	 * @return The random value.
+	 */
+	std::uint64_t Next();
+
+	/**
+	 * Gets a value of the stream by its position, without advancing the stream.
+	 * @param counter The position of the value.
+	 * @return The random value.
+	 */
+	std::uint64_t Peek(std::uint64_t counter) const;
+
+	/**
+	 * Gets a random integer in an inclusive range.
+	 * @param min The lowest value to return.
+	 * @param max The highest value to return.
+	 * @return The random integer, or min if max is less than min.
+	 */
+	int Range(int min, int max);
+
+	/**
+	 * Gets a random float in the range [0, 1).
+	 * @return The random float.
+	 */
+	float NextFloat();
+
+	/**
+	 * Fills a buffer with the next values of the stream.
+	 * Each value is computed from its counter alone, so the loop has no dependency between iterations and vectorises.
+	 * @param buffer The buffer to fill.
+	 * @param count The number of values to write.
+	 */
+	void FillBuffer(std::uint64_t* buffer, std::size_t count);
+
+	/**
+	 * Gets the number of values drawn from the stream so far.
+	 * @return The counter of the next value.
+	 */
+	std::uint64_t GetCounter() const;
+
+	/**
+	 * Scrambles the bits of a 64 bit value. (SplitMix64 finalizer)
+	 * @param value The value to scramble.
+	 * @return The scrambled value.
+	 */
+	static std::uint64_t Mix(std::uint64_t value);
+
+private:
+	/**
+	 * The key of the stream, derived from its seed and id.
+	 */
+	std::uint64_t m_key;
+
+	/**
+	 * The position of the next value in the stream.
+	 */
+	std::uint64_t m_counter;
+};
+
+// The golden ratio increment used to spread counters and ids over the 64 bit range.
+static std::uint64_t const RANDOM_GAMMA = 0x9E3779B97F4A7C15ull;
+
+// Scrambles the bits of a 64 bit value. Defined here so the hot loops inline it.
+inline std::uint64_t Random::Mix(std::uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+// Gets the next 64 random bits of the stream.
+inline std::uint64_t Random::Next()
+{
+	return Mix(m_key + (m_counter++ * RANDOM_GAMMA));
+}
+#endif
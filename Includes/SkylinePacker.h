@@ -0,0 +1,114 @@
+//-------------------------------------------------------------------------------------
+// SkylinePacker.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef SKYLINEPACKER_H
+#define SKYLINEPACKER_H
+
+#include <cstdint>
+#include <vector>
+#include "LevelGrid.h"
+
+/**
+ * Packs rectangles into a fixed size page, for building texture atlases.
+ * The packer only remembers the skyline, the top edge of everything placed so far, as a list of horizontal
+ * segments. Each rectangle goes where its top edge ends up lowest, which keeps the skyline flat and the gaps
+ * under it small. Rectangles can be added at any time, but space is only given back by a reset.
+ */
+class SkylinePacker
+{
+public:
+	/**
+	 * Constructor.
+	 * @param width The width of the page.
+	 * @param height The height of the page.
+	 */
+	SkylinePacker(int width, int height);
+
+	/**
+	 * Empties the page.
+	 */
+	void Reset();
+
+	/**
+	 * Places a rectangle on the page.
+	 * @param width The width of the rectangle.
+	 * @param height The height of the rectangle.
+	 * @param position Receives the top-left corner of the rectangle. Only written if it fit.
+	 * @return False if the rectangle doesn't fit anywhere on the page.
+	 */
+	bool Insert(int width, int height, GridCoord& position);
+
+	/**
+	 * Gets the width of the page.
+	 * @return The width of the page.
+	 */
+	int GetWidth() const;
+
+	/**
+	 * Gets the height of the page.
+	 * @return The height of the page.
+	 */
+	int GetHeight() const;
+
+	/**
+	 * Gets how much of the page the placed rectangles cover.
+	 * @return The covered area divided by the page area, between 0 and 1.
+	 */
+	double GetOccupancy() const;
+
+private:
+	/**
+	 * A horizontal piece of the skyline.
+	 */
+	struct Segment {
+		int x;								// The leftmost column of the segment.
+		int y;								// The row everything above the segment is free from.
+		int width;							// The number of columns in the segment.
+	};
+
+	/**
+	 * Finds the row a rectangle would sit on if its left edge was at a segment.
+	 * @param index The index of the segment.
+	 * @param width The width of the rectangle.
+	 * @param height The height of the rectangle.
+	 * @param y Receives the row.
+	 * @return False if the rectangle would stick out of the page.
+	 */
+	bool Fit(int index, int width, int height, int& y) const;
+
+	/**
+	 * Raises the skyline under a placed rectangle.
+	 * @param index The index of the segment the rectangle's left edge is at.
+	 * @param y The top row of the rectangle.
+	 * @param width The width of the rectangle.
+	 * @param height The height of the rectangle.
+	 */
+	void AddSkylineLevel(int index, int y, int width, int height);
+
+private:
+	/**
+	 * The width of the page.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the page.
+	 */
+	int m_height;
+
+	/**
+	 * The skyline, left to right. The segments cover the page's width without gaps.
+	 */
+	std::vector<Segment> m_skyline;
+
+	/**
+	 * The area covered by placed rectangles.
+	 */
+	std::uint64_t m_usedArea;
+};
+#endif
@@ -1,25 +0,0 @@
-//-------------------------------------------------------------------------------------
-// Slime.h
-//
-// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
-// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
-// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
-// PARTICULAR PURPOSE.
-//
-// Written by Dale Green. Copyright (c) Packt Publishing. All rights reserved.
-//-------------------------------------------------------------------------------------
-#ifndef SLIME_H
-#define SLIME_H
-
-#include "Enemy.h"
-
-class Slime : public Enemy
-{
-public:
-
-	/**
-	 * Default constructor.
-	 */
-	Slime();
-};
-#endif
\ No newline at end of file
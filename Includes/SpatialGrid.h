@@ -0,0 +1,121 @@
+//-------------------------------------------------------------------------------------
+// SpatialGrid.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <vector>
+
+/**
+ * Buckets objects by position into square cells, so the objects inside a rectangle can be found without looking
+ * at the rest. Objects are ids chosen by the caller, indexed by a single point each; pad queries by the largest
+ * object's half size to catch objects that stick into the rectangle.
+ * The grid is meant to be cleared and refilled once per frame, which is cheaper than tracking every move. The
+ * cells keep their memory, so refilling doesn't allocate once it has warmed up. Positions outside the area go
+ * into the border cells, so nothing is ever lost, it just gets found by more queries.
+ */
+class SpatialGrid
+{
+public:
+	/**
+	 * Constructor.
+	 * @param cellSize The side of a cell.
+	 */
+	explicit SpatialGrid(float cellSize);
+
+	/**
+	 * Sets the area the cells cover, and removes every object.
+	 * @param left The left edge of the area.
+	 * @param top The top edge of the area.
+	 * @param width The width of the area.
+	 * @param height The height of the area.
+	 */
+	void Reset(float left, float top, float width, float height);
+
+	/**
+	 * Removes every object, keeping the area.
+	 */
+	void Clear();
+
+	/**
+	 * Adds an object.
+	 * @param id The id of the object.
+	 * @param x The horizontal position of the object.
+	 * @param y The vertical position of the object.
+	 */
+	void Insert(int id, float x, float y);
+
+	/**
+	 * Finds the objects in the cells a rectangle touches.
+	 * The result may hold objects just outside the rectangle, but never misses one inside it.
+	 * @param left The left edge of the rectangle.
+	 * @param top The top edge of the rectangle.
+	 * @param right The right edge of the rectangle.
+	 * @param bottom The bottom edge of the rectangle.
+	 * @param ids Receives the ids, sorted ascending. The vector is cleared first.
+	 */
+	void Query(float left, float top, float right, float bottom, std::vector<int>& ids) const;
+
+	/**
+	 * Gets the number of objects in the grid.
+	 * @return The number of objects.
+	 */
+	int GetCount() const;
+
+private:
+	/**
+	 * Gets the column of the cell a horizontal position is in, clamped to the area.
+	 * @param x The horizontal position.
+	 * @return The column.
+	 */
+	int GetColumn(float x) const;
+
+	/**
+	 * Gets the row of the cell a vertical position is in, clamped to the area.
+	 * @param y The vertical position.
+	 * @return The row.
+	 */
+	int GetRow(float y) const;
+
+private:
+	/**
+	 * The side of a cell.
+	 */
+	float m_cellSize;
+
+	/**
+	 * The left edge of the area.
+	 */
+	float m_left;
+
+	/**
+	 * The top edge of the area.
+	 */
+	float m_top;
+
+	/**
+	 * The number of cell columns.
+	 */
+	int m_columns;
+
+	/**
+	 * The number of cell rows.
+	 */
+	int m_rows;
+
+	/**
+	 * The ids in every cell, row by row.
+	 */
+	std::vector<std::vector<int>> m_cells;
+
+	/**
+	 * The number of objects in the grid.
+	 */
+	int m_count;
+};
+#endif
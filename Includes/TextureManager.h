@@ -11,6 +11,24 @@
 #ifndef TEXTUREMANAGER_H
 #define TEXTUREMANAGER_H
 
+#include "SkylinePacker.h"
+
+// The largest atlas page size. Clamped to what the graphics card supports.
+static int const ATLAS_PAGE_SIZE = 2048;
+
+// The empty pixels kept around every image on an atlas page, so neighbours don't bleed into each other.
+static int const ATLAS_PADDING = 1;
+
+/**
+ * Where a registered image lives: the texture to bind and the part of it that holds the image.
+ * Images packed into an atlas share their page's texture, so sprites and tiles using them batch together.
+ */
+struct TextureRegion {
+	const sf::Texture* texture;				// The texture to draw with. An atlas page, or the image's own texture.
+	sf::IntRect rect;						// The image's rectangle on the texture.
+	int page;								// The index of the atlas page, or -1 if the image wasn't packed.
+};
+
 class TextureManager
 {
 public:
@@ -39,6 +57,43 @@ public:
 	*/
 	static sf::Texture& GetTexture(int textureId);
 
+	/**
+	 * Gets where an image lives on the atlas.
+	 * Images too large for a page aren't packed, and get their own texture's full rectangle instead.
+	 * @param textureId The id of the texture.
+	 * @return The texture and rectangle to draw the image with.
+	 */
+	static const TextureRegion& GetRegion(int textureId);
+
+	/**
+	 * Points a sprite at an image's region, so it draws from the atlas.
+	 * @param sprite The sprite to set.
+	 * @param textureId The id of the texture.
+	 */
+	static void SetSpriteRegion(sf::Sprite& sprite, int textureId);
+
+	/**
+	 * Gets the number of atlas pages created so far.
+	 * @return The number of atlas pages.
+	 */
+	static int GetAtlasPageCount();
+
+	/**
+	 * Gets an atlas page.
+	 * @param page The index of the page.
+	 * @return The page's texture.
+	 */
+	static const sf::Texture& GetAtlasPage(int page);
+
+private:
+	/**
+	 * Copies an image onto an atlas page, starting a new page if it doesn't fit on the last one.
+	 * @param textureId The id of the texture the image was loaded into.
+	 * @param image The image.
+	 * @return The region the image was given.
+	 */
+	static TextureRegion PackImage(int textureId, const sf::Image& image);
+
 private:
 	/**
 	 * A map of each texture name with its ID.
@@ -49,5 +104,20 @@ private:
 	 * The current key value.
 	 */
 	static int m_currentId;
+
+	/**
+	 * The region of every texture, by id.
+	 */
+	static std::map<int, TextureRegion> m_regions;
+
+	/**
+	 * The atlas pages. Pages are only added, so regions stay valid.
+	 */
+	static std::vector<std::unique_ptr<sf::Texture>> m_atlasPages;
+
+	/**
+	 * The packer of every atlas page, kept so later images can fill the gaps on earlier pages.
+	 */
+	static std::vector<SkylinePacker> m_atlasPackers;
 };
 #endif
\ No newline at end of file
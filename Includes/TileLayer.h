@@ -0,0 +1,175 @@
+//-------------------------------------------------------------------------------------
+// TileLayer.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//-------------------------------------------------------------------------------------
+#ifndef TILELAYER_H
+#define TILELAYER_H
+
+#include "LevelGrid.h"
+#include "ChangeJournal.h"
+
+// The side of a tile layer chunk in tiles. Chunks outside the view aren't drawn.
+static int const TILE_LAYER_CHUNK_SIZE = 16;
+
+/**
+ * The tiles of a level grid, drawn as textured quads from one vertex array per texture page in every chunk.
+ * The grid is split into chunks of TILE_LAYER_CHUNK_SIZE tiles square, and only the chunks the target's view
+ * overlaps are drawn, so drawing costs one draw call per page per visible chunk, however large the grid is.
+ * Each tile's quad lives in its chunk's page for the texture its type is drawn with; when a tile changes type its
+ * quad is moved to the end of the new page, and the last quad of the old page fills the gap it leaves. Only the
+ * tiles inside the change journal's dirty regions are looked at, so an update costs nothing when the grid hasn't
+ * changed.
+ * Quads are placed relative to the grid's top left corner; draw the layer with a transform to position it.
+ */
+class TileLayer : public sf::Drawable
+{
+public:
+	/**
+	 * Constructor.
+	 * @param tileSize The distance between neighbouring tiles in pixels.
+	 */
+	explicit TileLayer(int tileSize);
+
+	/**
+	 * Sets the part of a texture a tile type is drawn with. Tiles of types without a texture aren't drawn.
+	 * Types that share a texture share a page. Call Build() afterwards.
+	 * @param tileType The tile type.
+	 * @param texture The texture. Must outlive the layer.
+	 * @param textureRect The part of the texture to draw. The quad has the same size.
+	 */
+	void SetTileTexture(TILE tileType, const sf::Texture& texture, const sf::IntRect& textureRect);
+
+	/**
+	 * Rebuilds the quads of every tile.
+	 * @param grid The grid to draw.
+	 */
+	void Build(const LevelGrid& grid);
+
+	/**
+	 * Brings the quads up to date with the changes recorded since the last update.
+	 * The whole layer is rebuilt if the journal can't say what changed, e.g. after a new level was loaded.
+	 * @param grid The grid to draw.
+	 * @param journal The journal the grid's changes are recorded in.
+	 */
+	void Update(const LevelGrid& grid, const ChangeJournal& journal);
+
+	/**
+	 * Gets the number of draw calls the layer takes when all of it is in view.
+	 * @return The number of pages with quads in them.
+	 */
+	int GetDrawCallCount() const;
+
+private:
+	/**
+	 * The quads drawn with one texture.
+	 */
+	struct Page {
+		const sf::Texture* texture;			// The texture of the page.
+		sf::VertexArray vertices;			// Two triangles per quad.
+		std::vector<int> tiles;				// The tile each quad belongs to.
+	};
+
+	/**
+	 * Draws the pages of the chunks the target's view overlaps.
+	 * @param target The target to draw to.
+	 * @param states The states to draw with. The texture is replaced by each page's.
+	 */
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	/**
+	 * Adds the quad of a tile to the page of its type.
+	 * @param tile The index of the tile.
+	 * @param tileType The type of the tile.
+	 */
+	void AddQuad(int tile, std::uint8_t tileType);
+
+	/**
+	 * Removes the quad of a tile from its page, moving the page's last quad into its place.
+	 * @param tile The index of the tile.
+	 */
+	void RemoveQuad(int tile);
+
+	/**
+	 * Gets the page a tile's quad goes in.
+	 * @param tile The index of the tile.
+	 * @param texture The index of the texture the tile is drawn with.
+	 * @return The index of the page.
+	 */
+	int GetPageIndex(int tile, int texture) const;
+
+private:
+	/**
+	 * The distance between neighbouring tiles in pixels.
+	 */
+	int m_tileSize;
+
+	/**
+	 * The width of the grid the layer was built for.
+	 */
+	int m_width;
+
+	/**
+	 * The height of the grid the layer was built for.
+	 */
+	int m_height;
+
+	/**
+	 * The number of chunk columns.
+	 */
+	int m_chunkColumns;
+
+	/**
+	 * The number of chunk rows.
+	 */
+	int m_chunkRows;
+
+	/**
+	 * The journal version the layer last caught up with.
+	 */
+	std::uint32_t m_version;
+
+	/**
+	 * True if the layer has never been built since its textures changed.
+	 */
+	bool m_isDirty;
+
+	/**
+	 * The texture of every tile type, or -1 if the type isn't drawn.
+	 */
+	int m_typeTextures[static_cast<int>(TILE::COUNT)];
+
+	/**
+	 * The part of the texture every tile type is drawn with.
+	 */
+	sf::IntRect m_typeRects[static_cast<int>(TILE::COUNT)];
+
+	/**
+	 * The textures tiles are drawn with.
+	 */
+	std::vector<const sf::Texture*> m_textures;
+
+	/**
+	 * The pages, chunk by chunk, with one page per texture in every chunk.
+	 */
+	std::vector<Page> m_pages;
+
+	/**
+	 * The type every tile's quad was built for.
+	 */
+	std::vector<std::uint8_t> m_tileTypes;
+
+	/**
+	 * The index of every tile's quad in its page, or -1 if the tile isn't drawn.
+	 */
+	std::vector<int> m_tileQuads;
+
+	/**
+	 * The changes read from the journal. Kept so updates don't allocate.
+	 */
+	std::vector<DirtyRegion> m_changes;
+};
+#endif
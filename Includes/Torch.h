@@ -11,16 +11,18 @@
 #ifndef TORCH_H
 #define TORCH_H
 
-#include "Item.h"
+#include "Object.h"
+#include "Random.h"
 
 class Torch : public Object
 {
 public:
 
 	/**
-	 * Default Constructor.
+	 * Constructor.
+	 * @param random The torch's own random stream, used for its flicker.
 	 */
-	Torch();
+	Torch(Random random);
 
 	/**
 	 * Updates the brightness of the torch.
@@ -40,5 +42,10 @@ private:
 	 * The brightness modifier of the torch. This is used to denote flicker.
 	 */
 	float m_brightness;
+
+	/**
+	 * The random stream the flicker is drawn from.
+	 */
+	Random m_random;
 };
 #endif
\ No newline at end of file
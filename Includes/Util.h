@@ -11,6 +11,12 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 // Game states.
 enum class GAME_STATE {
 	MAIN_MENU,
@@ -75,6 +81,30 @@ enum class TILE {
 	COUNT				=22
 };
 
+// Returns the index of the lowest set bit of a non-zero value.
+inline int CountTrailingZeros(std::uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+// Returns the number of zero bits above the highest set bit of a non-zero value.
+inline int CountLeadingZeros(std::uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - static_cast<int>(index);
+#else
+	return __builtin_clzll(value);
+#endif
+}
+
 // Game views.
 enum class VIEW {
 	MAIN,
@@ -0,0 +1,127 @@
+#include <thread>
+#include <vector>
+#include "BatchRunner.h"
+
+// Constructor.
+BatchRunner::BatchRunner(int threadCount) :
+m_threadCount(threadCount),
+m_stealCount(0)
+{
+	if (m_threadCount <= 0)
+	{
+		m_threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		m_threadCount = (m_threadCount > 0) ? m_threadCount : 1;
+	}
+
+	m_slices.reset(new Slice[m_threadCount]);
+}
+
+// Runs a task for every index and waits for all of them to finish.
+void BatchRunner::Run(std::uint64_t taskCount, const Task& task)
+{
+	m_stealCount = 0;
+
+	// Deal the range out in equal contiguous slices. Stealing evens out whatever imbalance is left.
+	for (int w = 0; w < m_threadCount; ++w)
+	{
+		m_slices[w].begin = (taskCount * w) / m_threadCount;
+		m_slices[w].end = (taskCount * (w + 1)) / m_threadCount;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(m_threadCount - 1);
+
+	for (int w = 1; w < m_threadCount; ++w)
+	{
+		threads.emplace_back(&BatchRunner::Work, this, w, std::cref(task));
+	}
+
+	// The calling thread is worker 0.
+	Work(0, task);
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// Gets the number of worker threads.
+int BatchRunner::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+// Gets the number of successful steals during the last run.
+std::uint64_t BatchRunner::GetStealCount() const
+{
+	return m_stealCount;
+}
+
+// Runs tasks until no work is left.
+void BatchRunner::Work(int workerIndex, const Task& task)
+{
+	Slice& slice = m_slices[workerIndex];
+
+	for (;;)
+	{
+		std::uint64_t taskIndex = 0;
+		bool hasTask = false;
+
+		{
+			std::lock_guard<std::mutex> guard(slice.lock);
+
+			if (slice.begin < slice.end)
+			{
+				taskIndex = slice.begin++;
+				hasTask = true;
+			}
+		}
+
+		if (hasTask)
+		{
+			task(workerIndex, taskIndex);
+		}
+		else if (!Steal(workerIndex))
+		{
+			// Work is never added during a run, so once every slice is empty the batch is done.
+			return;
+		}
+	}
+}
+
+// Moves the back half of another worker's slice into the given worker's slice.
+bool BatchRunner::Steal(int workerIndex)
+{
+	// Start with the next worker along, so thieves spread over different victims.
+	for (int offset = 1; offset < m_threadCount; ++offset)
+	{
+		Slice& victim = m_slices[(workerIndex + offset) % m_threadCount];
+		std::uint64_t begin = 0;
+		std::uint64_t end = 0;
+
+		{
+			std::lock_guard<std::mutex> guard(victim.lock);
+
+			if (victim.begin < victim.end)
+			{
+				end = victim.end;
+				begin = victim.begin + ((victim.end - victim.begin) / 2);
+				victim.end = begin;
+			}
+		}
+
+		if (begin < end)
+		{
+			Slice& slice = m_slices[workerIndex];
+			std::lock_guard<std::mutex> guard(slice.lock);
+
+			slice.begin = begin;
+			slice.end = end;
+			++m_stealCount;
+
+			return true;
+		}
+	}
+
+	return false;
+}
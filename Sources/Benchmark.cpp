@@ -0,0 +1,863 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "EntityStore.h"
+#include "FieldOfView.h"
+#include "FloorLayout.h"
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+#include "LevelConnectivity.h"
+#include "LevelGenerator.h"
+#include "LevelGrid.h"
+#include "LightField.h"
+#include "NextHopTable.h"
+#include "PathCache.h"
+#include "PathRequestQueue.h"
+#include "Pathfinder.h"
+#include "Random.h"
+
+namespace
+{
+	// Counts every heap allocation made by the process, so the benchmark can check queries don't allocate.
+	std::atomic<std::uint64_t> g_allocationCount(0);
+
+	// A grid to benchmark, with the queries to run on it.
+	struct Scenario {
+		std::string name;					// What the grid is.
+		LevelGrid grid;						// The grid to search.
+		std::vector<GridCoord> starts;		// The start tile of every query.
+		std::vector<GridCoord> goals;		// The goal tile of every query.
+	};
+
+	// Fills a grid with an open hall: floor inside a wall border, with scattered pillars and short wall segments, an
+	// entrance and a door.
+	void MakeHall(LevelGrid& grid, int size, std::uint64_t seed)
+	{
+		Random random(seed, RANDOM_STREAM::LEVEL);
+		grid.Resize(size, size);
+
+		for (int j = 0; j < size; ++j)
+		{
+			for (int i = 0; i < size; ++i)
+			{
+				bool isBorder = (i == 0) || (j == 0) || (i == size - 1) || (j == size - 1);
+				grid.SetTileType(i, j, isBorder ? TILE::WALL_SINGLE : TILE::FLOOR);
+			}
+		}
+
+		for (int w = 0; w < (size * size) / 200; ++w)
+		{
+			int column = random.Range(1, size - 2);
+			int row = random.Range(1, size - 2);
+			int length = random.Range(1, 8);
+			bool isHorizontal = (random.Range(0, 1) == 0);
+
+			for (int t = 0; (t < length) && (column < size - 1) && (row < size - 1); ++t)
+			{
+				grid.SetTileType(column, row, TILE::WALL_SINGLE);
+				column += isHorizontal ? 1 : 0;
+				row += isHorizontal ? 0 : 1;
+			}
+		}
+
+		// An entrance in the top wall and a door in the bottom one, each with floor inside, so it validates like a level.
+		grid.SetTileType(size / 2, 0, TILE::WALL_ENTRANCE);
+		grid.SetTileType(size / 2, 1, TILE::FLOOR);
+		grid.SetTileType(size / 2, size - 1, TILE::WALL_DOOR_LOCKED);
+		grid.SetTileType(size / 2, size - 2, TILE::FLOOR);
+		grid.SetDoorIndices({ size / 2, size - 1 });
+
+		grid.Autotile();
+	}
+
+	// Picks random pairs of floor tiles as queries.
+	void AddQueries(Scenario& scenario, int queryCount, std::uint64_t seed)
+	{
+		std::vector<GridCoord> floorTiles;
+
+		for (int j = 0; j < scenario.grid.GetHeight(); ++j)
+		{
+			for (int i = 0; i < scenario.grid.GetWidth(); ++i)
+			{
+				if (!scenario.grid.IsSolid(i, j))
+				{
+					floorTiles.push_back({ i, j });
+				}
+			}
+		}
+
+		Random random(seed, RANDOM_STREAM::LEVEL);
+
+		for (int q = 0; (q < queryCount) && (!floorTiles.empty()); ++q)
+		{
+			scenario.starts.push_back(floorTiles[random.Range(0, static_cast<int>(floorTiles.size()) - 1)]);
+			scenario.goals.push_back(floorTiles[random.Range(0, static_cast<int>(floorTiles.size()) - 1)]);
+		}
+	}
+
+	// Runs every query of a scenario with A*, or with Jump Point Search, and prints the results.
+	void RunAStar(const Scenario& scenario, bool useJumpPoints)
+	{
+		Pathfinder pathfinder;
+		std::vector<GridCoord> path;
+
+		// Size the pool and the path vector before anything is measured.
+		pathfinder.Reserve(scenario.grid.GetWidth() * scenario.grid.GetHeight());
+		path.reserve(static_cast<size_t>(scenario.grid.GetWidth()) * scenario.grid.GetHeight());
+
+		pathfinder.FindPath(scenario.grid, scenario.starts[0], scenario.goals[0], path);
+
+		std::uint64_t allocationsBefore = g_allocationCount;
+		std::uint64_t expandedNodes = 0;
+		std::uint64_t pathTiles = 0;
+		int foundCount = 0;
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t q = 0; q < scenario.starts.size(); ++q)
+		{
+			bool found = useJumpPoints ?
+				pathfinder.FindJumpPointPath(scenario.grid, scenario.starts[q], scenario.goals[q], path) :
+				pathfinder.FindPath(scenario.grid, scenario.starts[q], scenario.goals[q], path);
+
+			if (found)
+			{
+				++foundCount;
+				pathTiles += path.size();
+			}
+
+			expandedNodes += pathfinder.GetExpandedNodeCount();
+		}
+
+		auto end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		double queryCount = static_cast<double>(scenario.starts.size());
+
+		std::printf("%-22s %-8s %10.0f q/s %9.2f us/q %9.1f nodes/q %7.1f tiles/path %5d/%-5d found %6.2f allocs/q\n",
+			scenario.name.c_str(), useJumpPoints ? "JPS" : "A*", queryCount / seconds, (seconds * 1e6) / queryCount, expandedNodes / queryCount,
+			(foundCount > 0) ? (static_cast<double>(pathTiles) / foundCount) : 0.0, foundCount, static_cast<int>(queryCount),
+			(g_allocationCount - allocationsBefore) / queryCount);
+	}
+
+	// Builds the hierarchical graph, then runs every query with HPA*: as waypoints only, refined up to the first
+	// waypoint as Level does, and fully refined.
+	void RunHierarchical(const Scenario& scenario)
+	{
+		HierarchicalPathfinder pathfinder;
+		std::vector<GridCoord> path;
+
+		auto buildStart = std::chrono::steady_clock::now();
+		pathfinder.Build(scenario.grid);
+		auto buildEnd = std::chrono::steady_clock::now();
+
+		// Size the working lists before anything is measured.
+		path.reserve(static_cast<size_t>(scenario.grid.GetWidth()) * scenario.grid.GetHeight());
+		pathfinder.FindPath(scenario.grid, scenario.starts[0], scenario.goals[0], path);
+
+		std::uint64_t expandedNodes = 0;
+		int foundCount = 0;
+		auto abstractStart = std::chrono::steady_clock::now();
+
+		for (size_t q = 0; q < scenario.starts.size(); ++q)
+		{
+			foundCount += pathfinder.FindAbstractPath(scenario.grid, scenario.starts[q], scenario.goals[q], path) ? 1 : 0;
+			expandedNodes += pathfinder.GetExpandedNodeCount();
+		}
+
+		auto abstractEnd = std::chrono::steady_clock::now();
+
+		for (size_t q = 0; q < scenario.starts.size(); ++q)
+		{
+			pathfinder.FindFirstSegment(scenario.grid, scenario.starts[q], scenario.goals[q], path);
+		}
+
+		auto firstSegmentEnd = std::chrono::steady_clock::now();
+		std::uint64_t pathTiles = 0;
+
+		for (size_t q = 0; q < scenario.starts.size(); ++q)
+		{
+			if (pathfinder.FindPath(scenario.grid, scenario.starts[q], scenario.goals[q], path))
+			{
+				pathTiles += path.size();
+			}
+		}
+
+		auto refineEnd = std::chrono::steady_clock::now();
+
+		double buildSeconds = std::chrono::duration<double>(buildEnd - buildStart).count();
+		double abstractSeconds = std::chrono::duration<double>(abstractEnd - abstractStart).count();
+		double firstSegmentSeconds = std::chrono::duration<double>(firstSegmentEnd - abstractEnd).count();
+		double refineSeconds = std::chrono::duration<double>(refineEnd - firstSegmentEnd).count();
+		double queryCount = static_cast<double>(scenario.starts.size());
+
+		std::printf("%-22s %-8s %10.1f ms/build %9.2f us/q %9.1f nodes/q %7.1f tiles/path %5d/%-5d found %9.2f us/first segment %9.2f us/refined q %d entrances\n",
+			scenario.name.c_str(), "HPA*", buildSeconds * 1e3, (abstractSeconds * 1e6) / queryCount, expandedNodes / queryCount,
+			(foundCount > 0) ? (static_cast<double>(pathTiles) / foundCount) : 0.0, foundCount, static_cast<int>(queryCount),
+			(firstSegmentSeconds * 1e6) / queryCount, (refineSeconds * 1e6) / queryCount, pathfinder.GetNodeCount());
+	}
+
+	// Labels the passable areas of a scenario's grid and checks its entrance can reach its door.
+	void RunConnectivity(const Scenario& scenario)
+	{
+		LevelConnectivity connectivity;
+		ConnectivityReport report = connectivity.Validate(scenario.grid);
+
+		// Small grids are validated many times, so the timer has something to measure.
+		int repeatCount = std::max(1, (1 << 22) / (scenario.grid.GetWidth() * scenario.grid.GetHeight()));
+		std::uint64_t allocationsBefore = g_allocationCount;
+		auto start = std::chrono::steady_clock::now();
+
+		for (int r = 0; r < repeatCount; ++r)
+		{
+			report = connectivity.Validate(scenario.grid);
+		}
+
+		auto end = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(end - start).count();
+
+		std::printf("%-22s %-8s %10.2f us/check %9d areas %9d pockets %7d pocket tiles %5s %6.2f allocs/check\n",
+			scenario.name.c_str(), "connect", (seconds * 1e6) / repeatCount, report.componentCount, report.pocketCount,
+			report.pocketTileCount, report.isValid ? "valid" : "bad", static_cast<double>(g_allocationCount - allocationsBefore) / repeatCount);
+	}
+
+	// Generates floors, then walks through every room of each one as the game does on a room transition.
+	void RunFloorLayout()
+	{
+		static int const floorCount = 20;
+		static double const frameMicroseconds = 1000.0;
+
+		FloorLayoutGenerator generator;
+		LevelGrid grid;
+		NextHopTable table;
+		int roomCount = 0;
+		int rebuildFrameCount = 0;
+		double generateSeconds = 0.0;
+		double enterSeconds = 0.0;
+		double worstEnterSeconds = 0.0;
+
+		for (int floorNumber = 1; floorNumber <= floorCount; ++floorNumber)
+		{
+			auto generateStart = std::chrono::steady_clock::now();
+			generator.GetFloor(1, floorNumber);
+			generateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - generateStart).count();
+
+			// Entering a room fetches the kept floor, copies the room's tiles and spends the first frame's slice on the room's
+			// path table. The rest of the table is rebuilt a slice per frame, as Level::UpdateNextHopTable() does.
+			for (int room = 0; room < static_cast<int>(generator.GetFloor(1, floorNumber).rooms.size()); ++room)
+			{
+				auto enterStart = std::chrono::steady_clock::now();
+				grid = generator.GetFloor(1, floorNumber).rooms[room].grid;
+				table.Invalidate();
+				bool isReady = table.UpdateSliced(grid, frameMicroseconds);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - enterStart).count();
+
+				++rebuildFrameCount;
+				while (!isReady)
+				{
+					isReady = table.UpdateSliced(grid, frameMicroseconds);
+					++rebuildFrameCount;
+				}
+
+				enterSeconds += seconds;
+				worstEnterSeconds = std::max(worstEnterSeconds, seconds);
+				++roomCount;
+			}
+		}
+
+		std::printf("%-22s %-8s %10.2f ms/floor %9.2f ms/room entered %9.2f ms worst room %5d rooms %llu floors generated %5.1f frames to rebuild\n",
+			"floor layouts", "rooms", (generateSeconds * 1e3) / floorCount, (enterSeconds * 1e3) / roomCount, worstEnterSeconds * 1e3,
+			roomCount, static_cast<unsigned long long>(generator.GetGeneratedCount()), static_cast<double>(rebuildFrameCount) / roomCount);
+	}
+
+	// Updates a crowd of moving, spinning, animated entities, and replaces a share of them every frame.
+	void RunEntityStore()
+	{
+		static int const ENTITY_COUNT = 50000;
+		static int const FRAME_COUNT = 200;
+		static int const TURNOVER = ENTITY_COUNT / 100;
+		static float const TIME_DELTA = 1.f / 60.f;
+
+		EntityStore store;
+		Random random(1, RANDOM_STREAM::LEVEL);
+
+		store.Reserve(ENTITY_COUNT);
+
+		for (int e = 0; e < ENTITY_COUNT; ++e)
+		{
+			EntityHandle handle = store.Create(static_cast<float>(random.Range(0, 10000)), static_cast<float>(random.Range(0, 10000)), e % 8);
+			int index = store.GetIndex(handle);
+			store.SetVelocity(index, static_cast<float>(random.Range(-200, 200)), static_cast<float>(random.Range(-200, 200)));
+			store.SetSpin(index, 400.f);
+			store.SetHealth(index, 100);
+			store.SetAnimation(index, 4, static_cast<float>(random.Range(4, 12)));
+		}
+
+		double updateSeconds = 0.0;
+		double worstUpdateSeconds = 0.0;
+		double churnSeconds = 0.0;
+		std::uint64_t allocationsBefore = g_allocationCount;
+
+		for (int frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			auto updateStart = std::chrono::steady_clock::now();
+			store.Integrate(TIME_DELTA);
+			store.Animate(TIME_DELTA);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+
+			updateSeconds += seconds;
+			worstUpdateSeconds = std::max(worstUpdateSeconds, seconds);
+
+			// Some entities die and as many are born, as projectiles hit walls and new ones are fired.
+			auto churnStart = std::chrono::steady_clock::now();
+
+			for (int t = 0; t < TURNOVER; ++t)
+			{
+				store.Destroy(store.GetHandle(random.Range(0, store.GetCount() - 1)));
+
+				EntityHandle handle = store.Create(0.f, 0.f, t % 8);
+				store.SetVelocity(store.GetIndex(handle), 100.f, 0.f);
+			}
+
+			churnSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - churnStart).count();
+		}
+
+		std::uint64_t allocations = g_allocationCount - allocationsBefore;
+
+		std::printf("%-22s %-8s %10.3f ms/update %9.3f ms worst update %9.2f us/replace %5d entities %6.2f allocs/frame\n",
+			"entity store", "crowd", (updateSeconds * 1e3) / FRAME_COUNT, worstUpdateSeconds * 1e3,
+			(churnSeconds * 1e6) / (static_cast<double>(FRAME_COUNT) * TURNOVER), store.GetCount(),
+			static_cast<double>(allocations) / FRAME_COUNT);
+	}
+
+	// Updates a crowd of walkers as the game does its enemies: each seeks a tile centre, takes the next on arrival, and animates.
+	void RunEntityWalkers()
+	{
+		static int const ENTITY_COUNT = 50000;
+		static int const FRAME_COUNT = 200;
+		static float const TIME_DELTA = 1.f / 60.f;
+		static float const TILE = 50.f;
+
+		EntityStore store;
+		Random random(2, RANDOM_STREAM::LEVEL);
+
+		store.Reserve(ENTITY_COUNT);
+
+		for (int e = 0; e < ENTITY_COUNT; ++e)
+		{
+			int index = store.GetIndex(store.Create(random.Range(0, 200) * TILE, random.Range(0, 200) * TILE, e % 16));
+			store.SetSpeed(index, static_cast<float>(random.Range(150, 200)));
+			store.SetHealth(index, 100);
+			store.SetAnimation(index, 8, 12.f);
+		}
+
+		double updateSeconds = 0.0;
+		double worstUpdateSeconds = 0.0;
+		std::uint64_t retargetCount = 0;
+		std::uint64_t allocationsBefore = g_allocationCount;
+
+		for (int frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			auto updateStart = std::chrono::steady_clock::now();
+
+			// Walkers that reached their tile step to a neighbouring one, as enemies follow the flow field.
+			for (int e = 0; e < store.GetCount(); ++e)
+			{
+				if (!store.HasTarget(e))
+				{
+					int direction = static_cast<int>((retargetCount + e) & 3);
+					float stepX = (direction == 0) ? TILE : ((direction == 1) ? -TILE : 0.f);
+					float stepY = (direction == 2) ? TILE : ((direction == 3) ? -TILE : 0.f);
+
+					store.SetTarget(e, store.GetPositionsX()[e] + stepX, store.GetPositionsY()[e] + stepY);
+					++retargetCount;
+				}
+			}
+
+			store.Seek(TIME_DELTA);
+			store.Animate(TIME_DELTA);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+
+			updateSeconds += seconds;
+			worstUpdateSeconds = std::max(worstUpdateSeconds, seconds);
+		}
+
+		std::uint64_t allocations = g_allocationCount - allocationsBefore;
+
+		std::printf("%-22s %-8s %10.3f ms/update %9.3f ms worst update %9.2f steps/frame %5d entities %6.2f allocs/frame\n",
+			"entity store", "walkers", (updateSeconds * 1e3) / FRAME_COUNT, worstUpdateSeconds * 1e3,
+			static_cast<double>(retargetCount) / FRAME_COUNT, store.GetCount(), static_cast<double>(allocations) / FRAME_COUNT);
+	}
+
+	// Builds the all-pairs next-hop table, then runs every query as a walk through it.
+	void RunNextHopTable(const Scenario& scenario)
+	{
+		NextHopTable table;
+		std::vector<GridCoord> path;
+
+		auto buildStart = std::chrono::steady_clock::now();
+		table.Update(scenario.grid);
+		auto buildEnd = std::chrono::steady_clock::now();
+
+		path.reserve(static_cast<size_t>(scenario.grid.GetWidth()) * scenario.grid.GetHeight());
+
+		std::uint64_t allocationsBefore = g_allocationCount;
+		std::uint64_t pathTiles = 0;
+		int foundCount = 0;
+
+		for (size_t q = 0; q < scenario.starts.size(); ++q)
+		{
+			if (table.FindPath(scenario.starts[q], scenario.goals[q], path))
+			{
+				++foundCount;
+				pathTiles += path.size();
+			}
+		}
+
+		auto queryEnd = std::chrono::steady_clock::now();
+
+		// Rebuild again a millisecond slice at a time, as the game does after a door opens.
+		int sliceCount = 0;
+		double worstSliceSeconds = 0.0;
+
+		table.Invalidate();
+
+		for (bool isReady = false; !isReady; ++sliceCount)
+		{
+			auto sliceStart = std::chrono::steady_clock::now();
+			isReady = table.UpdateSliced(scenario.grid, 1000.0);
+			worstSliceSeconds = std::max(worstSliceSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - sliceStart).count());
+		}
+
+		double buildSeconds = std::chrono::duration<double>(buildEnd - buildStart).count();
+		double querySeconds = std::chrono::duration<double>(queryEnd - buildEnd).count();
+		double queryCount = static_cast<double>(scenario.starts.size());
+
+		std::printf("%-22s %-8s %10.1f ms/build %9.2f us/q %9.1f KB table %7.1f tiles/path %5d/%-5d found %6.2f allocs/q %d slices of %.2f ms worst to rebuild\n",
+			scenario.name.c_str(), "next-hop", buildSeconds * 1e3, (querySeconds * 1e6) / queryCount, table.GetByteCount() / 1024.0,
+			(foundCount > 0) ? (static_cast<double>(pathTiles) / foundCount) : 0.0, foundCount, static_cast<int>(queryCount),
+			(g_allocationCount - allocationsBefore) / queryCount, sliceCount, worstSliceSeconds * 1e3);
+	}
+
+	// Has a crowd of agents request a path to a moving target every frame, as enemies would, with and without the cache.
+	void RunPathCache(const Scenario& scenario)
+	{
+		static int const agentCount = 64;
+		static int const frameCount = 600;
+
+		LevelGrid grid = scenario.grid;
+		Pathfinder pathfinder;
+		PathCache cache;
+		std::vector<GridCoord> path;
+		double uncachedSeconds = 0.0;
+		double cachedSeconds = 0.0;
+
+		pathfinder.Reserve(grid.GetWidth() * grid.GetHeight());
+		path.reserve(static_cast<size_t>(grid.GetWidth()) * grid.GetHeight());
+
+		for (int useCache = 0; useCache < 2; ++useCache)
+		{
+			std::vector<GridCoord> agents(scenario.starts.begin(), scenario.starts.begin() + std::min<size_t>(agentCount, scenario.starts.size()));
+			Random random(1, RANDOM_STREAM::ENEMY);
+			GridCoord blockedTile = { -1, -1 };
+
+			grid = scenario.grid;
+			cache.Reset(grid.GetWidth(), grid.GetHeight());
+			cache.ClearStats();
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int frame = 0; frame < frameCount; ++frame)
+			{
+				// The target moves to a new tile every 30 frames, and a door somewhere opens or closes every 60.
+				GridCoord target = scenario.goals[(frame / 30) % scenario.goals.size()];
+
+				if (frame % 60 == 0)
+				{
+					if (blockedTile.x >= 0)
+					{
+						grid.SetTileType(blockedTile.x, blockedTile.y, TILE::FLOOR);
+						cache.OnTileChanged(blockedTile.x, blockedTile.y);
+					}
+
+					blockedTile = scenario.starts[random.Range(0, static_cast<int>(scenario.starts.size()) - 1)];
+					grid.SetTileType(blockedTile.x, blockedTile.y, TILE::WALL_DOOR_LOCKED);
+					cache.OnTileChanged(blockedTile.x, blockedTile.y);
+				}
+
+				for (GridCoord& agent : agents)
+				{
+					bool found;
+
+					if ((useCache != 0) && (cache.Lookup(agent, target, path)))
+					{
+						found = true;
+					}
+					else
+					{
+						auto searchStart = std::chrono::steady_clock::now();
+						found = pathfinder.FindJumpPointPath(grid, agent, target, path);
+						auto searchEnd = std::chrono::steady_clock::now();
+
+						if ((useCache != 0) && (found))
+						{
+							cache.Store(agent, target, path, std::chrono::duration<double, std::micro>(searchEnd - searchStart).count());
+						}
+					}
+
+					// Agents take a step every 8 frames.
+					if ((found) && (!path.empty()) && (frame % 8 == 0))
+					{
+						agent = path[0];
+					}
+				}
+			}
+
+			auto end = std::chrono::steady_clock::now();
+			((useCache != 0) ? cachedSeconds : uncachedSeconds) = std::chrono::duration<double>(end - start).count();
+		}
+
+		const PathCacheStats& stats = cache.GetStats();
+		double lookupCount = static_cast<double>(stats.hitCount + stats.missCount + stats.staleCount);
+
+		std::printf("%-22s %-8s %9.1f%% hits %9.1f%% stale %9.2f ms saved %9.2f ms/frame cached %9.2f ms/frame uncached\n",
+			scenario.name.c_str(), "cache", (100.0 * stats.hitCount) / lookupCount, (100.0 * stats.staleCount) / lookupCount,
+			cache.GetSavedMicroseconds() / 1e3, (cachedSeconds * 1e3) / frameCount, (uncachedSeconds * 1e3) / frameCount);
+	}
+
+	// Has fifty agents ask for a path at once, then compares solving them all in one frame against the request queue.
+	void RunRequestQueue(const Scenario& scenario)
+	{
+		static int const agentCount = 50;
+
+		int requestCount = std::min(agentCount, static_cast<int>(scenario.starts.size()));
+		GridCoord target = scenario.goals[0];
+		Pathfinder pathfinder;
+		PathRequestQueue queue;
+		std::vector<GridCoord> path;
+
+		// Size both pathfinders before anything is measured.
+		pathfinder.FindPath(scenario.grid, scenario.starts[0], target, path);
+		queue.TakeResult(queue.Submit(scenario.starts[0], target, 0.0f), path);
+		queue.Update(scenario.grid, INT_MAX);
+
+		auto syncStart = std::chrono::steady_clock::now();
+
+		for (int a = 0; a < requestCount; ++a)
+		{
+			pathfinder.FindPath(scenario.grid, scenario.starts[a], target, path);
+		}
+
+		double syncMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - syncStart).count();
+
+		for (int a = 0; a < requestCount; ++a)
+		{
+			queue.Submit(scenario.starts[a], target, static_cast<float>(Pathfinder::GetHeuristic(scenario.starts[a], target)));
+		}
+
+		int frameCount = 0;
+		double worstFrameMicroseconds = 0.0;
+
+		while (queue.GetPendingCount() > 0)
+		{
+			auto frameStart = std::chrono::steady_clock::now();
+			queue.Update(scenario.grid);
+			double frameMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameStart).count();
+
+			worstFrameMicroseconds = std::max(worstFrameMicroseconds, frameMicroseconds);
+			++frameCount;
+		}
+
+		std::printf("%-22s %-8s %9.2f ms in one frame %9.2f ms worst frame queued %5d frames for %d requests\n",
+			scenario.name.c_str(), "queue", syncMicroseconds / 1e3, worstFrameMicroseconds / 1e3, frameCount, requestCount);
+	}
+
+	// Builds a flow field to every query goal and walks every query start to it, as a crowd of agents would.
+	void RunFlowField(const Scenario& scenario)
+	{
+		FlowField field;
+		int buildCount = static_cast<int>((scenario.goals.size() < 100) ? scenario.goals.size() : 100);
+
+		// Warm up so the field and its buckets are sized before anything is measured.
+		field.Update(scenario.grid, scenario.goals[0]);
+		field.Invalidate();
+
+		std::uint64_t allocationsBefore = g_allocationCount;
+		auto buildStart = std::chrono::steady_clock::now();
+
+		for (int b = 0; b < buildCount; ++b)
+		{
+			field.Update(scenario.grid, scenario.goals[b]);
+			field.Invalidate();
+		}
+
+		auto buildEnd = std::chrono::steady_clock::now();
+		std::uint64_t buildAllocations = g_allocationCount - allocationsBefore;
+
+		// Read one step for every agent, as each enemy does once per tile.
+		field.Update(scenario.grid, scenario.goals[0]);
+		std::uint64_t stepCount = 0;
+		auto stepStart = std::chrono::steady_clock::now();
+
+		for (int repeat = 0; repeat < 100; ++repeat)
+		{
+			for (const GridCoord& start : scenario.starts)
+			{
+				GridCoord next;
+				stepCount += field.GetNextStep(start.x, start.y, next) ? 1 : 0;
+			}
+		}
+
+		auto stepEnd = std::chrono::steady_clock::now();
+
+		double buildSeconds = std::chrono::duration<double>(buildEnd - buildStart).count();
+		double stepSeconds = std::chrono::duration<double>(stepEnd - stepStart).count();
+
+		std::printf("%-22s %-8s %10.0f builds/s %9.2f us/build %9.1f Msteps/s %5llu steps %6.2f allocs/build\n",
+			scenario.name.c_str(), "flow", buildCount / buildSeconds, (buildSeconds * 1e6) / buildCount,
+			((scenario.starts.size() * 100.0) / stepSeconds) / 1e6, static_cast<unsigned long long>(stepCount),
+			static_cast<double>(buildAllocations) / buildCount);
+	}
+
+	// Computes a radius 20 field of view from the start of every query, as each light and enemy does every frame.
+	void RunFieldOfView(const Scenario& scenario)
+	{
+		static int const RADIUS = 20;
+		FieldOfView view;
+		std::uint64_t visibleCount = 0;
+
+		// Warm up so the bitsets and row stack are sized before anything is measured.
+		view.Compute(scenario.grid, scenario.starts[0], RADIUS);
+
+		std::uint64_t allocationsBefore = g_allocationCount;
+		auto start = std::chrono::steady_clock::now();
+
+		for (const GridCoord& origin : scenario.starts)
+		{
+			view.Compute(scenario.grid, origin, RADIUS);
+			visibleCount += view.GetVisibleCount();
+		}
+
+		auto end = std::chrono::steady_clock::now();
+		std::uint64_t allocations = g_allocationCount - allocationsBefore;
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		double queryCount = static_cast<double>(scenario.starts.size());
+
+		std::printf("%-22s %-8s %10.0f q/s %9.2f us/q %9.1f tiles seen/q %6.2f allocs/q\n",
+			scenario.name.c_str(), "fov r20", queryCount / seconds, (seconds * 1e6) / queryCount,
+			visibleCount / queryCount, static_cast<double>(allocations) / queryCount);
+	}
+
+	// Floods a light from the start of every query, then moves each one a tile and raises a wall at every goal, as
+	// torches, projectiles and SetTile() do in the game.
+	void RunLightField(const Scenario& scenario)
+	{
+		static LightColor const COLOR = { 8, 6, 3 };
+		LevelGrid grid = scenario.grid;
+		LightField field;
+		std::vector<int> ids;
+		int lightCount = static_cast<int>((scenario.starts.size() < 1000) ? scenario.starts.size() : 1000);
+
+		field.Reset(grid);
+		ids.reserve(lightCount);
+
+		auto floodStart = std::chrono::steady_clock::now();
+
+		for (int l = 0; l < lightCount; ++l)
+		{
+			ids.push_back(field.AddLight(grid, scenario.starts[l], COLOR));
+		}
+
+		auto floodEnd = std::chrono::steady_clock::now();
+
+		// Step every light to the next tile along, and back, so each move clears and refloods its light.
+		std::uint64_t moveVisits = 0;
+		std::uint64_t allocationsBefore = g_allocationCount;
+		auto moveStart = std::chrono::steady_clock::now();
+
+		for (int l = 0; l < lightCount; ++l)
+		{
+			GridCoord start = scenario.starts[l];
+			GridCoord next = { (start.x + 1 < grid.GetWidth()) ? start.x + 1 : start.x - 1, start.y };
+
+			field.MoveLight(grid, ids[l], next);
+			moveVisits += field.GetLastVisitCount();
+			field.MoveLight(grid, ids[l], start);
+			moveVisits += field.GetLastVisitCount();
+		}
+
+		auto moveEnd = std::chrono::steady_clock::now();
+		std::uint64_t moveAllocations = g_allocationCount - allocationsBefore;
+
+		// Raise a wall on every goal.
+		std::uint64_t wallVisits = 0;
+		auto wallStart = std::chrono::steady_clock::now();
+
+		for (const GridCoord& goal : scenario.goals)
+		{
+			grid.SetTileType(goal.x, goal.y, TILE::WALL_SINGLE);
+			field.UpdateTile(grid, goal.x, goal.y);
+			wallVisits += field.GetLastVisitCount();
+		}
+
+		auto wallEnd = std::chrono::steady_clock::now();
+
+		double floodSeconds = std::chrono::duration<double>(floodEnd - floodStart).count();
+		double moveCount = lightCount * 2.0;
+		double moveSeconds = std::chrono::duration<double>(moveEnd - moveStart).count();
+		double wallCount = static_cast<double>(scenario.goals.size());
+		double wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+
+		std::printf("%-22s %-8s %10.2f us/add %9.2f us/move %9.1f tiles/move %9.2f us/wall %7.1f tiles/wall %6.2f allocs/move\n",
+			scenario.name.c_str(), "light", (floodSeconds * 1e6) / lightCount, (moveSeconds * 1e6) / moveCount,
+			moveVisits / moveCount, (wallSeconds * 1e6) / wallCount, wallVisits / wallCount,
+			static_cast<double>(moveAllocations) / moveCount);
+	}
+}
+
+// The counting new and delete are kept out of line. Inlined into a caller, the compiler would see memory from
+// operator new handed to free, and warn about a mismatch that the replacement pair makes correct.
+#if defined(_MSC_VER)
+#define ALLOCATOR_NOINLINE __declspec(noinline)
+#else
+#define ALLOCATOR_NOINLINE __attribute__((noinline))
+#endif
+
+// Count allocations made through the global allocator. Every other form of new and delete forwards to these two,
+// so each allocation is counted once and always released by the function that matches the one that made it.
+ALLOCATOR_NOINLINE void* operator new(std::size_t size)
+{
+	++g_allocationCount;
+
+	if (void* memory = std::malloc((size > 0) ? size : 1))
+	{
+		return memory;
+	}
+
+	throw std::bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return ::operator new(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return ::operator new(size, std::nothrow);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	::operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	::operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	::operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	::operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	::operator delete(memory);
+}
+
+// Measures path queries per second on the shipped level and on large generated grids.
+int main(int argc, char* argv[])
+{
+	std::string levelFileName = (argc > 1) ? argv[1] : "Resources/data/level_data.txt";
+	std::vector<Scenario> scenarios(5);
+
+	scenarios[0].name = "shipped 19x19";
+
+	if (!scenarios[0].grid.LoadFromFile(levelFileName))
+	{
+		std::fprintf(stderr, "failed to load level '%s'\n", levelFileName.c_str());
+		return 1;
+	}
+
+	AddQueries(scenarios[0], 100000, 1);
+
+	LevelGenerator mediumGenerator(255, 255);
+	scenarios[1].name = "generated 255x255";
+	mediumGenerator.Generate(1, scenarios[1].grid);
+	AddQueries(scenarios[1], 2000, 2);
+
+	LevelGenerator largeGenerator(1023, 1023);
+	scenarios[2].name = "generated 1023x1023";
+	largeGenerator.Generate(1, scenarios[2].grid);
+	AddQueries(scenarios[2], 200, 3);
+
+	scenarios[3].name = "open hall 1023x1023";
+	MakeHall(scenarios[3].grid, 1023, 4);
+	AddQueries(scenarios[3], 200, 4);
+
+	LevelGenerator hugeGenerator(2047, 2047);
+	scenarios[4].name = "generated 2047x2047";
+	hugeGenerator.Generate(1, scenarios[4].grid);
+	AddQueries(scenarios[4], 20, 5);
+
+	for (const Scenario& scenario : scenarios)
+	{
+		RunAStar(scenario, false);
+		RunAStar(scenario, true);
+		RunHierarchical(scenario);
+
+		if (scenario.grid.GetWidth() * scenario.grid.GetHeight() <= NEXT_HOP_MAX_TILES)
+		{
+			RunNextHopTable(scenario);
+		}
+
+		// A whole crowd searching every frame is only realistic on floors the size of the game's levels.
+		if (scenario.grid.GetWidth() * scenario.grid.GetHeight() <= 256 * 256)
+		{
+			RunPathCache(scenario);
+			RunRequestQueue(scenario);
+		}
+
+		RunFlowField(scenario);
+		RunFieldOfView(scenario);
+		RunLightField(scenario);
+		RunConnectivity(scenario);
+	}
+
+	RunFloorLayout();
+	RunEntityStore();
+	RunEntityWalkers();
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include "ChangeJournal.h"
+
+// Default constructor.
+ChangeJournal::ChangeJournal() :
+m_regions(CHANGE_JOURNAL_CAPACITY),
+m_head(0),
+m_count(0),
+m_version(0),
+m_resetVersion(0)
+{
+}
+
+// Forgets every change and starts a new version.
+void ChangeJournal::Reset()
+{
+	m_head = 0;
+	m_count = 0;
+	m_resetVersion = ++m_version;
+}
+
+// Records a changed rectangle of tiles.
+std::uint32_t ChangeJournal::Record(int firstColumn, int firstRow, int lastColumn, int lastRow, bool solidityChanged)
+{
+	m_regions[m_head] = DirtyRegion{ firstColumn, firstRow, lastColumn, lastRow, ++m_version, solidityChanged };
+	m_head = (m_head + 1) % CHANGE_JOURNAL_CAPACITY;
+	m_count = std::min(m_count + 1, CHANGE_JOURNAL_CAPACITY);
+
+	return m_version;
+}
+
+// Gets the version of the latest change or reset.
+std::uint32_t ChangeJournal::GetVersion() const
+{
+	return m_version;
+}
+
+// Gets the changes made after a version.
+bool ChangeJournal::GetChangesSince(std::uint32_t since, std::vector<DirtyRegion>& regions) const
+{
+	regions.clear();
+
+	if (!CanCatchUp(since))
+	{
+		return false;
+	}
+
+	// Versions are consecutive, so the number of changes since is the difference.
+	int changeCount = static_cast<int>(m_version - since);
+	int slot = (m_head - changeCount + CHANGE_JOURNAL_CAPACITY) % CHANGE_JOURNAL_CAPACITY;
+
+	for (int c = 0; c < changeCount; ++c)
+	{
+		regions.push_back(m_regions[slot]);
+		slot = (slot + 1) % CHANGE_JOURNAL_CAPACITY;
+	}
+
+	return true;
+}
+
+// Gets one rectangle bounding every change made after a version.
+bool ChangeJournal::GetDirtyBounds(std::uint32_t since, DirtyRegion& bounds) const
+{
+	if ((!CanCatchUp(since)) || (since == m_version))
+	{
+		return false;
+	}
+
+	int changeCount = static_cast<int>(m_version - since);
+	int slot = (m_head - changeCount + CHANGE_JOURNAL_CAPACITY) % CHANGE_JOURNAL_CAPACITY;
+
+	bounds = m_regions[slot];
+
+	for (int c = 1; c < changeCount; ++c)
+	{
+		slot = (slot + 1) % CHANGE_JOURNAL_CAPACITY;
+		const DirtyRegion& region = m_regions[slot];
+
+		bounds.firstColumn = std::min(bounds.firstColumn, region.firstColumn);
+		bounds.firstRow = std::min(bounds.firstRow, region.firstRow);
+		bounds.lastColumn = std::max(bounds.lastColumn, region.lastColumn);
+		bounds.lastRow = std::max(bounds.lastRow, region.lastRow);
+		bounds.solidityChanged = bounds.solidityChanged || region.solidityChanged;
+	}
+
+	bounds.version = m_version;
+	return true;
+}
+
+// Checks if a subscriber can catch up from a version with the changes kept.
+bool ChangeJournal::CanCatchUp(std::uint32_t since) const
+{
+	// A subscriber from before the last reset, or from before the oldest kept change, has missed something.
+	return (since >= m_resetVersion) && (since <= m_version) && ((m_version - since) <= static_cast<std::uint32_t>(m_count));
+}
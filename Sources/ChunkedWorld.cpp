@@ -0,0 +1,250 @@
+#include <fstream>
+#include "ChunkedWorld.h"
+
+// Constructor.
+ChunkedWorld::ChunkedWorld(std::uint64_t seed, int maxResidentChunks) :
+m_seed(seed),
+m_maxResidentChunks((maxResidentChunks > 0) ? maxResidentChunks : 1),
+m_generator(&ChunkedWorld::GenerateRoomChunk),
+m_lastKey(0),
+m_lastChunk(nullptr)
+{
+}
+
+// Sets the function used to generate new chunks.
+void ChunkedWorld::SetGenerator(Generator generator)
+{
+	m_generator = generator;
+}
+
+// Sets the directory modified chunks are spilled to.
+void ChunkedWorld::SetSpillDirectory(const std::string& directory)
+{
+	m_spillDirectory = directory;
+}
+
+// Gets the type of the tile at the given world indices.
+TILE ChunkedWorld::GetTileType(int columnIndex, int rowIndex)
+{
+	GridCoord chunk = GetChunkCoord(columnIndex, rowIndex);
+	return Acquire(chunk).grid.GetTileType(columnIndex - (chunk.x * CHUNK_SIZE), rowIndex - (chunk.y * CHUNK_SIZE));
+}
+
+// Sets the type of the tile at the given world indices.
+void ChunkedWorld::SetTileType(int columnIndex, int rowIndex, TILE tileType)
+{
+	GridCoord chunk = GetChunkCoord(columnIndex, rowIndex);
+	Chunk& resident = Acquire(chunk);
+
+	resident.grid.SetTileType(columnIndex - (chunk.x * CHUNK_SIZE), rowIndex - (chunk.y * CHUNK_SIZE), tileType);
+	resident.isModified = true;
+}
+
+// Returns true if the tile at the given world indices is solid.
+bool ChunkedWorld::IsSolid(int columnIndex, int rowIndex)
+{
+	GridCoord chunk = GetChunkCoord(columnIndex, rowIndex);
+	return Acquire(chunk).grid.IsSolid(columnIndex - (chunk.x * CHUNK_SIZE), rowIndex - (chunk.y * CHUNK_SIZE));
+}
+
+// Makes every chunk around a tile resident.
+void ChunkedWorld::UpdateResidentArea(int columnIndex, int rowIndex, int chunkRadius)
+{
+	GridCoord center = GetChunkCoord(columnIndex, rowIndex);
+
+	for (int y = center.y - chunkRadius; y <= center.y + chunkRadius; ++y)
+	{
+		for (int x = center.x - chunkRadius; x <= center.x + chunkRadius; ++x)
+		{
+			Acquire({ x, y });
+		}
+	}
+
+	// Touch the center last so it is the most recently used chunk.
+	Acquire(center);
+}
+
+// Gets the chunk with the given coordinate.
+const LevelGrid* ChunkedWorld::GetChunk(GridCoord chunk)
+{
+	return &Acquire(chunk).grid;
+}
+
+// Gets the number of resident chunks.
+int ChunkedWorld::GetResidentChunkCount() const
+{
+	return static_cast<int>(m_chunks.size());
+}
+
+// Gets the coordinate of the chunk containing the given world indices.
+GridCoord ChunkedWorld::GetChunkCoord(int columnIndex, int rowIndex)
+{
+	// Round towards negative infinity so tiles left of or above the origin land in negative chunks.
+	int x = (columnIndex >= 0) ? (columnIndex / CHUNK_SIZE) : ((columnIndex - CHUNK_SIZE + 1) / CHUNK_SIZE);
+	int y = (rowIndex >= 0) ? (rowIndex / CHUNK_SIZE) : ((rowIndex - CHUNK_SIZE + 1) / CHUNK_SIZE);
+
+	return { x, y };
+}
+
+// Gets a resident chunk, loading or generating it if needed.
+ChunkedWorld::Chunk& ChunkedWorld::Acquire(GridCoord chunk)
+{
+	std::uint64_t key = GetKey(chunk);
+
+	// Most lookups hit the same chunk as the last one.
+	if ((m_lastChunk != nullptr) && (m_lastKey == key))
+	{
+		return *m_lastChunk;
+	}
+
+	auto it = m_chunks.find(key);
+
+	if (it != m_chunks.end())
+	{
+		// Move the chunk to the front of the LRU list.
+		m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+	}
+	else
+	{
+		it = m_chunks.emplace(key, Chunk{ LevelGrid(CHUNK_SIZE, CHUNK_SIZE), m_lru.end(), false }).first;
+		Chunk& created = it->second;
+
+		m_lru.push_front(key);
+		created.lruPosition = m_lru.begin();
+
+		// Prefer a spilled copy, as it holds changes the generator does not know about.
+		bool wasLoaded = false;
+
+		if (!m_spillDirectory.empty())
+		{
+			std::ifstream file(GetSpillPath(key), std::ios::binary);
+			char types[CHUNK_SIZE * CHUNK_SIZE];
+
+			if (file.read(types, sizeof(types)))
+			{
+				for (int j = 0; j < CHUNK_SIZE; ++j)
+				{
+					for (int i = 0; i < CHUNK_SIZE; ++i)
+					{
+						created.grid.SetTileType(i, j, static_cast<TILE>(types[(j * CHUNK_SIZE) + i]));
+					}
+				}
+
+				wasLoaded = true;
+			}
+		}
+
+		if (!wasLoaded)
+		{
+			m_generator(m_seed, chunk, created.grid);
+		}
+
+		EvictExcess(key);
+	}
+
+	m_lastKey = key;
+	m_lastChunk = &it->second;
+
+	return it->second;
+}
+
+// Evicts least-recently-used chunks until the resident set fits its capacity.
+void ChunkedWorld::EvictExcess(std::uint64_t keep)
+{
+	while ((static_cast<int>(m_chunks.size()) > m_maxResidentChunks) && (m_lru.back() != keep))
+	{
+		std::uint64_t key = m_lru.back();
+		auto it = m_chunks.find(key);
+
+		// Spill the chunk if it can no longer be regenerated.
+		if ((it->second.isModified) && (!m_spillDirectory.empty()))
+		{
+			std::ofstream file(GetSpillPath(key), std::ios::binary | std::ios::trunc);
+
+			for (int j = 0; j < CHUNK_SIZE; ++j)
+			{
+				file.write(reinterpret_cast<const char*>(it->second.grid.GetTypeRow(j)), CHUNK_SIZE);
+			}
+		}
+
+		if (m_lastChunk == &it->second)
+		{
+			m_lastChunk = nullptr;
+		}
+
+		m_chunks.erase(it);
+		m_lru.pop_back();
+	}
+}
+
+// Builds the path of the spill file for a chunk.
+std::string ChunkedWorld::GetSpillPath(std::uint64_t key) const
+{
+	GridCoord chunk = GetCoord(key);
+	return m_spillDirectory + "/chunk_" + std::to_string(chunk.x) + "_" + std::to_string(chunk.y) + ".bin";
+}
+
+// Packs a chunk coordinate into a map key.
+std::uint64_t ChunkedWorld::GetKey(GridCoord chunk)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunk.x)) << 32) | static_cast<std::uint32_t>(chunk.y);
+}
+
+// Unpacks a map key into a chunk coordinate.
+GridCoord ChunkedWorld::GetCoord(std::uint64_t key)
+{
+	return { static_cast<int>(static_cast<std::uint32_t>(key >> 32)), static_cast<int>(static_cast<std::uint32_t>(key)) };
+}
+
+// Builds a walled room with one opening per side.
+void ChunkedWorld::GenerateRoomChunk(std::uint64_t seed, GridCoord chunk, LevelGrid& grid)
+{
+	grid.Resize(CHUNK_SIZE, CHUNK_SIZE);
+
+	for (int j = 0; j < CHUNK_SIZE; ++j)
+	{
+		for (int i = 0; i < CHUNK_SIZE; ++i)
+		{
+			grid.SetTileType(i, j, TILE::FLOOR);
+		}
+	}
+
+	// Every chunk owns its top and left walls. The bottom and right walls are the top and left walls
+	// of the neighbouring chunks, so openings always line up without the neighbours being generated.
+	Random random = Random(seed, RANDOM_STREAM::CHUNK).Split(GetKey(chunk));
+	int topOpening = random.Range(2, CHUNK_SIZE - 5);
+	int leftOpening = random.Range(2, CHUNK_SIZE - 5);
+
+	for (int i = 1; i < CHUNK_SIZE; ++i)
+	{
+		if ((i < topOpening) || (i > topOpening + 2))
+		{
+			grid.SetTileType(i, 0, TILE::WALL_TOP);
+		}
+
+		if ((i < leftOpening) || (i > leftOpening + 2))
+		{
+			grid.SetTileType(0, i, TILE::WALL_SIDE);
+		}
+	}
+
+	// Scatter pillars on a sparse lattice. They never touch, so they can't wall off part of the room.
+	for (int j = 4; j < CHUNK_SIZE - 3; j += 6)
+	{
+		for (int i = 4; i < CHUNK_SIZE - 3; i += 6)
+		{
+			if (random.Range(0, 3) == 0)
+			{
+				grid.SetTileType(i, j, TILE::WALL_SINGLE);
+			}
+		}
+	}
+
+	grid.Autotile();
+
+	// The tiles on the chunk edge join walls owned by neighbouring chunks, which the pass above can't see.
+	// Openings never reach the chunk corners, so these neighbours are always walls.
+	grid.SetTileType(0, 0, TILE::WALL_INTERSECTION);
+	grid.SetTileType(CHUNK_SIZE - 1, 0, TILE::WALL_TOP);
+	grid.SetTileType(0, CHUNK_SIZE - 1, TILE::WALL_SIDE);
+}
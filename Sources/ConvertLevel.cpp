@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "LevelFile.h"
+#include "LevelGrid.h"
+
+namespace
+{
+	// Checks that two grids hold the same tiles, solidity, door and torches.
+	bool GridsMatch(const LevelGrid& source, const LevelGrid& copy)
+	{
+		if ((source.GetWidth() != copy.GetWidth()) || (source.GetHeight() != copy.GetHeight()) ||
+			(source.GetDoorIndices() != copy.GetDoorIndices()) || (source.GetTorchIndices() != copy.GetTorchIndices()))
+		{
+			return false;
+		}
+
+		for (int j = 0; j < source.GetHeight(); ++j)
+		{
+			for (int i = 0; i < source.GetWidth(); ++i)
+			{
+				if ((source.GetTileType(i, j) != copy.GetTileType(i, j)) || (source.IsSolid(i, j) != copy.IsSolid(i, j)))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+// Converts a bracketed text level into a binary level file.
+int main(int argc, char* argv[])
+{
+	if ((argc < 3) || (argc > 4))
+	{
+		std::fprintf(stderr, "usage: %s <input.txt> <output%s> [seed]\n", argv[0], LEVEL_FILE_EXTENSION);
+		return 1;
+	}
+
+	LevelGrid grid;
+
+	if (!grid.LoadFromTextFile(argv[1]))
+	{
+		std::fprintf(stderr, "failed to load text level '%s'\n", argv[1]);
+		return 1;
+	}
+
+	// Hand authored levels have no seed, but one can be recorded for levels exported from a generator.
+	if (argc == 4)
+	{
+		grid.SetSeed(std::strtoull(argv[3], nullptr, 10));
+	}
+
+	if (!LevelFile::Write(argv[2], grid))
+	{
+		std::fprintf(stderr, "failed to write binary level '%s'\n", argv[2]);
+		return 1;
+	}
+
+	// Read the file back to make sure it round trips.
+	LevelGrid check;
+
+	if (!check.LoadFromFile(argv[2]))
+	{
+		std::fprintf(stderr, "failed to read back binary level '%s'\n", argv[2]);
+		return 1;
+	}
+
+	if (!GridsMatch(grid, check))
+	{
+		std::fprintf(stderr, "binary level '%s' doesn't match '%s'\n", argv[2], argv[1]);
+		return 1;
+	}
+
+	std::printf("%s: %dx%d tiles, %d torches\n", argv[2], check.GetWidth(), check.GetHeight(), static_cast<int>(check.GetTorchIndices().size()));
+	return 0;
+}
@@ -86,7 +86,7 @@ void Entity::Update(float timeDelta)
 	if (m_currentTextureIndex != static_cast<int>(animState))
 	{
 		m_currentTextureIndex = static_cast<int>(animState);
-		m_sprite.setTexture(TextureManager::GetTexture(m_textureIDs[m_currentTextureIndex]));
+		SetFrameRegion(TextureManager::GetRegion(m_textureIDs[m_currentTextureIndex]));
 	}
 }
 
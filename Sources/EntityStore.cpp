@@ -0,0 +1,385 @@
+#include <cmath>
+#include <cstddef>
+#include "EntityStore.h"
+
+namespace
+{
+	// Moves the last element of an array over an index, and drops the last element.
+	template <typename T>
+	void MoveLastTo(std::vector<T>& values, int index)
+	{
+		values[index] = values.back();
+		values.pop_back();
+	}
+}
+
+// Default constructor.
+EntityStore::EntityStore()
+{
+}
+
+// Makes room for a number of entities.
+void EntityStore::Reserve(int count)
+{
+	std::size_t capacity = static_cast<std::size_t>(count);
+
+	m_positionsX.reserve(capacity);
+	m_positionsY.reserve(capacity);
+	m_velocitiesX.reserve(capacity);
+	m_velocitiesY.reserve(capacity);
+	m_rotations.reserve(capacity);
+	m_spins.reserve(capacity);
+	m_speeds.reserve(capacity);
+	m_targetsX.reserve(capacity);
+	m_targetsY.reserve(capacity);
+	m_hasTargets.reserve(capacity);
+	m_flags.reserve(capacity);
+	m_health.reserve(capacity);
+	m_frames.reserve(capacity);
+	m_frameCounts.reserve(capacity);
+	m_frameTimes.reserve(capacity);
+	m_frameDurations.reserve(capacity);
+	m_spriteIndices.reserve(capacity);
+	m_slots.reserve(capacity);
+	m_slotIndices.reserve(capacity);
+	m_slotGenerations.reserve(capacity);
+	m_freeSlots.reserve(capacity);
+}
+
+// Creates an entity at a position.
+EntityHandle EntityStore::Create(float x, float y, int spriteIndex)
+{
+	int slot;
+
+	if (m_freeSlots.empty())
+	{
+		slot = static_cast<int>(m_slotIndices.size());
+		m_slotIndices.push_back(-1);
+		m_slotGenerations.push_back(0);
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	m_slotIndices[slot] = GetCount();
+	m_slots.push_back(slot);
+
+	m_positionsX.push_back(x);
+	m_positionsY.push_back(y);
+	m_velocitiesX.push_back(0.f);
+	m_velocitiesY.push_back(0.f);
+	m_rotations.push_back(0.f);
+	m_spins.push_back(0.f);
+	m_speeds.push_back(0.f);
+	m_targetsX.push_back(x);
+	m_targetsY.push_back(y);
+	m_hasTargets.push_back(0);
+	m_flags.push_back(0);
+	m_health.push_back(0);
+	m_frames.push_back(0);
+	m_frameCounts.push_back(1);
+	m_frameTimes.push_back(0.f);
+	m_frameDurations.push_back(0.f);
+	m_spriteIndices.push_back(spriteIndex);
+
+	return { slot, m_slotGenerations[slot] };
+}
+
+// Destroys an entity.
+bool EntityStore::Destroy(EntityHandle handle)
+{
+	int index = GetIndex(handle);
+
+	if (index < 0)
+	{
+		return false;
+	}
+
+	// Keep the living entities packed by moving the last one into the gap.
+	MoveLastTo(m_positionsX, index);
+	MoveLastTo(m_positionsY, index);
+	MoveLastTo(m_velocitiesX, index);
+	MoveLastTo(m_velocitiesY, index);
+	MoveLastTo(m_rotations, index);
+	MoveLastTo(m_spins, index);
+	MoveLastTo(m_speeds, index);
+	MoveLastTo(m_targetsX, index);
+	MoveLastTo(m_targetsY, index);
+	MoveLastTo(m_hasTargets, index);
+	MoveLastTo(m_flags, index);
+	MoveLastTo(m_health, index);
+	MoveLastTo(m_frames, index);
+	MoveLastTo(m_frameCounts, index);
+	MoveLastTo(m_frameTimes, index);
+	MoveLastTo(m_frameDurations, index);
+	MoveLastTo(m_spriteIndices, index);
+	MoveLastTo(m_slots, index);
+
+	if (index < GetCount())
+	{
+		m_slotIndices[m_slots[index]] = index;
+	}
+
+	m_slotIndices[handle.slot] = -1;
+	++m_slotGenerations[handle.slot];
+	m_freeSlots.push_back(handle.slot);
+
+	return true;
+}
+
+// Destroys every entity.
+void EntityStore::Clear()
+{
+	while (GetCount() > 0)
+	{
+		Destroy(GetHandle(GetCount() - 1));
+	}
+}
+
+// Checks if a handle still refers to a living entity.
+bool EntityStore::IsAlive(EntityHandle handle) const
+{
+	return (GetIndex(handle) >= 0);
+}
+
+// Gets the number of living entities.
+int EntityStore::GetCount() const
+{
+	return static_cast<int>(m_slots.size());
+}
+
+// Gets the index of an entity in the component arrays.
+int EntityStore::GetIndex(EntityHandle handle) const
+{
+	if ((handle.slot < 0) || (handle.slot >= static_cast<int>(m_slotIndices.size())) || (m_slotGenerations[handle.slot] != handle.generation))
+	{
+		return -1;
+	}
+
+	return m_slotIndices[handle.slot];
+}
+
+// Gets the handle of the entity at an index.
+EntityHandle EntityStore::GetHandle(int index) const
+{
+	int slot = m_slots[index];
+	return { slot, m_slotGenerations[slot] };
+}
+
+// Moves the entity at an index.
+void EntityStore::SetPosition(int index, float x, float y)
+{
+	m_positionsX[index] = x;
+	m_positionsY[index] = y;
+}
+
+// Sets the velocity of the entity at an index.
+void EntityStore::SetVelocity(int index, float x, float y)
+{
+	m_velocitiesX[index] = x;
+	m_velocitiesY[index] = y;
+}
+
+// Sets how fast the entity at an index spins.
+void EntityStore::SetSpin(int index, float degreesPerSecond)
+{
+	m_spins[index] = degreesPerSecond;
+}
+
+// Sets the speed the entity at an index walks at.
+void EntityStore::SetSpeed(int index, float speed)
+{
+	m_speeds[index] = speed;
+}
+
+// Gives the entity at an index a position to walk to.
+void EntityStore::SetTarget(int index, float x, float y)
+{
+	m_targetsX[index] = x;
+	m_targetsY[index] = y;
+	m_hasTargets[index] = 1;
+}
+
+// Checks if the entity at an index is walking to a target.
+bool EntityStore::HasTarget(int index) const
+{
+	return (m_hasTargets[index] != 0);
+}
+
+// Sets the flags of the entity at an index.
+void EntityStore::SetFlags(int index, std::uint32_t flags)
+{
+	m_flags[index] = flags;
+}
+
+// Sets the health of the entity at an index.
+void EntityStore::SetHealth(int index, int health)
+{
+	m_health[index] = health;
+}
+
+// Deals damage to the entity at an index.
+bool EntityStore::Damage(int index, int damage)
+{
+	m_health[index] -= damage;
+	return (m_health[index] <= 0);
+}
+
+// Sets the animation of the entity at an index.
+void EntityStore::SetAnimation(int index, int frameCount, float framesPerSecond)
+{
+	m_frames[index] = 0;
+	m_frameCounts[index] = (frameCount > 0) ? frameCount : 1;
+	m_frameTimes[index] = 0.f;
+	m_frameDurations[index] = (framesPerSecond > 0.f) ? (1.f / framesPerSecond) : 0.f;
+}
+
+// Changes the sprite the entity at an index is drawn with.
+void EntityStore::SetSpriteIndex(int index, int spriteIndex)
+{
+	m_spriteIndices[index] = spriteIndex;
+}
+
+// Moves every entity along its velocity, and turns it by its spin.
+void EntityStore::Integrate(float timeDelta)
+{
+	// One component per loop, so each is a straight run over two arrays the compiler can vectorise.
+	int count = GetCount();
+	float* positionsX = m_positionsX.data();
+	float* positionsY = m_positionsY.data();
+	float* rotations = m_rotations.data();
+	const float* velocitiesX = m_velocitiesX.data();
+	const float* velocitiesY = m_velocitiesY.data();
+	const float* spins = m_spins.data();
+
+	for (int i = 0; i < count; ++i)
+	{
+		positionsX[i] += velocitiesX[i] * timeDelta;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		positionsY[i] += velocitiesY[i] * timeDelta;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		float rotation = rotations[i] + (spins[i] * timeDelta);
+		rotation -= (rotation >= 360.f) ? 360.f : 0.f;
+		rotation += (rotation < 0.f) ? 360.f : 0.f;
+		rotations[i] = rotation;
+	}
+}
+
+// Walks every entity that has a target towards it.
+void EntityStore::Seek(float timeDelta)
+{
+	int count = GetCount();
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (!m_hasTargets[i])
+		{
+			continue;
+		}
+
+		float directionX = m_targetsX[i] - m_positionsX[i];
+		float directionY = m_targetsY[i] - m_positionsY[i];
+		float distance = std::sqrt((directionX * directionX) + (directionY * directionY));
+		float step = m_speeds[i] * timeDelta;
+
+		if (distance <= step)
+		{
+			// Snap to the target, so entities stop exactly where they were sent.
+			m_positionsX[i] = m_targetsX[i];
+			m_positionsY[i] = m_targetsY[i];
+			m_hasTargets[i] = 0;
+		}
+		else
+		{
+			m_velocitiesX[i] = directionX * (m_speeds[i] / distance);
+			m_velocitiesY[i] = directionY * (m_speeds[i] / distance);
+			m_positionsX[i] += m_velocitiesX[i] * timeDelta;
+			m_positionsY[i] += m_velocitiesY[i] * timeDelta;
+		}
+	}
+}
+
+// Advances the frame of every animated entity.
+void EntityStore::Animate(float timeDelta)
+{
+	int count = GetCount();
+
+	for (int i = 0; i < count; ++i)
+	{
+		// Entities that don't animate have no duration, and never reach it.
+		if (m_frameDurations[i] <= 0.f)
+		{
+			continue;
+		}
+
+		m_frameTimes[i] += timeDelta;
+
+		if (m_frameTimes[i] >= m_frameDurations[i])
+		{
+			m_frameTimes[i] = 0.f;
+			m_frames[i] = (m_frames[i] + 1 < m_frameCounts[i]) ? (m_frames[i] + 1) : 0;
+		}
+	}
+}
+
+// Gets the horizontal positions.
+const float* EntityStore::GetPositionsX() const
+{
+	return m_positionsX.data();
+}
+
+// Gets the vertical positions.
+const float* EntityStore::GetPositionsY() const
+{
+	return m_positionsY.data();
+}
+
+// Gets the horizontal velocities.
+const float* EntityStore::GetVelocitiesX() const
+{
+	return m_velocitiesX.data();
+}
+
+// Gets the vertical velocities.
+const float* EntityStore::GetVelocitiesY() const
+{
+	return m_velocitiesY.data();
+}
+
+// Gets the rotations.
+const float* EntityStore::GetRotations() const
+{
+	return m_rotations.data();
+}
+
+// Gets the flags.
+const std::uint32_t* EntityStore::GetFlags() const
+{
+	return m_flags.data();
+}
+
+// Gets the health.
+const int* EntityStore::GetHealth() const
+{
+	return m_health.data();
+}
+
+// Gets the current frames.
+const int* EntityStore::GetFrames() const
+{
+	return m_frames.data();
+}
+
+// Gets the indices of the sprites the entities are drawn with.
+const int* EntityStore::GetSpriteIndices() const
+{
+	return m_spriteIndices.data();
+}
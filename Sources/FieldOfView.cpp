@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include "FieldOfView.h"
+
+namespace
+{
+	// Divides, rounding towards negative infinity. The divisor must be positive.
+	int FloorDivide(int numerator, int denominator)
+	{
+		return (numerator >= 0) ? (numerator / denominator) : -((denominator - 1 - numerator) / denominator);
+	}
+
+	// Divides, rounding towards positive infinity. The divisor must be positive.
+	int CeilDivide(int numerator, int denominator)
+	{
+		return -FloorDivide(-numerator, denominator);
+	}
+
+	// Turns a depth and column within a quadrant into a tile.
+	GridCoord ToTile(GridCoord origin, int quadrant, int depth, int column)
+	{
+		switch (quadrant)
+		{
+		case 0: return { origin.x + column, origin.y - depth };
+		case 1: return { origin.x + depth, origin.y + column };
+		case 2: return { origin.x + column, origin.y + depth };
+		default: return { origin.x - depth, origin.y + column };
+		}
+	}
+}
+
+// Default constructor.
+FieldOfView::FieldOfView() :
+m_solid(nullptr),
+m_solidWordsPerRow(0),
+m_gridWidth(0),
+m_gridHeight(0),
+m_origin({ 0, 0 }),
+m_radius(0),
+m_windowSize(0),
+m_wordsPerRow(0),
+m_visibleCount(0)
+{
+}
+
+// Finds the tiles that can be seen from a tile.
+void FieldOfView::Compute(const LevelGrid& grid, GridCoord origin, int radius)
+{
+	m_origin = origin;
+	m_radius = std::max(radius, 0);
+	m_windowSize = (2 * m_radius) + 1;
+	m_wordsPerRow = (m_windowSize + 63) / 64;
+
+	Clear();
+
+	m_gridWidth = grid.GetWidth();
+	m_gridHeight = grid.GetHeight();
+
+	if ((origin.x < 0) || (origin.x >= m_gridWidth) || (origin.y < 0) || (origin.y >= m_gridHeight))
+	{
+		return;
+	}
+
+	// The rows are stored back to back, so one pointer covers the whole grid.
+	m_solid = grid.GetSolidRow(0);
+	m_solidWordsPerRow = grid.GetWordsPerRow();
+
+	m_columnLimits.resize(m_radius + 1);
+
+	for (int depth = 0; depth <= m_radius; ++depth)
+	{
+		m_columnLimits[depth] = static_cast<int>(std::sqrt(static_cast<float>((m_radius * m_radius) - (depth * depth))));
+	}
+
+	Reveal(origin.x, origin.y, IsOpaque(origin.x, origin.y));
+
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		ScanQuadrant(quadrant);
+	}
+
+	m_solid = nullptr;
+}
+
+// Removes every visible tile.
+void FieldOfView::Clear()
+{
+	m_visible.assign(static_cast<size_t>(m_wordsPerRow) * m_windowSize, 0);
+	m_visibleOpen.assign(static_cast<size_t>(m_wordsPerRow) * m_windowSize, 0);
+	m_visibleCount = 0;
+}
+
+// Checks if a tile was seen by the last Compute().
+bool FieldOfView::IsVisible(int columnIndex, int rowIndex) const
+{
+	int word;
+	std::uint64_t bit;
+
+	return (GetBit(columnIndex, rowIndex, word, bit)) && ((m_visible[word] & bit) != 0);
+}
+
+// Checks if a tile corner touches a passable tile that was seen.
+bool FieldOfView::IsCornerVisible(int columnIndex, int rowIndex) const
+{
+	for (int j = rowIndex - 1; j <= rowIndex; ++j)
+	{
+		for (int i = columnIndex - 1; i <= columnIndex; ++i)
+		{
+			int word;
+			std::uint64_t bit;
+
+			if ((GetBit(i, j, word, bit)) && ((m_visibleOpen[word] & bit) != 0))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Gets the number of tiles seen by the last Compute().
+int FieldOfView::GetVisibleCount() const
+{
+	return m_visibleCount;
+}
+
+// Scans one quadrant.
+void FieldOfView::ScanQuadrant(int quadrant)
+{
+	// The first row is one step out, and sees everything between the two diagonals.
+	m_rows.clear();
+	m_rows.push_back({ 1, -1, 1, 1, 1 });
+
+	while (!m_rows.empty())
+	{
+		ScanRow row = m_rows.back();
+		m_rows.pop_back();
+
+		if (row.depth > m_radius)
+		{
+			continue;
+		}
+
+		// The columns the slopes pass through. Ties round towards the middle of the row, so a slope through a corner
+		// doesn't pick up the tile beyond it.
+		int firstColumn = FloorDivide((2 * row.depth * row.startNumerator) + row.startDenominator, 2 * row.startDenominator);
+		int lastColumn = CeilDivide((2 * row.depth * row.endNumerator) - row.endDenominator, 2 * row.endDenominator);
+
+		// Nothing beyond the radius is revealed, and the rows further out only lead further beyond it. One column
+		// past the radius is still scanned, so a wall there narrows the slopes the same as without the cut.
+		int limit = m_columnLimits[row.depth] + 1;
+		firstColumn = std::max(firstColumn, -limit);
+		lastColumn = std::min(lastColumn, limit);
+
+		bool hasPrevious = false;
+		bool wasOpaque = false;
+
+		for (int column = firstColumn; column <= lastColumn; ++column)
+		{
+			GridCoord tile = ToTile(m_origin, quadrant, row.depth, column);
+			bool isOpaque = IsOpaque(tile.x, tile.y);
+
+			// Walls show if any part of them is in view. Floor only shows if its centre is, which keeps sight symmetric.
+			bool isCentreInView = ((column * row.startDenominator) >= (row.depth * row.startNumerator)) &&
+				((column * row.endDenominator) <= (row.depth * row.endNumerator));
+
+			if (((isOpaque) || (isCentreInView)) && (column >= 1 - limit) && (column <= limit - 1))
+			{
+				Reveal(tile.x, tile.y, isOpaque);
+			}
+
+			if ((hasPrevious) && (wasOpaque) && (!isOpaque))
+			{
+				// Leaving a wall. The rest of the row is only seen past the wall's edge.
+				row.startNumerator = (2 * column) - 1;
+				row.startDenominator = 2 * row.depth;
+			}
+			else if ((hasPrevious) && (!wasOpaque) && (isOpaque))
+			{
+				// Reaching a wall. The floor before it is seen into the next row, up to the wall's edge.
+				m_rows.push_back({ row.depth + 1, row.startNumerator, row.startDenominator, (2 * column) - 1, 2 * row.depth });
+			}
+
+			hasPrevious = true;
+			wasOpaque = isOpaque;
+		}
+
+		if ((hasPrevious) && (!wasOpaque))
+		{
+			m_rows.push_back({ row.depth + 1, row.startNumerator, row.startDenominator, row.endNumerator, row.endDenominator });
+		}
+	}
+}
+
+// Checks if a tile blocks sight.
+bool FieldOfView::IsOpaque(int columnIndex, int rowIndex) const
+{
+	if ((columnIndex < 0) || (columnIndex >= m_gridWidth) || (rowIndex < 0) || (rowIndex >= m_gridHeight))
+	{
+		return true;
+	}
+
+	return ((m_solid[(rowIndex * m_solidWordsPerRow) + (columnIndex >> 6)] >> (columnIndex & 63)) & 1) != 0;
+}
+
+// Marks a tile visible, if it's on the grid.
+void FieldOfView::Reveal(int columnIndex, int rowIndex, bool isOpaque)
+{
+	if ((columnIndex < 0) || (columnIndex >= m_gridWidth) || (rowIndex < 0) || (rowIndex >= m_gridHeight))
+	{
+		return;
+	}
+
+	int word;
+	std::uint64_t bit;
+
+	if ((GetBit(columnIndex, rowIndex, word, bit)) && ((m_visible[word] & bit) == 0))
+	{
+		m_visible[word] |= bit;
+		++m_visibleCount;
+
+		if (!isOpaque)
+		{
+			m_visibleOpen[word] |= bit;
+		}
+	}
+}
+
+// Gets the bit of a tile in the window.
+bool FieldOfView::GetBit(int columnIndex, int rowIndex, int& word, std::uint64_t& bit) const
+{
+	int x = columnIndex - (m_origin.x - m_radius);
+	int y = rowIndex - (m_origin.y - m_radius);
+
+	if ((x < 0) || (x >= m_windowSize) || (y < 0) || (y >= m_windowSize))
+	{
+		return false;
+	}
+
+	word = (y * m_wordsPerRow) + (x >> 6);
+	bit = std::uint64_t(1) << (x & 63);
+	return true;
+}
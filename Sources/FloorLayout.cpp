@@ -0,0 +1,182 @@
+#include <algorithm>
+#include "FloorLayout.h"
+#include "Random.h"
+
+namespace
+{
+	// The offsets of each FLOOR_DOOR direction in the layout.
+	const int COLUMN_OFFSETS[4] = { 0, 1, 0, -1 };
+	const int ROW_OFFSETS[4] = { -1, 0, 1, 0 };
+
+	// The path through the first floor has this many rooms plus one, and grows by a room per floor up to the maximum.
+	const int MAIN_PATH_BASE_LENGTH = 3;
+	const int MAIN_PATH_MAX_LENGTH = 12;
+
+	// The most side rooms a floor has. Every second floor gets one more.
+	const int SIDE_ROOM_MAX_COUNT = 4;
+
+	// The number of places tried for each side room before it is left out.
+	const int SIDE_ROOM_ATTEMPTS = 8;
+}
+
+// Constructor.
+FloorLayoutGenerator::FloorLayoutGenerator(int roomWidth, int roomHeight) :
+m_roomGenerator(roomWidth, roomHeight),
+m_floors(FLOOR_LAYOUT_CACHE_SIZE),
+m_lastUsed(FLOOR_LAYOUT_CACHE_SIZE, 0),
+m_useCounter(0),
+m_generatedCount(0)
+{
+}
+
+// Gets a floor, generating it if it isn't kept.
+const FloorLayout& FloorLayoutGenerator::GetFloor(std::uint64_t seed, int floorNumber)
+{
+	++m_useCounter;
+	int oldestSlot = 0;
+
+	for (int s = 0; s < FLOOR_LAYOUT_CACHE_SIZE; ++s)
+	{
+		if ((m_lastUsed[s] != 0) && (m_floors[s].seed == seed) && (m_floors[s].floorNumber == floorNumber))
+		{
+			m_lastUsed[s] = m_useCounter;
+			return m_floors[s];
+		}
+
+		if (m_lastUsed[s] < m_lastUsed[oldestSlot])
+		{
+			oldestSlot = s;
+		}
+	}
+
+	Generate(seed, floorNumber, m_floors[oldestSlot]);
+	m_lastUsed[oldestSlot] = m_useCounter;
+	++m_generatedCount;
+
+	return m_floors[oldestSlot];
+}
+
+// Gets the number of floors generated.
+std::uint64_t FloorLayoutGenerator::GetGeneratedCount() const
+{
+	return m_generatedCount;
+}
+
+// Generates a floor.
+void FloorLayoutGenerator::Generate(std::uint64_t seed, int floorNumber, FloorLayout& layout)
+{
+	// The layout and each room draw from their own child stream, so rooms don't change when the layout code does.
+	Random floorRandom = Random(seed, RANDOM_STREAM::ROOM).Split(static_cast<std::uint64_t>(floorNumber));
+	Random random = floorRandom.Split(0);
+
+	layout.seed = seed;
+	layout.floorNumber = floorNumber;
+	layout.rooms.clear();
+	std::fill(&layout.cells[0][0], &layout.cells[0][0] + (FLOOR_LAYOUT_ROWS * FLOOR_LAYOUT_COLUMNS), FLOOR_NO_ROOM);
+
+	// Walk from the left edge towards the right, stepping up or down now and then. Right is twice as likely.
+	int pathLength = std::min(MAIN_PATH_BASE_LENGTH + std::max(floorNumber, 1), MAIN_PATH_MAX_LENGTH);
+	GridCoord cell = { 0, random.Range(0, FLOOR_LAYOUT_ROWS - 1) };
+	AddRoom(layout, cell, FLOOR_NO_ROOM);
+
+	while (static_cast<int>(layout.rooms.size()) < pathLength)
+	{
+		GridCoord options[4];
+		int optionCount = 0;
+
+		if (cell.x + 1 < FLOOR_LAYOUT_COLUMNS)
+		{
+			options[optionCount++] = { cell.x + 1, cell.y };
+			options[optionCount++] = { cell.x + 1, cell.y };
+		}
+
+		if ((cell.y > 0) && (layout.cells[cell.y - 1][cell.x] == FLOOR_NO_ROOM))
+		{
+			options[optionCount++] = { cell.x, cell.y - 1 };
+		}
+
+		if ((cell.y + 1 < FLOOR_LAYOUT_ROWS) && (layout.cells[cell.y + 1][cell.x] == FLOOR_NO_ROOM))
+		{
+			options[optionCount++] = { cell.x, cell.y + 1 };
+		}
+
+		if (optionCount == 0)
+		{
+			break;
+		}
+
+		cell = options[random.Range(0, optionCount - 1)];
+		AddRoom(layout, cell, static_cast<int>(layout.rooms.size()) - 1);
+	}
+
+	layout.mainPathLength = static_cast<int>(layout.rooms.size());
+
+	// Branch side rooms off random rooms into free neighbouring cells.
+	int sideRoomCount = std::min((std::max(floorNumber, 1) / 2) + 1, SIDE_ROOM_MAX_COUNT);
+
+	for (int s = 0; s < sideRoomCount; ++s)
+	{
+		for (int attempt = 0; attempt < SIDE_ROOM_ATTEMPTS; ++attempt)
+		{
+			int parent = random.Range(0, static_cast<int>(layout.rooms.size()) - 1);
+			int direction = random.Range(0, static_cast<int>(FLOOR_DOOR::COUNT) - 1);
+			GridCoord next = { layout.rooms[parent].cell.x + COLUMN_OFFSETS[direction], layout.rooms[parent].cell.y + ROW_OFFSETS[direction] };
+
+			if ((next.x >= 0) && (next.x < FLOOR_LAYOUT_COLUMNS) && (next.y >= 0) && (next.y < FLOOR_LAYOUT_ROWS) &&
+				(layout.cells[next.y][next.x] == FLOOR_NO_ROOM))
+			{
+				AddRoom(layout, next, parent);
+				break;
+			}
+		}
+	}
+
+	// Generate the tiles of every room now, so entering one later costs nothing but a copy.
+	for (std::size_t r = 0; r < layout.rooms.size(); ++r)
+	{
+		FloorRoom& room = layout.rooms[r];
+		Random roomRandom = floorRandom.Split(r + 1);
+
+		// A room that fails the connectivity check is replaced by one from the next seed of its stream.
+		while (!m_roomGenerator.Generate(roomRandom.Next(), room.grid))
+		{
+		}
+
+		int bottomRow = room.grid.GetHeight() - 1;
+		room.entrance = { room.grid.GetWidth() / 2, bottomRow - 1 };
+
+		for (int i = 0; i < room.grid.GetWidth(); ++i)
+		{
+			if (room.grid.GetTileType(i, bottomRow) == TILE::WALL_ENTRANCE)
+			{
+				room.entrance = { i, bottomRow - 1 };
+				break;
+			}
+		}
+	}
+}
+
+// Adds a room to a floor.
+void FloorLayoutGenerator::AddRoom(FloorLayout& layout, GridCoord cell, int parent)
+{
+	int index = static_cast<int>(layout.rooms.size());
+	layout.cells[cell.y][cell.x] = index;
+	layout.rooms.push_back(FloorRoom{ cell, parent, 0, { 0, 0 }, LevelGrid() });
+
+	if (parent == FLOOR_NO_ROOM)
+	{
+		return;
+	}
+
+	FloorRoom& parentRoom = layout.rooms[parent];
+
+	for (int direction = 0; direction < static_cast<int>(FLOOR_DOOR::COUNT); ++direction)
+	{
+		if ((parentRoom.cell.x + COLUMN_OFFSETS[direction] == cell.x) && (parentRoom.cell.y + ROW_OFFSETS[direction] == cell.y))
+		{
+			// The opposite direction is two steps round.
+			parentRoom.doors |= static_cast<std::uint8_t>(1 << direction);
+			layout.rooms[index].doors |= static_cast<std::uint8_t>(1 << ((direction + 2) % 4));
+		}
+	}
+}
@@ -0,0 +1,162 @@
+#include "FlowField.h"
+#include "Pathfinder.h"
+
+namespace
+{
+	// The neighbour offsets. Straight moves come first, then diagonals.
+	const int COLUMN_OFFSETS[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	const int ROW_OFFSETS[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+}
+
+// Default constructor.
+FlowField::FlowField() :
+m_width(0),
+m_height(0),
+m_target({ -1, -1 }),
+m_isDirty(true),
+m_buckets(PATH_DIAGONAL_COST + 1)
+{
+}
+
+// Rebuilds the field if it is out of date.
+bool FlowField::Update(const LevelGrid& grid, GridCoord target)
+{
+	if ((!m_isDirty) && (target == m_target) && (grid.GetWidth() == m_width) && (grid.GetHeight() == m_height))
+	{
+		return false;
+	}
+
+	Build(grid, target);
+	return true;
+}
+
+// Marks the field as out of date.
+void FlowField::Invalidate()
+{
+	m_isDirty = true;
+}
+
+// Gets the path cost from a tile to the target.
+int FlowField::GetDistance(int columnIndex, int rowIndex) const
+{
+	if ((static_cast<unsigned>(columnIndex) >= static_cast<unsigned>(m_width)) || (static_cast<unsigned>(rowIndex) >= static_cast<unsigned>(m_height)))
+	{
+		return FLOW_UNREACHABLE;
+	}
+
+	return m_distance[(rowIndex * m_width) + columnIndex];
+}
+
+// Gets the tile to step to from a tile to get closer to the target.
+bool FlowField::GetNextStep(int columnIndex, int rowIndex, GridCoord& next) const
+{
+	if ((static_cast<unsigned>(columnIndex) >= static_cast<unsigned>(m_width)) || (static_cast<unsigned>(rowIndex) >= static_cast<unsigned>(m_height)))
+	{
+		return false;
+	}
+
+	std::uint8_t direction = m_direction[(rowIndex * m_width) + columnIndex];
+
+	if (direction == FLOW_NO_DIRECTION)
+	{
+		return false;
+	}
+
+	next = Step({ columnIndex, rowIndex }, direction);
+	return true;
+}
+
+// Gets the tile the field leads towards.
+GridCoord FlowField::GetTarget() const
+{
+	return m_target;
+}
+
+// Gets the direction of the first step from every tile.
+const std::uint8_t* FlowField::GetDirections() const
+{
+	return m_direction.data();
+}
+
+// Gets the tile a direction leads to.
+GridCoord FlowField::Step(GridCoord tile, std::uint8_t direction)
+{
+	return { tile.x + COLUMN_OFFSETS[direction], tile.y + ROW_OFFSETS[direction] };
+}
+
+// Rebuilds the whole field.
+void FlowField::Build(const LevelGrid& grid, GridCoord target)
+{
+	m_width = grid.GetWidth();
+	m_height = grid.GetHeight();
+	m_target = target;
+	m_isDirty = false;
+
+	m_distance.assign(static_cast<size_t>(m_width) * m_height, FLOW_UNREACHABLE);
+	m_direction.assign(static_cast<size_t>(m_width) * m_height, FLOW_NO_DIRECTION);
+
+	if ((!grid.TileIsValid(target.x, target.y)) || (grid.IsSolid(target.x, target.y)))
+	{
+		return;
+	}
+
+	// Every step costs less than the number of buckets, so a cost always lands in a bucket other than the one being read.
+	int bucketCount = static_cast<int>(m_buckets.size());
+	int targetNode = (target.y * m_width) + target.x;
+
+	m_distance[targetNode] = 0;
+	m_buckets[0].push_back(targetNode);
+	int pending = 1;
+
+	for (int cost = 0; pending > 0; ++cost)
+	{
+		std::vector<int>& bucket = m_buckets[cost % bucketCount];
+
+		for (size_t b = 0; b < bucket.size(); ++b)
+		{
+			int node = bucket[b];
+			--pending;
+
+			// Skip tiles that were reached more cheaply after they were queued here.
+			if (m_distance[node] != cost)
+			{
+				continue;
+			}
+
+			int column = node % m_width;
+			int row = node / m_width;
+
+			for (int n = 0; n < 8; ++n)
+			{
+				int nextColumn = column + COLUMN_OFFSETS[n];
+				int nextRow = row + ROW_OFFSETS[n];
+
+				if ((!grid.TileIsValid(nextColumn, nextRow)) || (grid.IsSolid(nextColumn, nextRow)))
+				{
+					continue;
+				}
+
+				bool isDiagonal = (n >= 4);
+
+				if ((isDiagonal) && ((grid.IsSolid(nextColumn, row)) || (grid.IsSolid(column, nextRow))))
+				{
+					continue;
+				}
+
+				int next = (nextRow * m_width) + nextColumn;
+				int nextCost = cost + (isDiagonal ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST);
+
+				if (nextCost < m_distance[next])
+				{
+					// The step from the neighbour back to this tile is the opposite direction.
+					m_distance[next] = nextCost;
+					m_direction[next] = static_cast<std::uint8_t>((n < 4) ? ((n + 2) % 4) : (4 + ((n - 4 + 2) % 4)));
+					m_buckets[nextCost % bucketCount].push_back(next);
+					++pending;
+				}
+			}
+		}
+
+		bucket.clear();
+	}
+}
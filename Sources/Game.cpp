@@ -1,19 +1,31 @@
+#include <algorithm>
 #include <cmath>
 #include "PCH.h"
 #include "Game.h"
 
-// Default constructor.
-Game::Game(sf::RenderWindow* window) :
+// Constructor.
+Game::Game(sf::RenderWindow* window, std::uint64_t seed, bool isEndless) :
 m_window(*window),
 m_gameState(GAME_STATE::PLAYING),
 m_isRunning(true),
 m_string(""),
+m_lightGridColumns(0),
+m_lightGridRows(0),
+m_lightVersion(0),
+m_hasPlayerView(false),
+m_objectGrid(OBJECT_GRID_CELL_SIZE),
+m_indexedItemCount(0),
+m_indexedEnemyCount(0),
 m_screenSize({ 0, 0 }),
 m_screenCenter({ 0, 0 }),
 m_scoreTotal(0),
 m_goldTotal(0),
 m_projectileTextureID(0),
-m_levelWasGenerated(false)
+m_levelWasGenerated(false),
+m_seed(seed),
+m_isEndless(isEndless),
+m_lootDropCount(0),
+m_enemySpawnCount(0)
 {
 	// Enable VSync.
 	m_window.setVerticalSyncEnabled(true);
@@ -40,12 +52,39 @@ void Game::Initialize()
 	// Load the correct projectile texture.
 	m_projectileTextureID = TextureManager::AddTexture("Resources/projectiles/spr_sword.png");
 
+	// Every projectile is drawn with the one sprite, spinning about its centre.
+	const TextureRegion& projectileRegion = TextureManager::GetRegion(m_projectileTextureID);
+	TextureManager::SetSpriteRegion(m_projectileSprite, m_projectileTextureID);
+	m_projectileSprite.setOrigin(projectileRegion.rect.width / 2.f, projectileRegion.rect.height / 2.f);
+
+	// Load the item textures, by ITEM.
+	m_itemTextureIDs[static_cast<int>(ITEM::GEM)] = TextureManager::AddTexture("Resources/loot/gem/spr_pickup_gem.png");
+	m_itemTextureIDs[static_cast<int>(ITEM::GOLD)] = TextureManager::AddTexture("Resources/loot/gold/spr_pickup_gold_medium.png");
+	m_itemTextureIDs[static_cast<int>(ITEM::HEART)] = TextureManager::AddTexture("Resources/loot/heart/spr_pickup_heart.png");
+	m_itemTextureIDs[static_cast<int>(ITEM::POTION)] = TextureManager::AddTexture("Resources/loot/potions/spr_potion_stamina.png");
+	m_itemTextureIDs[static_cast<int>(ITEM::KEY)] = TextureManager::AddTexture("Resources/loot/key/spr_pickup_key.png");
+
+	// Load the enemy textures, a strip per animation state in ANIMATION_STATE order.
+	static char const* const enemyPaths[] = { "Resources/enemies/slime/spr_slime_", "Resources/enemies/skeleton/spr_skeleton_" };
+	static char const* const stateNames[] = { "walk_up", "walk_down", "walk_right", "walk_left", "idle_up", "idle_down", "idle_right", "idle_left" };
+
+	for (int enemy = 0; enemy < static_cast<int>(ENEMY::COUNT); ++enemy)
+	{
+		for (int state = 0; state < static_cast<int>(ANIMATION_STATE::COUNT); ++state)
+		{
+			int spriteIndex = (enemy * static_cast<int>(ANIMATION_STATE::COUNT)) + state;
+			m_enemyTextureIDs[spriteIndex] = TextureManager::AddTexture(std::string(enemyPaths[enemy]) + stateNames[state] + ".png");
+		}
+	}
+
+	// Keys show their name above them.
+	m_keyText.setFont(m_font);
+	m_keyText.setCharacterSize(12);
+	m_keyText.setString("Key");
+
 	// Initialize the UI.
 	LoadUI();
 
-	// Builds the light grid.
-	ConstructLightGrid();
-
 	// Define the game views.
 	m_views[static_cast<int>(VIEW::MAIN)] = m_window.getDefaultView();
 	m_views[static_cast<int>(VIEW::MAIN)].zoom(0.5f);
@@ -54,53 +93,93 @@ void Game::Initialize()
 	// Load the level.
 	m_level.LoadLevelFromFile("Resources/data/level_data.txt");
 
-	// Set the position of the player.
-	m_player.SetPosition(sf::Vector2f(m_screenCenter.x + 197.f, m_screenCenter.y + 410.f));
+	// Set the position of the player. An endless dungeon replaces the level, and is generated from the game's seed.
+	if (m_isEndless)
+	{
+		m_level.EnableEndlessMode(m_seed);
+		m_player.SetPosition(m_level.GetEndlessSpawnPosition());
+	}
+	else
+	{
+		m_player.SetPosition(sf::Vector2f(m_screenCenter.x + 197.f, m_screenCenter.y + 410.f));
+	}
+
+	// Builds the light grid over the level, or around the player in endless mode.
+	ConstructLightGrid(m_player.GetPosition());
 
 	// Populate level.
 	PopulateLevel();
 }
 
-// Constructs the grid of sprites that are used to draw the game light system.
-void Game::ConstructLightGrid()
+// Constructs the grid of vertices that is used to draw the game light system.
+void Game::ConstructLightGrid(sf::Vector2f playerPosition)
 {
-	// Load the light tile texture and store a reference.
-	int textureID = TextureManager::AddTexture("Resources/spr_light_grid.png");
-	sf::Texture& lightTexture = TextureManager::GetTexture(textureID);
-
-	// Calculate the number of tiles in the grid. Each light tile is 25px square.
+	// Define the bounds of the level. The endless dungeon has no bounds, so the grid only covers the view around the player.
 	sf::IntRect levelArea;
 
-	// Define the bounds of the level.
-	levelArea.left = static_cast<int>(m_level.GetPosition().x);
-	levelArea.top = static_cast<int>(m_level.GetPosition().y);
-	levelArea.width = m_level.GetSize().x * m_level.GetTileSize();
-	levelArea.height = m_level.GetSize().y * m_level.GetTileSize();
-
-	int width, height, lightTotal;
+	if (m_level.IsEndless())
+	{
+		const sf::Vector2f& viewSize = m_views[static_cast<int>(VIEW::MAIN)].getSize();
+		sf::Vector2f origin = GetEndlessLightGridOrigin(playerPosition);
 
-	width = levelArea.width / 25;
-	height = levelArea.height / 25;
+		levelArea.left = static_cast<int>(origin.x);
+		levelArea.top = static_cast<int>(origin.y);
+		levelArea.width = (static_cast<int>(std::ceil(viewSize.x / LIGHT_CELL_SIZE)) + 3) * LIGHT_CELL_SIZE;
+		levelArea.height = (static_cast<int>(std::ceil(viewSize.y / LIGHT_CELL_SIZE)) + 3) * LIGHT_CELL_SIZE;
+	}
+	else
+	{
+		levelArea.left = static_cast<int>(m_level.GetPosition().x);
+		levelArea.top = static_cast<int>(m_level.GetPosition().y);
+		levelArea.width = m_level.GetSize().x * m_level.GetTileSize();
+		levelArea.height = m_level.GetSize().y * m_level.GetTileSize();
+	}
 
-	lightTotal = width * height;
+	// Calculate the number of cells in the grid.
+	int width = levelArea.width / LIGHT_CELL_SIZE;
+	int height = levelArea.height / LIGHT_CELL_SIZE;
 
-	// Create all tiles.
-	for (int i = 0; i < lightTotal; i++)
-	{
-		// Create the tile.
-		sf::Sprite lightSprite;
+	// Store the layout, so only the cells in view need visiting. The light map is sampled at every cell corner.
+	m_lightGridOrigin = sf::Vector2f(static_cast<float>(levelArea.left), static_cast<float>(levelArea.top));
+	m_lightGridColumns = width;
+	m_lightGridRows = height;
+	m_lightMap.Reset(m_lightGridOrigin.x, m_lightGridOrigin.y, static_cast<float>(LIGHT_CELL_SIZE), width + 1, height + 1);
 
-		// Set sprite texture.
-		lightSprite.setTexture(lightTexture);
+	// Create a quad for every cell, row by row, so the rows in view are one contiguous run of vertices.
+	m_lightVertices.setPrimitiveType(sf::Triangles);
+	m_lightVertices.resize(static_cast<size_t>(width) * height * 6);
 
-		// Set the position of the tile.
-		int xPos = levelArea.left + ((i % width) * 25);
-		int yPos = levelArea.top + ((i / width) * 25);
+	for (int row = 0; row < height; ++row)
+	{
+		for (int column = 0; column < width; ++column)
+		{
+			float left = m_lightGridOrigin.x + (column * LIGHT_CELL_SIZE);
+			float top = m_lightGridOrigin.y + (row * LIGHT_CELL_SIZE);
+			float right = left + LIGHT_CELL_SIZE;
+			float bottom = top + LIGHT_CELL_SIZE;
+			sf::Vertex* quad = &m_lightVertices[((row * width) + column) * 6];
+
+			quad[0].position = sf::Vector2f(left, top);
+			quad[1].position = sf::Vector2f(right, top);
+			quad[2].position = sf::Vector2f(right, bottom);
+			quad[3].position = sf::Vector2f(left, top);
+			quad[4].position = sf::Vector2f(right, bottom);
+			quad[5].position = sf::Vector2f(left, bottom);
+
+			// Cells start out dark, in the same near black the window is cleared to.
+			for (int v = 0; v < 6; ++v)
+			{
+				quad[v].color = sf::Color(3, 3, 3, 255);
+			}
+		}
+	}
 
-		lightSprite.setPosition(static_cast<float>(xPos), static_cast<float>(yPos));
+	// The coloured light covers the same quads, and adds nothing until the light field is flooded.
+	m_colorLightVertices = m_lightVertices;
 
-		// Add the sprite to our light vector.
-		m_lightGrid.push_back(lightSprite);
+	for (size_t v = 0; v < m_colorLightVertices.getVertexCount(); ++v)
+	{
+		m_colorLightVertices[v].color = sf::Color::Black;
 	}
 }
 
@@ -109,57 +188,61 @@ void Game::LoadUI()
 {
 	// Initialize the player ui texture and sprite.
 	m_playerUiSprite = std::make_shared<sf::Sprite>();
-	m_playerUiSprite->setTexture(TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_warrior_ui.png")));
+	TextureManager::SetSpriteRegion(*m_playerUiSprite, TextureManager::AddTexture("Resources/ui/spr_warrior_ui.png"));
 	m_playerUiSprite->setPosition(sf::Vector2f(45.f, 45.f));
 	m_playerUiSprite->setOrigin(sf::Vector2f(30.f, 30.f));
 	m_uiSprites.push_back(m_playerUiSprite);
 
 	// Bar outlines.
-	sf::Texture& barOutlineTexture = TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_bar_outline.png"));
-	sf::Vector2f barOutlineTextureOrigin = { barOutlineTexture.getSize().x / 2.f, barOutlineTexture.getSize().y / 2.f };
+	int barOutlineTextureID = TextureManager::AddTexture("Resources/ui/spr_bar_outline.png");
+	const sf::IntRect& barOutlineRect = TextureManager::GetRegion(barOutlineTextureID).rect;
+	sf::Vector2f barOutlineTextureOrigin = { barOutlineRect.width / 2.f, barOutlineRect.height / 2.f };
 
 	m_healthBarOutlineSprite = std::make_shared<sf::Sprite>();
-	m_healthBarOutlineSprite->setTexture(barOutlineTexture);
+	TextureManager::SetSpriteRegion(*m_healthBarOutlineSprite, barOutlineTextureID);
 	m_healthBarOutlineSprite->setPosition(sf::Vector2f(205.f, 35.f));
 	m_healthBarOutlineSprite->setOrigin(sf::Vector2f(barOutlineTextureOrigin.x, barOutlineTextureOrigin.y));
 	m_uiSprites.push_back(m_healthBarOutlineSprite);
 
 	m_manaBarOutlineSprite = std::make_shared<sf::Sprite>();
-	m_manaBarOutlineSprite->setTexture(barOutlineTexture);
+	TextureManager::SetSpriteRegion(*m_manaBarOutlineSprite, barOutlineTextureID);
 	m_manaBarOutlineSprite->setPosition(sf::Vector2f(205.f, 55.f));
 	m_manaBarOutlineSprite->setOrigin(sf::Vector2f(barOutlineTextureOrigin.x, barOutlineTextureOrigin.y));
 	m_uiSprites.push_back(m_manaBarOutlineSprite);
 
 	//Bars.
-	sf::Texture& healthBarTexture = TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_health_bar.png"));
-	sf::Vector2f barTextureOrigin = { healthBarTexture.getSize().x / 2.f, healthBarTexture.getSize().y / 2.f };
+	int healthBarTextureID = TextureManager::AddTexture("Resources/ui/spr_health_bar.png");
+	int manaBarTextureID = TextureManager::AddTexture("Resources/ui/spr_mana_bar.png");
+	m_healthBarRect = TextureManager::GetRegion(healthBarTextureID).rect;
+	m_manaBarRect = TextureManager::GetRegion(manaBarTextureID).rect;
+	sf::Vector2f barTextureOrigin = { m_healthBarRect.width / 2.f, m_healthBarRect.height / 2.f };
 
 	m_healthBarSprite = std::make_shared<sf::Sprite>();
-	m_healthBarSprite->setTexture(healthBarTexture);
+	TextureManager::SetSpriteRegion(*m_healthBarSprite, healthBarTextureID);
 	m_healthBarSprite->setPosition(sf::Vector2f(205.f, 35.f));
 	m_healthBarSprite->setOrigin(sf::Vector2f(barTextureOrigin.x, barTextureOrigin.y));
 
 	m_manaBarSprite = std::make_shared<sf::Sprite>();
-	m_manaBarSprite->setTexture(TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_mana_bar.png")));
+	TextureManager::SetSpriteRegion(*m_manaBarSprite, manaBarTextureID);
 	m_manaBarSprite->setPosition(sf::Vector2f(205.f, 55.f));
 	m_manaBarSprite->setOrigin(sf::Vector2f(barTextureOrigin.x, barTextureOrigin.y));
 
 	// Initialize the coin and gem ui sprites.
 	m_gemUiSprite = std::make_shared<sf::Sprite>();
-	m_gemUiSprite->setTexture(TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_gem_ui.png")));
+	TextureManager::SetSpriteRegion(*m_gemUiSprite, TextureManager::AddTexture("Resources/ui/spr_gem_ui.png"));
 	m_gemUiSprite->setPosition(sf::Vector2f(m_screenCenter.x - 260.f, 50.f));
 	m_gemUiSprite->setOrigin(sf::Vector2f(42.f, 36.f));
 	m_uiSprites.push_back(m_gemUiSprite);
 
 	m_coinUiSprite = std::make_shared<sf::Sprite>();
-	m_coinUiSprite->setTexture(TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_coin_ui.png")));
+	TextureManager::SetSpriteRegion(*m_coinUiSprite, TextureManager::AddTexture("Resources/ui/spr_coin_ui.png"));
 	m_coinUiSprite->setPosition(sf::Vector2f(m_screenCenter.x + 60.f, 50.f));
 	m_coinUiSprite->setOrigin(sf::Vector2f(48.f, 24.f));
 	m_uiSprites.push_back(m_coinUiSprite);
 
 	// Key pickup sprite.
 	m_keyUiSprite = std::make_shared<sf::Sprite>();
-	m_keyUiSprite->setTexture(TextureManager::GetTexture(TextureManager::AddTexture("Resources/ui/spr_key_ui.png")));
+	TextureManager::SetSpriteRegion(*m_keyUiSprite, TextureManager::AddTexture("Resources/ui/spr_key_ui.png"));
 	m_keyUiSprite->setPosition(sf::Vector2f(m_screenSize.x - 120.f, m_screenSize.y - 70.f));
 	m_keyUiSprite->setOrigin(sf::Vector2f(90.f, 45.f));
 	m_keyUiSprite->setColor(sf::Color(255, 255, 255, 60));
@@ -170,7 +253,7 @@ void Game::LoadUI()
 	m_attackStatTextureIDs[1] = TextureManager::AddTexture("Resources/ui/spr_attack_ui_alt.png");
 
 	m_attackStatSprite = std::make_shared<sf::Sprite>();
-	m_attackStatSprite->setTexture(TextureManager::GetTexture(m_attackStatTextureIDs[0]));
+	TextureManager::SetSpriteRegion(*m_attackStatSprite, m_attackStatTextureIDs[0]);
 	m_attackStatSprite->setOrigin(sf::Vector2f(16.f, 16.f));
 	m_attackStatSprite->setPosition(sf::Vector2f(m_screenCenter.x - 270.f, m_screenSize.y - 30.f));
 	m_uiSprites.push_back(m_attackStatSprite);
@@ -179,7 +262,7 @@ void Game::LoadUI()
 	m_defenseStatTextureIDs[1] = TextureManager::AddTexture("Resources/ui/spr_defense_ui_alt.png");
 
 	m_defenseStatSprite = std::make_shared<sf::Sprite>();
-	m_defenseStatSprite->setTexture(TextureManager::GetTexture(m_defenseStatTextureIDs[0]));
+	TextureManager::SetSpriteRegion(*m_defenseStatSprite, m_defenseStatTextureIDs[0]);
 	m_defenseStatSprite->setOrigin(sf::Vector2f(16.f, 16.f));
 	m_defenseStatSprite->setPosition(sf::Vector2f(m_screenCenter.x - 150.f, m_screenSize.y - 30.f));
 	m_uiSprites.push_back(m_defenseStatSprite);
@@ -188,7 +271,7 @@ void Game::LoadUI()
 	m_strengthStatTextureIDs[1] = TextureManager::AddTexture("Resources/ui/spr_strength_ui_alt.png");
 
 	m_strengthStatSprite = std::make_shared<sf::Sprite>();
-	m_strengthStatSprite->setTexture(TextureManager::GetTexture(m_strengthStatTextureIDs[0]));
+	TextureManager::SetSpriteRegion(*m_strengthStatSprite, m_strengthStatTextureIDs[0]);
 	m_strengthStatSprite->setOrigin(sf::Vector2f(22.f, 12.f));
 	m_strengthStatSprite->setPosition(sf::Vector2f(m_screenCenter.x - 30.f, m_screenSize.y - 30.f));
 	m_uiSprites.push_back(m_strengthStatSprite);
@@ -197,7 +280,7 @@ void Game::LoadUI()
 	m_dexterityStatTextureIDs[1] = TextureManager::AddTexture("Resources/ui/spr_dexterity_ui_alt.png");
 
 	m_dexterityStatSprite = std::make_shared<sf::Sprite>();
-	m_dexterityStatSprite->setTexture(TextureManager::GetTexture(m_dexterityStatTextureIDs[0]));
+	TextureManager::SetSpriteRegion(*m_dexterityStatSprite, m_dexterityStatTextureIDs[0]);
 	m_dexterityStatSprite->setOrigin(sf::Vector2f(16.f, 16.f));
 	m_dexterityStatSprite->setPosition(sf::Vector2f(m_screenCenter.x + 90.f, m_screenSize.y - 30.f));
 	m_uiSprites.push_back(m_dexterityStatSprite);
@@ -206,7 +289,7 @@ void Game::LoadUI()
 	m_staminaStatTextureIDs[1] = TextureManager::AddTexture("Resources/ui/spr_stamina_ui_alt.png");
 
 	m_staminaStatSprite = std::make_shared<sf::Sprite>();
-	m_staminaStatSprite->setTexture(TextureManager::GetTexture(m_staminaStatTextureIDs[0]));
+	TextureManager::SetSpriteRegion(*m_staminaStatSprite, m_staminaStatTextureIDs[0]);
 	m_staminaStatSprite->setOrigin(sf::Vector2f(16.f, 16.f));
 	m_staminaStatSprite->setPosition(sf::Vector2f(m_screenCenter.x + 210.f, m_screenSize.y - 30.f));
 	m_uiSprites.push_back(m_staminaStatSprite);
@@ -218,6 +301,26 @@ void Game::PopulateLevel()
 
 }
 
+// Spawns an item.
+void Game::SpawnItem(ITEM type, sf::Vector2f position)
+{
+	EntityHandle item = m_items.Create(position.x, position.y, static_cast<int>(type));
+	m_items.SetAnimation(m_items.GetIndex(item), ENTITY_FRAME_COUNT, ENTITY_FRAMES_PER_SECOND);
+}
+
+// Spawns an enemy.
+void Game::SpawnEnemy(ENEMY type, sf::Vector2f position)
+{
+	// Every enemy rolls from its own stream, so its stats don't depend on what else used random numbers.
+	Random random = Random(m_seed, RANDOM_STREAM::ENEMY).Split(m_enemySpawnCount++);
+
+	int spriteIndex = (static_cast<int>(type) * static_cast<int>(ANIMATION_STATE::COUNT)) + static_cast<int>(ANIMATION_STATE::IDLE_DOWN);
+	int index = m_enemies.GetIndex(m_enemies.Create(position.x, position.y, spriteIndex));
+
+	m_enemies.SetHealth(index, random.Range(80, 120));
+	m_enemies.SetSpeed(index, static_cast<float>(random.Range(150, 200)));
+}
+
 // Returns the running state of the game.
 bool Game::IsRunning()
 {
@@ -278,12 +381,25 @@ void Game::Update(float timeDelta)
 
 	case GAME_STATE::PLAYING:
 	{
+		// Make sure the level around the player exists before anything moves in it.
+		m_level.UpdateStreaming(m_player.GetPosition());
+
 		// First check if the player is at the exit. If so there's no need to update anything.
-		Tile& playerTile = *m_level.GetTile(m_player.GetPosition());
+		Tile playerTile = m_level.GetTile(m_player.GetPosition());
 
 		if (playerTile.type == TILE::WALL_DOOR_UNLOCKED)
 		{
-			// ...
+			// Go through the door. Rooms are generated with their floor, so this is a lookup and a copy of the room's tiles.
+			sf::Vector2f spawnPosition;
+			m_level.EnterNextRoom(spawnPosition);
+			m_player.SetPosition(spawnPosition);
+
+			// Nothing from the old room carries over, and the new room's door starts locked again.
+			m_items.Clear();
+			m_enemies.Clear();
+			m_projectiles.Clear();
+			m_keyUiSprite->setColor(sf::Color(255, 255, 255, 60));
+			PopulateLevel();
 		}
 		else
 		{
@@ -298,9 +414,18 @@ void Game::Update(float timeDelta)
 			{
 				if (m_player.GetMana() >= 2)
 				{
+					// Fire from the player towards the mouse. The player is always at the centre of the screen.
 					sf::Vector2f target(static_cast<float>(sf::Mouse::getPosition().x), static_cast<float>(sf::Mouse::getPosition().y));
-					std::unique_ptr<Projectile> proj = std::make_unique<Projectile>(TextureManager::GetTexture(m_projectileTextureID), playerPosition, m_screenCenter, target);
-					m_playerProjectiles.push_back(std::move(proj));
+					sf::Vector2f direction = target - m_screenCenter;
+					float length = std::sqrt((direction.x * direction.x) + (direction.y * direction.y));
+
+					if (length > 0.f)
+					{
+						EntityHandle projectile = m_projectiles.Create(playerPosition.x, playerPosition.y, m_projectileTextureID);
+						int index = m_projectiles.GetIndex(projectile);
+						m_projectiles.SetVelocity(index, direction.x * (PROJECTILE_SPEED / length), direction.y * (PROJECTILE_SPEED / length));
+						m_projectiles.SetSpin(index, PROJECTILE_SPIN);
+					}
 
 					// Reduce player mana.
 					m_player.SetMana(m_player.GetMana() - 2);
@@ -308,7 +433,10 @@ void Game::Update(float timeDelta)
 			}
 
 			// Update all items.
-			UpdateItems(playerPosition);
+			UpdateItems(playerPosition, timeDelta);
+
+			// Find what the player can see, for the light and the enemies.
+			m_hasPlayerView = m_level.ComputeFieldOfView(playerPosition, PLAYER_SIGHT_RADIUS, m_playerView);
 
 			// Update level light.
 			UpdateLight(playerPosition);
@@ -322,6 +450,9 @@ void Game::Update(float timeDelta)
 			// Venter the view.
 			m_views[static_cast<int>(VIEW::MAIN)].setCenter(playerPosition);
 		}
+
+		// Bucket everything that moved, was added or was removed, ready for drawing.
+		IndexObjects();
 	}
 	break;
 
@@ -334,224 +465,340 @@ void Game::Update(float timeDelta)
 // Updates the level light.
 void Game::UpdateLight(sf::Vector2f playerPosition)
 {
-	for (sf::Sprite& sprite : m_lightGrid)
+	// Torches only move when a new level or room is loaded, which resets the level's change journal. What they can
+	// see only changes when tiles do, which moves the journal on.
+	const ChangeJournal& changes = m_level.GetChangeJournal();
+	bool tilesChanged = (!changes.CanCatchUp(m_lightVersion)) || (changes.GetVersion() != m_lightVersion);
+
+	// A new level or room can be a different size, so the light grid is rebuilt to cover it. In endless mode the grid
+	// only covers the view, so it is rebuilt each time the player crosses into another cell.
+	bool gridMoved = (m_level.IsEndless()) && (GetEndlessLightGridOrigin(playerPosition) != m_lightGridOrigin);
+
+	if ((!changes.CanCatchUp(m_lightVersion)) || (gridMoved))
 	{
-		float tileAlpha = 255.f;			// Tile alpha.
-		float distance = 0.f;				// The distance between player and tile.
+		ConstructLightGrid(playerPosition);
+	}
 
-		// Calculate distance between tile and player.
-		distance = DistanceBetweenPoints(sprite.getPosition(), playerPosition);
+	UpdateLightField(changes);
+
+	if (tilesChanged)
+	{
+		m_lightMap.ClearTorches();
 
-		// Calculate tile transparency.
-		if (distance < 200.f)
+		for (const std::shared_ptr<Torch>& torch : *m_level.GetTorches())
 		{
-			tileAlpha = 0.f;
+			sf::Vector2f position = torch->GetPosition();
+			bool hasView = m_level.ComputeFieldOfView(position, TORCH_SIGHT_RADIUS, m_torchView);
+
+			m_lightMap.AddTorch(position.x, position.y, hasView ? &m_torchView : nullptr);
 		}
-		else if (distance < 250.f)
+	}
+
+	m_lightVersion = changes.GetVersion();
+
+	// Only the flicker changes from frame to frame.
+	m_torchBrightness.clear();
+
+	for (const std::shared_ptr<Torch>& torch : *m_level.GetTorches())
+	{
+		m_torchBrightness.push_back(torch->GetBrightness());
+	}
+
+	m_lightMap.Update(playerPosition.x, playerPosition.y, m_torchBrightness.data(), m_hasPlayerView ? &m_playerView : nullptr);
+
+	// Only the cells the view will show need their light. The view is centred on the player once they've moved.
+	// Each corner takes the darkness sampled there, and the quad blends between its corners.
+	int firstColumn, firstRow, lastColumn, lastRow;
+	GetLightCellRange(GetViewArea(playerPosition), firstColumn, firstRow, lastColumn, lastRow);
+
+	for (int row = firstRow; row <= lastRow; ++row)
+	{
+		for (int column = firstColumn; column <= lastColumn; ++column)
 		{
-			tileAlpha = (51.f * (distance - 200.f)) / 10.f;
+			sf::Color topLeft(3, 3, 3, static_cast<sf::Uint8>(m_lightMap.GetDarkness(column, row)));
+			sf::Color topRight(3, 3, 3, static_cast<sf::Uint8>(m_lightMap.GetDarkness(column + 1, row)));
+			sf::Color bottomRight(3, 3, 3, static_cast<sf::Uint8>(m_lightMap.GetDarkness(column + 1, row + 1)));
+			sf::Color bottomLeft(3, 3, 3, static_cast<sf::Uint8>(m_lightMap.GetDarkness(column, row + 1)));
+			sf::Vertex* quad = &m_lightVertices[((row * m_lightGridColumns) + column) * 6];
+
+			quad[0].color = topLeft;
+			quad[1].color = topRight;
+			quad[2].color = bottomRight;
+			quad[3].color = topLeft;
+			quad[4].color = bottomRight;
+			quad[5].color = bottomLeft;
+
+			// The light field only covers the fixed level, and the endless grid doesn't line up with its tiles.
+			if (m_level.IsEndless())
+			{
+				continue;
+			}
+
+			sf::Color topLeftLight = GetCornerLight(column, row);
+			sf::Color bottomRightLight = GetCornerLight(column + 1, row + 1);
+			sf::Vertex* colorQuad = &m_colorLightVertices[((row * m_lightGridColumns) + column) * 6];
+
+			colorQuad[0].color = topLeftLight;
+			colorQuad[1].color = GetCornerLight(column + 1, row);
+			colorQuad[2].color = bottomRightLight;
+			colorQuad[3].color = topLeftLight;
+			colorQuad[4].color = bottomRightLight;
+			colorQuad[5].color = GetCornerLight(column, row + 1);
 		}
+	}
+}
+
+// Brings the coloured light up to date with the torches, the projectiles and any walls that changed.
+void Game::UpdateLightField(const ChangeJournal& changes)
+{
+	const LevelGrid& grid = m_level.GetGrid();
 
-		// Get all torches from the level.
-		auto torches = m_level.GetTorches();
+	if (!changes.CanCatchUp(m_lightVersion))
+	{
+		// A new level or room. Flood every torch from scratch.
+		m_lightField.Reset(grid);
+		m_projectileLightIds.clear();
 
-		// If there are torches.
-		if (!torches->empty())
+		if (!m_level.IsEndless())
 		{
-			// Update the light surrounding each torch.
-			for (std::shared_ptr<Torch> torch : *torches)
+			for (const std::shared_ptr<Torch>& torch : *m_level.GetTorches())
 			{
-				// If the light tile is within range of the torch.
-				distance = DistanceBetweenPoints(sprite.getPosition(), torch->GetPosition());
-				if (distance < 100.f)
-				{
-					// Edit its alpha.
-					tileAlpha -= (tileAlpha - ((tileAlpha / 100.f) * distance)) * torch->GetBrightness();
-				}
+				Tile tile = m_level.GetTile(torch->GetPosition());
+				m_lightField.AddLight(grid, { tile.columnIndex, tile.rowIndex }, TORCH_LIGHT_COLOR);
+			}
+		}
+	}
+	else if ((!m_level.IsEndless()) && (changes.GetChangesSince(m_lightVersion, m_lightChanges)))
+	{
+		// Only walls going up or coming down move the light, and only the light that passed them.
+		for (const DirtyRegion& region : m_lightChanges)
+		{
+			if (!region.solidityChanged)
+			{
+				continue;
 			}
 
-			// Ensure alpha does not go negative.
-			if (tileAlpha < 0)
+			for (int j = region.firstRow; j <= region.lastRow; ++j)
 			{
-				tileAlpha = 0;
+				for (int i = region.firstColumn; i <= region.lastColumn; ++i)
+				{
+					m_lightField.UpdateTile(grid, i, j);
+				}
 			}
 		}
+	}
+
+	if (m_level.IsEndless())
+	{
+		return;
+	}
+
+	// Projectiles carry their light with them. A light only floods again when its projectile reaches another tile.
+	int projectileCount = 0;
+
+	for (int p = 0; p < m_projectiles.GetCount(); ++p)
+	{
+		Tile tile = m_level.GetTile(GetProjectilePosition(p));
+
+		// A long frame can carry a projectile past the border wall before it is destroyed. It lights nothing there.
+		if (!grid.TileIsValid(tile.columnIndex, tile.rowIndex))
+		{
+			continue;
+		}
+
+		if (projectileCount < static_cast<int>(m_projectileLightIds.size()))
+		{
+			m_lightField.MoveLight(grid, m_projectileLightIds[projectileCount], { tile.columnIndex, tile.rowIndex });
+		}
+		else
+		{
+			m_projectileLightIds.push_back(m_lightField.AddLight(grid, { tile.columnIndex, tile.rowIndex }, PROJECTILE_LIGHT_COLOR));
+		}
 
-		// Set the sprite transparency.
-		sprite.setColor(sf::Color(255, 255, 255, static_cast<sf::Uint8>(tileAlpha)));
+		++projectileCount;
 	}
+
+	while (static_cast<int>(m_projectileLightIds.size()) > projectileCount)
+	{
+		m_lightField.RemoveLight(grid, m_projectileLightIds.back());
+		m_projectileLightIds.pop_back();
+	}
+}
+
+// Gets the coloured light at a light grid corner.
+sf::Color Game::GetCornerLight(int column, int row) const
+{
+	static_assert(LIGHT_CELL_SIZE == TILE_SIZE, "Light grid corners are looked up as tile corners.");
+
+	// Light cells are the size of tiles and start at the level's corner, so a corner touches the four tiles around it.
+	int red = 0;
+	int green = 0;
+	int blue = 0;
+
+	for (int j = row - 1; j <= row; ++j)
+	{
+		for (int i = column - 1; i <= column; ++i)
+		{
+			LightColor light = m_lightField.GetLight(i, j);
+			red = std::max(red, static_cast<int>(light.red));
+			green = std::max(green, static_cast<int>(light.green));
+			blue = std::max(blue, static_cast<int>(light.blue));
+		}
+	}
+
+	return sf::Color(static_cast<sf::Uint8>(red * LIGHT_COLOR_STEP), static_cast<sf::Uint8>(green * LIGHT_COLOR_STEP), static_cast<sf::Uint8>(blue * LIGHT_COLOR_STEP));
 }
 
 // Updates all items in the level.
-void Game::UpdateItems(sf::Vector2f playerPosition)
+void Game::UpdateItems(sf::Vector2f playerPosition, float timeDelta)
 {
-	// Update all items.
-	auto itemIterator = m_items.begin();
-	while (itemIterator != m_items.end())
+	// Walk backwards, so the last item taking a picked up one's index has already been checked.
+	for (int i = m_items.GetCount() - 1; i >= 0; --i)
 	{
-		// Get the item from the iterator.
-		Item& item = **itemIterator;
+		sf::Vector2f position(m_items.GetPositionsX()[i], m_items.GetPositionsY()[i]);
 
 		// Check if the player is within pickup range of the item.
-		if (DistanceBetweenPoints(item.GetPosition(), playerPosition) < 40.f)
+		if (DistanceBetweenPoints(position, playerPosition) < ITEM_PICKUP_DISTANCE)
 		{
-			// Check what type of object it was.
-			switch (item.GetType())
+			// Check what type of item it was.
+			switch (static_cast<ITEM>(m_items.GetSpriteIndices()[i]))
 			{
 			case ITEM::GOLD:
-			{
-				// Get the amount of gold.
-				int goldValue = dynamic_cast<Gold&>(item).GetGoldValue();
-
 				// Add to the gold total.
-				m_goldTotal += goldValue;
-			}
-			break;
+				m_goldTotal += GOLD_PICKUP_VALUE;
+				break;
 
 			case ITEM::GEM:
-			{
-				// Get the score of the gem.
-				int scoreValue = dynamic_cast<Gem&>(item).GetScoreValue();
-
 				// Add to the score total
-				m_scoreTotal += scoreValue;
-			}
-			break;
+				m_scoreTotal += GEM_PICKUP_SCORE;
+				break;
 
 			case ITEM::KEY:
-			{
 				// Unlock the door.
 				m_level.UnlockDoor();
 
 				// Set the key as collected.
 				m_keyUiSprite->setColor(sf::Color::White);
-			}
-			break;
+				break;
 
 			case ITEM::POTION:
-			{
 				// . . .
-			}
-			break;
+				break;
 
 			case ITEM::HEART:
-				// Cast to heart and get health.
-				Heart& heart = dynamic_cast<Heart&>(item);
+				m_player.SetHealth(m_player.GetHealth() + HEART_PICKUP_HEALTH);
+				break;
 
-				m_player.SetHealth(m_player.GetHealth() + heart.GetHealth());
+			default:
+				break;
 			}
 
-			// Finally, delete the object.
-			itemIterator = m_items.erase(itemIterator);
-		}
-		else
-		{
-			// Increment iterator.
-			++itemIterator;
+			// Finally, delete the item.
+			m_items.Destroy(m_items.GetHandle(i));
 		}
 	}
+
+	// Spin the rest through their frames in one pass.
+	m_items.Animate(timeDelta);
 }
 
 // Updates all enemies in the level.
 void Game::UpdateEnemies(sf::Vector2f playerPosition, float timeDelta)
 {
 	// Store player tile.
-	Tile* playerTile = m_level.GetTile(m_player.GetPosition());
+	Tile playerTile = m_level.GetTile(m_player.GetPosition());
 
-	auto enemyIterator = m_enemies.begin();
-	while (enemyIterator != m_enemies.end())
-	{
-		// Create a bool so we can check if an enemy was deleted.
-		bool enemyWasDeleted = false;
+	// Every enemy steps along the same distance field, which is only rebuilt when the player changes tile.
+	m_level.UpdateFlowField(playerPosition);
 
-		// Get the enemy object from the iterator.
-		Enemy& enemy = **enemyIterator;
+	// Rebuilding the path table after a door opens, and queued path requests, each get a fixed slice of the frame,
+	// so neither can cause a spike.
+	m_level.UpdateNextHopTable(NEXT_HOP_FRAME_MICROSECONDS);
+	m_level.UpdatePathRequests(PATH_REQUEST_EXPANSION_BUDGET, PATH_REQUEST_FRAME_MICROSECONDS);
 
+	// Walk backwards, so the last enemy taking a killed one's index has already been updated.
+	for (int e = m_enemies.GetCount() - 1; e >= 0; --e)
+	{
 		// Get the tile that the enemy is on.
-		Tile* enemyTile = m_level.GetTile(enemy.GetPosition());
+		sf::Vector2f position(m_enemies.GetPositionsX()[e], m_enemies.GetPositionsY()[e]);
+		Tile enemyTile = m_level.GetTile(position);
+		bool isDead = false;
 
-		// Check for collisions with projectiles.
-		auto projectilesIterator = m_playerProjectiles.begin();
-		while (projectilesIterator != m_playerProjectiles.end())
+		// Check for collisions with projectiles. A deleted projectile's index is taken by the last one.
+		int projectileIndex = 0;
+		while ((!isDead) && (projectileIndex < m_projectiles.GetCount()))
 		{
-			// Get the projectile object from the iterator.
-			Projectile& projectile = **projectilesIterator;
-
 			// If the enemy and projectile occupy the same tile they have collided.
-			if (enemyTile == m_level.GetTile(projectile.GetPosition()))
+			if (enemyTile == m_level.GetTile(GetProjectilePosition(projectileIndex)))
 			{
-				// Delete the projectile.
-				projectilesIterator = m_playerProjectiles.erase(projectilesIterator);
-
-				// Damage the enemy.
-				enemy.Damage(25);
-
-				// If the enemy is dead remove it.
-				if (enemy.IsDead())
-				{
-					// Get the enemy position.
-					sf::Vector2f position = enemy.GetPosition();
-
-					// Spawn loot.
-					for (int i = 0; i < 5; i++)
-					{
-						position.x += std::rand() % 31 - 15;
-						position.y += std::rand() % 31 - 15;
-						std::unique_ptr<Item> item;
-
-						switch (std::rand() % 2)
-						{
-						case 0: // Spawn gold.
-							item = std::make_unique<Gold>();
-							break;
-
-						case 1: // Spawn gem.
-							item = std::make_unique<Gem>();
-							break;
-						}
-
-						item->SetPosition(position);
-						m_items.push_back(std::move(item));
-					}
-
-					if ((std::rand() % 5) == 0)			// 1 in 5 change of spawning health.
-					{
-						position.x += std::rand() % 31 - 15;
-						position.y += std::rand() % 31 - 15;
-						std::unique_ptr<Item> heart = std::make_unique<Heart>();
-						heart->SetPosition(position);
-						m_items.push_back(std::move(heart));
-					}
-					// 1 in 5 change of spawning potion.
-					else if ((std::rand() % 5) == 1)
-					{
-						position.x += std::rand() % 31 - 15;
-						position.y += std::rand() % 31 - 15;
-						std::unique_ptr<Item> potion = std::make_unique<Potion>();
-						potion->SetPosition(position);
-						m_items.push_back(std::move(potion));
-					}
-
-					// Delete enemy.
-					enemyIterator = m_enemies.erase(enemyIterator);
-					enemyWasDeleted = true;
-
-					// Since the enemy is dead we no longer need to check projectiles.
-					projectilesIterator = m_playerProjectiles.end();
-				}
+				// Delete the projectile, and damage the enemy.
+				m_projectiles.Destroy(m_projectiles.GetHandle(projectileIndex));
+				isDead = m_enemies.Damage(e, PROJECTILE_DAMAGE);
 			}
 			else
 			{
 				// Move to the next projectile.
-				++projectilesIterator;
+				++projectileIndex;
 			}
 		}
 
-		// If the enemy was not deleted, update it and increment the iterator.
-		if (!enemyWasDeleted)
+		if (isDead)
 		{
-			enemy.Update(timeDelta);
-			++enemyIterator;
+			// Every drop rolls from its own stream, so loot doesn't depend on what else used random numbers.
+			Random loot = Random(m_seed, RANDOM_STREAM::LOOT).Split(m_lootDropCount++);
+
+			// Spawn loot.
+			for (int i = 0; i < 5; i++)
+			{
+				position.x += loot.Range(-15, 15);
+				position.y += loot.Range(-15, 15);
+				SpawnItem((loot.Range(0, 1) == 0) ? ITEM::GOLD : ITEM::GEM, position);
+			}
+
+			if (loot.Range(0, 4) == 0)			// 1 in 5 change of spawning health.
+			{
+				position.x += loot.Range(-15, 15);
+				position.y += loot.Range(-15, 15);
+				SpawnItem(ITEM::HEART, position);
+			}
+			// 1 in 5 change of spawning potion.
+			else if (loot.Range(0, 4) == 1)
+			{
+				position.x += loot.Range(-15, 15);
+				position.y += loot.Range(-15, 15);
+				SpawnItem(ITEM::POTION, position);
+			}
+
+			// Delete enemy.
+			m_enemies.Destroy(m_enemies.GetHandle(e));
+		}
+		else
+		{
+			// Sight is symmetric, so the player seeing the enemy's tile means the enemy sees the player. Enemies wait
+			// where they are until they first see the player, then keep hunting even out of sight.
+			std::uint32_t flags = m_enemies.GetFlags()[e];
+
+			if ((!m_hasPlayerView) || (m_playerView.IsVisible(enemyTile.columnIndex, enemyTile.rowIndex)))
+			{
+				flags |= ENEMY_HAS_SEEN_PLAYER;
+				m_enemies.SetFlags(e, flags);
+			}
+
+			// Keep walking to the current tile until it is reached, so enemies move between tile centers.
+			if ((flags & ENEMY_HAS_SEEN_PLAYER) && (!m_enemies.HasTarget(e)))
+			{
+				sf::Vector2f target;
+
+				if (m_level.GetFlowStep(position, target))
+				{
+					m_enemies.SetTarget(e, target.x, target.y);
+				}
+				else
+				{
+					// There's no step to take, so stand still.
+					m_enemies.SetVelocity(e, 0.f, 0.f);
+				}
+			}
 		}
 
 		// Check for collision with player.
@@ -563,32 +810,172 @@ void Game::UpdateEnemies(sf::Vector2f playerPosition, float timeDelta)
 			}
 		}
 	}
+
+	// Move every enemy towards its tile in one pass, then pick its strip from the way it walks.
+	m_enemies.Seek(timeDelta);
+	AnimateEnemies(timeDelta);
+}
+
+// Turns every enemy to face the way it walks, and advances its frames.
+void Game::AnimateEnemies(float timeDelta)
+{
+	int stateCount = static_cast<int>(ANIMATION_STATE::COUNT);
+	int firstIdleState = static_cast<int>(ANIMATION_STATE::IDLE_UP);
+	const float* velocitiesX = m_enemies.GetVelocitiesX();
+	const float* velocitiesY = m_enemies.GetVelocitiesY();
+
+	for (int e = 0; e < m_enemies.GetCount(); ++e)
+	{
+		int spriteIndex = m_enemies.GetSpriteIndices()[e];
+		int state = spriteIndex % stateCount;
+		bool wasMoving = (state < firstIdleState);
+		bool isMoving = ((velocitiesX[e] != 0.f) || (velocitiesY[e] != 0.f));
+		int newState;
+
+		if (isMoving)
+		{
+			// Face along the larger component of the velocity.
+			if (std::abs(velocitiesX[e]) > std::abs(velocitiesY[e]))
+			{
+				newState = static_cast<int>((velocitiesX[e] <= 0.f) ? ANIMATION_STATE::WALK_LEFT : ANIMATION_STATE::WALK_RIGHT);
+			}
+			else
+			{
+				newState = static_cast<int>((velocitiesY[e] <= 0.f) ? ANIMATION_STATE::WALK_UP : ANIMATION_STATE::WALK_DOWN);
+			}
+		}
+		else
+		{
+			// Stand idle, facing the way the enemy last walked.
+			newState = wasMoving ? (state + firstIdleState) : state;
+		}
+
+		if (newState != state)
+		{
+			m_enemies.SetSpriteIndex(e, (spriteIndex - state) + newState);
+		}
+
+		// Walking strips play from their first frame. Idle strips are a single frame.
+		if (isMoving != wasMoving)
+		{
+			m_enemies.SetAnimation(e, isMoving ? ENTITY_FRAME_COUNT : 1, isMoving ? ENTITY_FRAMES_PER_SECOND : 0.f);
+		}
+	}
+
+	m_enemies.Animate(timeDelta);
 }
 
 // Updates all projectiles in the level.
 void Game::UpdateProjectiles(float timeDelta)
 {
-	auto projectileIterator = m_playerProjectiles.begin();
-	while (projectileIterator != m_playerProjectiles.end())
+	// Walk backwards, so the last projectile taking a deleted one's index has already been checked.
+	for (int p = m_projectiles.GetCount() - 1; p >= 0; --p)
 	{
-		// Get the projectile object from the iterator.
-		Projectile& projectile = **projectileIterator;
-
 		// Get the tile that the projectile is on.
-		TILE projectileTileType = m_level.GetTile(projectile.GetPosition())->type;
+		TILE projectileTileType = m_level.GetTile(GetProjectilePosition(p)).type;
 
 		// If the tile the projectile is on is not floor, delete it.
 		if ((projectileTileType != TILE::FLOOR) && (projectileTileType != TILE::FLOOR_ALT))
 		{
-			projectileIterator = m_playerProjectiles.erase(projectileIterator);
-		}
-		else
-		{
-			// Update the projectile and move to the next one.
-			projectile.Update(timeDelta);
-			++projectileIterator;
+			m_projectiles.Destroy(m_projectiles.GetHandle(p));
 		}
 	}
+
+	// Move and spin the rest in one pass over their positions.
+	m_projectiles.Integrate(timeDelta);
+}
+
+// Gets the position of the projectile at an index.
+sf::Vector2f Game::GetProjectilePosition(int index) const
+{
+	return sf::Vector2f(m_projectiles.GetPositionsX()[index], m_projectiles.GetPositionsY()[index]);
+}
+
+// Buckets every item, enemy and projectile by position.
+void Game::IndexObjects()
+{
+	sf::Vector2f levelPosition = m_level.GetPosition();
+	sf::Vector2i levelSize = m_level.GetSize();
+
+	m_objectGrid.Reset(levelPosition.x, levelPosition.y, static_cast<float>(levelSize.x * TILE_SIZE), static_cast<float>(levelSize.y * TILE_SIZE));
+
+	// Ids follow the draw order, so items stay under enemies and enemies under projectiles. Each store's ids follow
+	// on from the last, one per index in the store.
+	m_indexedItemCount = m_items.GetCount();
+	m_indexedEnemyCount = m_enemies.GetCount();
+
+	for (int i = 0; i < m_items.GetCount(); ++i)
+	{
+		m_objectGrid.Insert(i, m_items.GetPositionsX()[i], m_items.GetPositionsY()[i]);
+	}
+
+	for (int e = 0; e < m_enemies.GetCount(); ++e)
+	{
+		m_objectGrid.Insert(m_indexedItemCount + e, m_enemies.GetPositionsX()[e], m_enemies.GetPositionsY()[e]);
+	}
+
+	const float* projectilesX = m_projectiles.GetPositionsX();
+	const float* projectilesY = m_projectiles.GetPositionsY();
+	int firstProjectileId = m_indexedItemCount + m_indexedEnemyCount;
+
+	for (int p = 0; p < m_projectiles.GetCount(); ++p)
+	{
+		m_objectGrid.Insert(firstProjectileId + p, projectilesX[p], projectilesY[p]);
+	}
+}
+
+// Draws an item or enemy with the shared entity sprite.
+bool Game::DrawEntity(int textureID, int frameCount, int frame, sf::Vector2f position, const sf::FloatRect& viewArea)
+{
+	// Frames are laid out left to right across the strip.
+	const TextureRegion& region = TextureManager::GetRegion(textureID);
+	int frameWidth = region.rect.width / frameCount;
+
+	m_entitySprite.setTexture(*region.texture);
+	m_entitySprite.setTextureRect(sf::IntRect(region.rect.left + (frameWidth * frame), region.rect.top, frameWidth, region.rect.height));
+	m_entitySprite.setOrigin(frameWidth / 2.f, region.rect.height / 2.f);
+	m_entitySprite.setPosition(position);
+
+	if (!m_entitySprite.getGlobalBounds().intersects(viewArea))
+	{
+		return false;
+	}
+
+	m_window.draw(m_entitySprite);
+	return true;
+}
+
+// Gets the area of the level the main view shows when centred on a point.
+sf::FloatRect Game::GetViewArea(sf::Vector2f center) const
+{
+	const sf::Vector2f& size = m_views[static_cast<int>(VIEW::MAIN)].getSize();
+	return sf::FloatRect(center - (size / 2.f), size);
+}
+
+// Gets where the light grid starts in endless mode.
+sf::Vector2f Game::GetEndlessLightGridOrigin(sf::Vector2f playerPosition) const
+{
+	// Snap the view's corner down to a cell boundary measured from the level's corner, then step out a cell for padding.
+	// The level's corner is taken in whole pixels, as ConstructLightGrid() does, so the origin survives its round trip.
+	sf::FloatRect viewArea = GetViewArea(playerPosition);
+	sf::Vector2f levelPosition(static_cast<float>(static_cast<int>(m_level.GetPosition().x)), static_cast<float>(static_cast<int>(m_level.GetPosition().y)));
+	float cellSize = static_cast<float>(LIGHT_CELL_SIZE);
+
+	float left = levelPosition.x + ((std::floor((viewArea.left - levelPosition.x) / cellSize) - 1.f) * cellSize);
+	float top = levelPosition.y + ((std::floor((viewArea.top - levelPosition.y) / cellSize) - 1.f) * cellSize);
+
+	return sf::Vector2f(left, top);
+}
+
+// Gets the range of light grid cells that cover an area.
+void Game::GetLightCellRange(const sf::FloatRect& area, int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const
+{
+	float cellSize = static_cast<float>(LIGHT_CELL_SIZE);
+
+	firstColumn = std::max(0, static_cast<int>(std::floor((area.left - m_lightGridOrigin.x) / cellSize)));
+	firstRow = std::max(0, static_cast<int>(std::floor((area.top - m_lightGridOrigin.y) / cellSize)));
+	lastColumn = std::min(m_lightGridColumns - 1, static_cast<int>(std::floor((area.left + area.width - m_lightGridOrigin.x) / cellSize)));
+	lastRow = std::min(m_lightGridRows - 1, static_cast<int>(std::floor((area.top + area.height - m_lightGridOrigin.y) / cellSize)));
 }
 
 // Calculates the distance between two given points.
@@ -636,31 +1023,69 @@ void Game::Draw(float timeDelta)
 		// Draw the level.
 		m_level.Draw(m_window, timeDelta);
 
-		// Draw all objects.
-		for (const auto& item : m_items)
-		{
-			item->Draw(m_window, timeDelta);
-		}
+		// Draw the items, enemies and projectiles in view. Objects are bucketed by their centre, so the search is
+		// padded by a tile to catch the ones sticking into the view.
+		sf::FloatRect viewArea = GetViewArea(m_views[static_cast<int>(VIEW::MAIN)].getCenter());
+		m_objectGrid.Query(viewArea.left - TILE_SIZE, viewArea.top - TILE_SIZE, viewArea.left + viewArea.width + TILE_SIZE,
+			viewArea.top + viewArea.height + TILE_SIZE, m_visibleObjects);
 
-		// Draw all enemies.
-		for (const auto& enemy : m_enemies)
-		{
-			enemy->Draw(m_window, timeDelta);
-		}
+		int firstEnemyId = m_indexedItemCount;
+		int firstProjectileId = m_indexedItemCount + m_indexedEnemyCount;
 
-		// Draw all projectiles
-		for (const auto& proj : m_playerProjectiles)
+		for (int id : m_visibleObjects)
 		{
-			m_window.draw(proj->GetSprite());
+			if (id < firstEnemyId)
+			{
+				// Items are drawn from their type's strip. Keys show their name above them.
+				sf::Vector2f position(m_items.GetPositionsX()[id], m_items.GetPositionsY()[id]);
+				ITEM type = static_cast<ITEM>(m_items.GetSpriteIndices()[id]);
+
+				if ((DrawEntity(m_itemTextureIDs[static_cast<int>(type)], ENTITY_FRAME_COUNT, m_items.GetFrames()[id], position, viewArea)) && (type == ITEM::KEY))
+				{
+					sf::FloatRect bounds = m_keyText.getLocalBounds();
+					m_keyText.setPosition(position.x - (bounds.width / 2.f), (position.y - 30.f) - (bounds.height / 2.f));
+					m_window.draw(m_keyText);
+				}
+			}
+			else if (id < firstProjectileId)
+			{
+				// Enemies are drawn from the strip of their type and animation state. Idle strips are a single frame.
+				int index = id - firstEnemyId;
+				int spriteIndex = m_enemies.GetSpriteIndices()[index];
+				bool isWalking = ((spriteIndex % static_cast<int>(ANIMATION_STATE::COUNT)) < static_cast<int>(ANIMATION_STATE::IDLE_UP));
+				sf::Vector2f position(m_enemies.GetPositionsX()[index], m_enemies.GetPositionsY()[index]);
+
+				DrawEntity(m_enemyTextureIDs[spriteIndex], isWalking ? ENTITY_FRAME_COUNT : 1, m_enemies.GetFrames()[index], position, viewArea);
+			}
+			else
+			{
+				// Projectiles share one sprite, moved to each in turn.
+				int index = id - firstProjectileId;
+				m_projectileSprite.setPosition(GetProjectilePosition(index));
+				m_projectileSprite.setRotation(m_projectiles.GetRotations()[index]);
+
+				if (m_projectileSprite.getGlobalBounds().intersects(viewArea))
+				{
+					m_window.draw(m_projectileSprite);
+				}
+			}
 		}
 
 		// Draw the player.
 		m_player.Draw(m_window, timeDelta);
 
-		// Draw level light.
-		for (const sf::Sprite& sprite : m_lightGrid)
+		// Draw the level light in one call. The rows in view are contiguous, so only they are sent.
+		int firstColumn, firstRow, lastColumn, lastRow;
+		GetLightCellRange(viewArea, firstColumn, firstRow, lastColumn, lastRow);
+
+		if ((firstColumn <= lastColumn) && (firstRow <= lastRow))
 		{
-			m_window.draw(sprite);
+			size_t firstVertex = static_cast<size_t>(firstRow) * m_lightGridColumns * 6;
+			size_t vertexCount = static_cast<size_t>(lastRow - firstRow + 1) * m_lightGridColumns * 6;
+			m_window.draw(&m_lightVertices[firstVertex], vertexCount, sf::Triangles);
+
+			// Coloured light is added on top, so it glows out of the darkness.
+			m_window.draw(&m_colorLightVertices[firstVertex], vertexCount, sf::Triangles, sf::BlendAdd);
 		}
 
 		// Switch to UI view.
@@ -747,10 +1172,10 @@ void Game::Draw(float timeDelta)
 		DrawString("Room " + std::to_string(m_level.GetRoomNumber()), sf::Vector2f(70.f, m_screenSize.y - 30.f), 25);
 
 		// Draw health and mana bars.
-		m_healthBarSprite->setTextureRect(sf::IntRect(0, 0, (213.f / m_player.GetMaxHealth()) * m_player.GetHealth(), 8));
+		m_healthBarSprite->setTextureRect(sf::IntRect(m_healthBarRect.left, m_healthBarRect.top, (213.f / m_player.GetMaxHealth()) * m_player.GetHealth(), 8));
 		m_window.draw(*m_healthBarSprite);
 
-		m_manaBarSprite->setTextureRect(sf::IntRect(0, 0, (213.f / m_player.GetMaxMana()) * m_player.GetMana(), 8));
+		m_manaBarSprite->setTextureRect(sf::IntRect(m_manaBarRect.left, m_manaBarRect.top, (213.f / m_player.GetMaxMana()) * m_player.GetMana(), 8));
 		m_window.draw(*m_manaBarSprite);
 	}
 	break;
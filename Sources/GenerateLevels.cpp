@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BatchRunner.h"
+#include "LevelFile.h"
+#include "LevelGenerator.h"
+
+namespace
+{
+	/**
+	 * The header at the start of a corpus file. It is followed by count level file images, one for each seed from
+	 * firstSeed on. Image i starts at sizeof(LevelCorpusHeader) + (i * stride), and is zero padded up to the stride.
+	 * The image of a floor that failed the connectivity check is all zeros.
+	 */
+	struct LevelCorpusHeader {
+		char magic[4];						// Always "PCGC".
+		std::uint32_t version;				// LEVEL_FILE_VERSION of the images.
+		std::uint64_t count;				// The number of levels.
+		std::uint64_t firstSeed;			// The seed of the first level.
+		std::uint64_t stride;				// The distance between two images in bytes. A multiple of 8.
+		std::uint32_t width;				// The number of columns in every level.
+		std::uint32_t height;				// The number of rows in every level.
+		std::uint8_t reserved[24];			// Zero.
+	};
+
+	static_assert(sizeof(LevelCorpusHeader) == 64, "LevelCorpusHeader must not contain padding.");
+
+	// Everything a worker reuses from one floor to the next.
+	struct WorkerState {
+		LevelGenerator generator;			// The worker's generator and its buffers.
+		LevelGrid grid;						// The floor being generated.
+		std::ostringstream image;			// The binary image of the floor.
+		std::ofstream corpus;				// The worker's own handle on the corpus file.
+		std::vector<double> timings;		// The generation time of every floor the worker ran, in microseconds.
+		std::uint64_t rejectedCount;		// The number of floors that failed the connectivity check.
+	};
+
+	// Parses an unsigned number argument, exiting on bad input.
+	std::uint64_t ParseNumber(const char* name, const char* value)
+	{
+		char* end = nullptr;
+		std::uint64_t number = std::strtoull(value, &end, 10);
+
+		if ((end == value) || (*end != '\0'))
+		{
+			std::fprintf(stderr, "invalid value '%s' for %s\n", value, name);
+			std::exit(1);
+		}
+
+		return number;
+	}
+
+	// Gets a percentile of a sorted list of timings.
+	double GetPercentile(const std::vector<double>& sortedTimings, double percentile)
+	{
+		if (sortedTimings.empty())
+		{
+			return 0.0;
+		}
+
+		std::size_t index = static_cast<std::size_t>(percentile * (sortedTimings.size() - 1) + 0.5);
+		return sortedTimings[index];
+	}
+
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --first <seed>      seed of the first floor (default 0)\n"
+			"  --count <n>         number of floors to generate (default 1000)\n"
+			"  --threads <n>       worker threads, 0 for every core (default 0)\n"
+			"  --width <n>         floor width in tiles (default %d)\n"
+			"  --height <n>        floor height in tiles (default %d)\n"
+			"  --corpus <file>     write every floor into one binary corpus file\n"
+			"  --text <directory>  write every floor as a level_<seed>.txt text level\n",
+			program, GRID_WIDTH, GRID_HEIGHT);
+	}
+}
+
+// Generates a range of seeds on every core and reports throughput and latency.
+int main(int argc, char* argv[])
+{
+	std::uint64_t firstSeed = 0;
+	std::uint64_t count = 1000;
+	int threadCount = 0;
+	int width = GRID_WIDTH;
+	int height = GRID_HEIGHT;
+	std::string corpusFileName;
+	std::string textDirectory;
+
+	for (int a = 1; a < argc; ++a)
+	{
+		std::string option = argv[a];
+
+		if ((option == "--help") || (a + 1 >= argc))
+		{
+			PrintUsage(argv[0]);
+			return (option == "--help") ? 0 : 1;
+		}
+
+		const char* value = argv[++a];
+
+		if (option == "--first") firstSeed = ParseNumber("--first", value);
+		else if (option == "--count") count = ParseNumber("--count", value);
+		else if (option == "--threads") threadCount = static_cast<int>(ParseNumber("--threads", value));
+		else if (option == "--width") width = static_cast<int>(ParseNumber("--width", value));
+		else if (option == "--height") height = static_cast<int>(ParseNumber("--height", value));
+		else if (option == "--corpus") corpusFileName = value;
+		else if (option == "--text") textDirectory = value;
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	BatchRunner runner(threadCount);
+	std::vector<WorkerState> workers(runner.GetThreadCount());
+
+	for (WorkerState& worker : workers)
+	{
+		worker.generator = LevelGenerator(width, height);
+		worker.rejectedCount = 0;
+		worker.timings.reserve(static_cast<std::size_t>((count / workers.size()) * 2));
+	}
+
+	width = workers[0].generator.GetWidth();
+	height = workers[0].generator.GetHeight();
+
+	// Every image has the same size, so floors can be written straight to their slot from any thread.
+	std::uint64_t stride = (LevelFile::GetImageSize(width, height, LEVEL_TORCH_COUNT) + 7) & ~7ull;
+
+	if (!corpusFileName.empty())
+	{
+		LevelCorpusHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, "PCGC", 4);
+		header.version = LEVEL_FILE_VERSION;
+		header.count = count;
+		header.firstSeed = firstSeed;
+		header.stride = stride;
+		header.width = static_cast<std::uint32_t>(width);
+		header.height = static_cast<std::uint32_t>(height);
+
+		std::ofstream file(corpusFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)))
+		{
+			std::fprintf(stderr, "failed to create corpus '%s'\n", corpusFileName.c_str());
+			return 1;
+		}
+
+		file.close();
+
+		for (WorkerState& worker : workers)
+		{
+			worker.corpus.open(corpusFileName, std::ios::binary | std::ios::in | std::ios::out);
+		}
+	}
+
+	std::vector<char> padding(static_cast<std::size_t>(stride), 0);
+	std::atomic<bool> hasFailed(false);
+
+	auto start = std::chrono::steady_clock::now();
+
+	runner.Run(count, [&](int workerIndex, std::uint64_t taskIndex)
+	{
+		WorkerState& worker = workers[workerIndex];
+		std::uint64_t seed = firstSeed + taskIndex;
+
+		auto generationStart = std::chrono::steady_clock::now();
+		bool isValid = worker.generator.Generate(seed, worker.grid);
+		auto generationEnd = std::chrono::steady_clock::now();
+
+		worker.timings.push_back(std::chrono::duration<double, std::micro>(generationEnd - generationStart).count());
+
+		// A floor whose entrance can't reach its door is discarded. Its corpus image stays zeroed.
+		if (!isValid)
+		{
+			++worker.rejectedCount;
+			return;
+		}
+
+		if (worker.corpus.is_open())
+		{
+			worker.image.str(std::string());
+			LevelFile::Write(worker.image, worker.grid);
+
+			const std::string& image = worker.image.str();
+			worker.corpus.seekp(static_cast<std::streamoff>(sizeof(LevelCorpusHeader) + (taskIndex * stride)));
+			worker.corpus.write(image.data(), static_cast<std::streamsize>(image.size()));
+			worker.corpus.write(padding.data(), static_cast<std::streamsize>(stride - image.size()));
+
+			if (!worker.corpus)
+			{
+				hasFailed = true;
+			}
+		}
+
+		if (!textDirectory.empty())
+		{
+			if (!worker.grid.SaveToTextFile(textDirectory + "/level_" + std::to_string(seed) + ".txt"))
+			{
+				hasFailed = true;
+			}
+		}
+	});
+
+	auto end = std::chrono::steady_clock::now();
+
+	for (WorkerState& worker : workers)
+	{
+		if (worker.corpus.is_open())
+		{
+			worker.corpus.close();
+			hasFailed = hasFailed || worker.corpus.fail();
+		}
+	}
+
+	// Merge the per-worker timings for the percentiles.
+	std::vector<double> timings;
+	timings.reserve(static_cast<std::size_t>(count));
+
+	for (const WorkerState& worker : workers)
+	{
+		timings.insert(timings.end(), worker.timings.begin(), worker.timings.end());
+	}
+
+	std::uint64_t rejectedCount = 0;
+
+	for (const WorkerState& worker : workers)
+	{
+		rejectedCount += worker.rejectedCount;
+	}
+
+	std::sort(timings.begin(), timings.end());
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	const LevelGrid& sample = workers[0].grid;
+	// The types, the row bitmap and its column copy, and the torches.
+	std::size_t gridBytes = sizeof(LevelGrid) + (static_cast<std::size_t>(width) * height) +
+		(static_cast<std::size_t>(sample.GetWordsPerRow()) * height * sizeof(std::uint64_t)) +
+		(static_cast<std::size_t>(sample.GetWordsPerColumn()) * width * sizeof(std::uint64_t)) + (LEVEL_TORCH_COUNT * sizeof(GridCoord));
+
+	// With no floors there is no last seed, and count - 1 would wrap around.
+	if (count > 0)
+	{
+		std::printf("floors:          %llu (%dx%d, seeds %llu..%llu)\n", static_cast<unsigned long long>(count), width, height,
+			static_cast<unsigned long long>(firstSeed), static_cast<unsigned long long>(firstSeed + count - 1));
+	}
+	else
+	{
+		std::printf("floors:          0 (%dx%d)\n", width, height);
+	}
+
+	std::printf("threads:         %d (%llu steals)\n", runner.GetThreadCount(), static_cast<unsigned long long>(runner.GetStealCount()));
+	std::printf("rejected:        %llu (entrance can't reach the door)\n", static_cast<unsigned long long>(rejectedCount));
+	std::printf("wall time:       %.3f s\n", seconds);
+	std::printf("floors/second:   %.0f\n", (seconds > 0.0) ? (count / seconds) : 0.0);
+	std::printf("generation p50:  %.2f us\n", GetPercentile(timings, 0.50));
+	std::printf("generation p99:  %.2f us\n", GetPercentile(timings, 0.99));
+	std::printf("memory/floor:    %llu bytes in memory, %llu bytes on disk\n", static_cast<unsigned long long>(gridBytes), static_cast<unsigned long long>(stride));
+
+	if (hasFailed)
+	{
+		std::fprintf(stderr, "failed to write some floors\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,666 @@
+#include <algorithm>
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+
+namespace
+{
+	// The neighbour offsets. Straight moves come first, then diagonals.
+	const int COLUMN_OFFSETS[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	const int ROW_OFFSETS[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+	// Runs of open border tiles at least this long get an entrance at each end instead of one in the middle.
+	const int LONG_ENTRANCE_LENGTH = 6;
+}
+
+// Constructor.
+HierarchicalPathfinder::HierarchicalPathfinder(int clusterSize) :
+m_clusterSize((clusterSize < 2) ? 2 : clusterSize),
+m_maxClusterNodes(4 * m_clusterSize),
+m_width(0),
+m_height(0),
+m_clusterColumns(0),
+m_clusterRows(0),
+m_localDistance(static_cast<size_t>(m_clusterSize) * m_clusterSize),
+m_buckets(PATH_DIAGONAL_COST + 1),
+m_start({ -1, -1 }),
+m_goal({ -1, -1 }),
+m_goalCluster(-1),
+m_startToGoalCost(FLOW_UNREACHABLE),
+m_generation(0),
+m_expandedNodeCount(0)
+{
+}
+
+// Builds the abstract graph for a grid.
+void HierarchicalPathfinder::Build(const LevelGrid& grid)
+{
+	m_width = grid.GetWidth();
+	m_height = grid.GetHeight();
+	m_clusterColumns = (m_width + m_clusterSize - 1) / m_clusterSize;
+	m_clusterRows = (m_height + m_clusterSize - 1) / m_clusterSize;
+
+	m_clusters.assign(static_cast<size_t>(m_clusterColumns) * m_clusterRows, Cluster());
+
+	for (int c = 0; c < static_cast<int>(m_clusters.size()); ++c)
+	{
+		BuildCluster(grid, c);
+	}
+
+	for (int c = 0; c < static_cast<int>(m_clusters.size()); ++c)
+	{
+		LinkCluster(c);
+	}
+
+	// Two extra ids for the start and goal of a query.
+	size_t nodeIdCount = (m_clusters.size() * m_maxClusterNodes) + 2;
+
+	m_G.resize(nodeIdCount);
+	m_H.resize(nodeIdCount);
+	m_F.resize(nodeIdCount);
+	m_parent.resize(nodeIdCount);
+	m_stamp.assign(nodeIdCount, 0);
+	m_generation = 0;
+}
+
+// Rebuilds the clusters affected by a change to one tile.
+void HierarchicalPathfinder::OnTileChanged(const LevelGrid& grid, int columnIndex, int rowIndex)
+{
+	if ((grid.GetWidth() != m_width) || (grid.GetHeight() != m_height))
+	{
+		Build(grid);
+		return;
+	}
+
+	if (!grid.TileIsValid(columnIndex, rowIndex))
+	{
+		return;
+	}
+
+	int clusterColumn = columnIndex / m_clusterSize;
+	int clusterRow = rowIndex / m_clusterSize;
+	int columnInCluster = columnIndex % m_clusterSize;
+	int rowInCluster = rowIndex % m_clusterSize;
+	int clusterIndex = (clusterRow * m_clusterColumns) + clusterColumn;
+
+	// A tile on a border also moves the entrances of the cluster across that border.
+	int rebuilt[3] = { clusterIndex, -1, -1 };
+	int rebuiltCount = 1;
+
+	if ((rowInCluster == 0) && (clusterRow > 0))
+	{
+		rebuilt[rebuiltCount++] = clusterIndex - m_clusterColumns;
+	}
+	else if (((rowInCluster == m_clusterSize - 1) || (rowIndex == m_height - 1)) && (clusterRow < m_clusterRows - 1))
+	{
+		rebuilt[rebuiltCount++] = clusterIndex + m_clusterColumns;
+	}
+
+	if ((columnInCluster == 0) && (clusterColumn > 0))
+	{
+		rebuilt[rebuiltCount++] = clusterIndex - 1;
+	}
+	else if (((columnInCluster == m_clusterSize - 1) || (columnIndex == m_width - 1)) && (clusterColumn < m_clusterColumns - 1))
+	{
+		rebuilt[rebuiltCount++] = clusterIndex + 1;
+	}
+
+	for (int b = 0; b < rebuiltCount; ++b)
+	{
+		BuildCluster(grid, rebuilt[b]);
+	}
+
+	// Node indices in the rebuilt clusters may have moved, so relink them and every cluster that links into them.
+	for (int b = 0; b < rebuiltCount; ++b)
+	{
+		int column = rebuilt[b] % m_clusterColumns;
+		int row = rebuilt[b] / m_clusterColumns;
+
+		LinkCluster(rebuilt[b]);
+
+		for (int d = 0; d < 4; ++d)
+		{
+			int neighbourColumn = column + COLUMN_OFFSETS[d];
+			int neighbourRow = row + ROW_OFFSETS[d];
+
+			if ((neighbourColumn >= 0) && (neighbourColumn < m_clusterColumns) && (neighbourRow >= 0) && (neighbourRow < m_clusterRows))
+			{
+				LinkCluster((neighbourRow * m_clusterColumns) + neighbourColumn);
+			}
+		}
+	}
+}
+
+// Finds the waypoints of a path through the abstract graph.
+bool HierarchicalPathfinder::FindAbstractPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& waypoints)
+{
+	waypoints.clear();
+	m_expandedNodeCount = 0;
+
+	if ((!grid.TileIsValid(start.x, start.y)) || (!grid.TileIsValid(goal.x, goal.y)) || (grid.IsSolid(start.x, start.y)) || (grid.IsSolid(goal.x, goal.y)))
+	{
+		return false;
+	}
+
+	if (start == goal)
+	{
+		return true;
+	}
+
+	if ((grid.GetWidth() != m_width) || (grid.GetHeight() != m_height))
+	{
+		Build(grid);
+	}
+
+	int startCluster = GetClusterIndex(start);
+	int startId = static_cast<int>(m_clusters.size()) * m_maxClusterNodes;
+	int goalId = startId + 1;
+
+	m_start = start;
+	m_goal = goal;
+	m_goalCluster = GetClusterIndex(goal);
+
+	// Link the goal and the start to the entrances of their clusters.
+	const std::vector<GridCoord>& goalNodes = m_clusters[m_goalCluster].nodes;
+	SearchCluster(grid, m_goalCluster, goal);
+	m_goalCosts.resize(goalNodes.size());
+
+	for (size_t n = 0; n < goalNodes.size(); ++n)
+	{
+		m_goalCosts[n] = GetLocalDistance(m_goalCluster, goalNodes[n]);
+	}
+
+	const std::vector<GridCoord>& startNodes = m_clusters[startCluster].nodes;
+	SearchCluster(grid, startCluster, start);
+	m_startCosts.resize(startNodes.size());
+
+	for (size_t n = 0; n < startNodes.size(); ++n)
+	{
+		m_startCosts[n] = GetLocalDistance(startCluster, startNodes[n]);
+	}
+
+	m_startToGoalCost = (startCluster == m_goalCluster) ? GetLocalDistance(startCluster, goal) : FLOW_UNREACHABLE;
+
+	NextGeneration();
+
+	std::uint32_t closedStamp = m_generation + 1;
+
+	m_G[startId] = 0;
+	m_H[startId] = Pathfinder::GetHeuristic(start, goal);
+	m_F[startId] = m_H[startId];
+	m_parent[startId] = -1;
+	m_stamp[startId] = m_generation;
+
+	m_open.clear();
+	m_open.push_back({ m_F[startId], startId });
+
+	while (!m_open.empty())
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+		OpenNode current = m_open.back();
+		m_open.pop_back();
+
+		// Skip entries that were superseded by a cheaper route, or whose node is already closed.
+		if ((m_stamp[current.node] == closedStamp) || (current.F != m_F[current.node]))
+		{
+			continue;
+		}
+
+		m_stamp[current.node] = closedStamp;
+		++m_expandedNodeCount;
+
+		if (current.node == goalId)
+		{
+			for (int node = goalId; node != startId; node = m_parent[node])
+			{
+				waypoints.push_back(GetNodeTile(node));
+			}
+
+			std::reverse(waypoints.begin(), waypoints.end());
+			return true;
+		}
+
+		int cost = m_G[current.node];
+
+		if (current.node == startId)
+		{
+			for (size_t n = 0; n < m_startCosts.size(); ++n)
+			{
+				if (m_startCosts[n] != FLOW_UNREACHABLE)
+				{
+					Relax((startCluster * m_maxClusterNodes) + static_cast<int>(n), startId, m_startCosts[n]);
+				}
+			}
+
+			if (m_startToGoalCost != FLOW_UNREACHABLE)
+			{
+				Relax(goalId, startId, m_startToGoalCost);
+			}
+
+			continue;
+		}
+
+		int clusterIndex = current.node / m_maxClusterNodes;
+		int nodeIndex = current.node % m_maxClusterNodes;
+		const Cluster& cluster = m_clusters[clusterIndex];
+		int nodeCount = static_cast<int>(cluster.nodes.size());
+
+		// Edges to the other entrances of the same cluster.
+		for (int n = 0; n < nodeCount; ++n)
+		{
+			int edgeCost = cluster.costs[(nodeIndex * nodeCount) + n];
+
+			if ((n != nodeIndex) && (edgeCost != FLOW_UNREACHABLE))
+			{
+				Relax((clusterIndex * m_maxClusterNodes) + n, current.node, cost + edgeCost);
+			}
+		}
+
+		// Edges across the border to the entrances of the neighbouring clusters.
+		for (int l = 0; l < 2; ++l)
+		{
+			int link = cluster.links[(nodeIndex * 2) + l];
+
+			if (link >= 0)
+			{
+				Relax(link, current.node, cost + PATH_STRAIGHT_COST);
+			}
+		}
+
+		if ((clusterIndex == m_goalCluster) && (m_goalCosts[nodeIndex] != FLOW_UNREACHABLE))
+		{
+			Relax(goalId, current.node, cost + m_goalCosts[nodeIndex]);
+		}
+	}
+
+	return false;
+}
+
+// Refines the tile path between two consecutive waypoints.
+bool HierarchicalPathfinder::RefineSegment(const LevelGrid& grid, GridCoord from, GridCoord to, std::vector<GridCoord>& path)
+{
+	// Waypoints are at most a cluster apart, so the search stays small.
+	return m_pathfinder.FindPath(grid, from, to, path);
+}
+
+// Finds the waypoints of a path, but only refines the tiles up to the first one.
+bool HierarchicalPathfinder::FindFirstSegment(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path)
+{
+	path.clear();
+
+	if (!FindAbstractPath(grid, start, goal, m_waypoints))
+	{
+		return false;
+	}
+
+	// A start on the goal has no waypoints, and no tiles to walk.
+	return (m_waypoints.empty()) || (RefineSegment(grid, start, m_waypoints.front(), path));
+}
+
+// Gets the waypoints found by the last search.
+const std::vector<GridCoord>& HierarchicalPathfinder::GetWaypoints() const
+{
+	return m_waypoints;
+}
+
+// Finds a full tile path, refining every segment of the abstract path.
+bool HierarchicalPathfinder::FindPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path)
+{
+	path.clear();
+
+	if (!FindAbstractPath(grid, start, goal, m_waypoints))
+	{
+		return false;
+	}
+
+	GridCoord from = start;
+
+	for (const GridCoord& waypoint : m_waypoints)
+	{
+		if (!RefineSegment(grid, from, waypoint, m_segment))
+		{
+			path.clear();
+			return false;
+		}
+
+		path.insert(path.end(), m_segment.begin(), m_segment.end());
+		from = waypoint;
+	}
+
+	return true;
+}
+
+// Gets the number of entrance nodes in the abstract graph.
+int HierarchicalPathfinder::GetNodeCount() const
+{
+	int nodeCount = 0;
+
+	for (const Cluster& cluster : m_clusters)
+	{
+		nodeCount += static_cast<int>(cluster.nodes.size());
+	}
+
+	return nodeCount;
+}
+
+// Gets the number of abstract nodes the last search expanded.
+int HierarchicalPathfinder::GetExpandedNodeCount() const
+{
+	return m_expandedNodeCount;
+}
+
+// Finds the entrance nodes of a cluster and the costs between them.
+void HierarchicalPathfinder::BuildCluster(const LevelGrid& grid, int clusterIndex)
+{
+	Cluster& cluster = m_clusters[clusterIndex];
+	cluster.nodes.clear();
+
+	for (int side = 0; side < 4; ++side)
+	{
+		AddSideEntrances(grid, clusterIndex, side, cluster.nodes);
+	}
+
+	int nodeCount = static_cast<int>(cluster.nodes.size());
+	cluster.costs.assign(static_cast<size_t>(nodeCount) * nodeCount, FLOW_UNREACHABLE);
+
+	// Paths are symmetric, so one search per node fills its row and column.
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		SearchCluster(grid, clusterIndex, cluster.nodes[i]);
+
+		for (int j = i; j < nodeCount; ++j)
+		{
+			int cost = GetLocalDistance(clusterIndex, cluster.nodes[j]);
+			cluster.costs[(i * nodeCount) + j] = cost;
+			cluster.costs[(j * nodeCount) + i] = cost;
+		}
+	}
+}
+
+// Adds the entrance nodes along one side of a cluster.
+void HierarchicalPathfinder::AddSideEntrances(const LevelGrid& grid, int clusterIndex, int side, std::vector<GridCoord>& nodes) const
+{
+	int left = (clusterIndex % m_clusterColumns) * m_clusterSize;
+	int top = (clusterIndex / m_clusterColumns) * m_clusterSize;
+	int right = std::min(left + m_clusterSize, m_width) - 1;
+	int bottom = std::min(top + m_clusterSize, m_height) - 1;
+
+	// The first tile of the side, the step along it, and the step across the border.
+	GridCoord first;
+	GridCoord along;
+	GridCoord across;
+	int length;
+
+	switch (side)
+	{
+	case 0:
+		first = { left, top };
+		along = { 1, 0 };
+		across = { 0, -1 };
+		length = right - left + 1;
+		break;
+
+	case 1:
+		first = { right, top };
+		along = { 0, 1 };
+		across = { 1, 0 };
+		length = bottom - top + 1;
+		break;
+
+	case 2:
+		first = { left, bottom };
+		along = { 1, 0 };
+		across = { 0, 1 };
+		length = right - left + 1;
+		break;
+
+	default:
+		first = { left, top };
+		along = { 0, 1 };
+		across = { -1, 0 };
+		length = bottom - top + 1;
+		break;
+	}
+
+	if (!grid.TileIsValid(first.x + across.x, first.y + across.y))
+	{
+		return;
+	}
+
+	// Walk one past the end so the last run is closed off.
+	int runStart = -1;
+
+	for (int t = 0; t <= length; ++t)
+	{
+		GridCoord tile = { first.x + (along.x * t), first.y + (along.y * t) };
+		bool isOpen = (t < length) && (!grid.IsSolid(tile.x, tile.y)) && (!grid.IsSolid(tile.x + across.x, tile.y + across.y));
+
+		if (isOpen)
+		{
+			if (runStart < 0)
+			{
+				runStart = t;
+			}
+
+			continue;
+		}
+
+		if (runStart < 0)
+		{
+			continue;
+		}
+
+		int runEnd = t - 1;
+		int entrances[2] = { (runStart + runEnd) / 2, -1 };
+
+		if (runEnd - runStart + 1 >= LONG_ENTRANCE_LENGTH)
+		{
+			entrances[0] = runStart;
+			entrances[1] = runEnd;
+		}
+
+		for (int e = 0; (e < 2) && (entrances[e] >= 0); ++e)
+		{
+			GridCoord node = { first.x + (along.x * entrances[e]), first.y + (along.y * entrances[e]) };
+
+			// Corner tiles can be an entrance on two sides; keep one node for them.
+			if ((std::find(nodes.begin(), nodes.end(), node) == nodes.end()) && (static_cast<int>(nodes.size()) < m_maxClusterNodes))
+			{
+				nodes.push_back(node);
+			}
+		}
+
+		runStart = -1;
+	}
+}
+
+// Finds the nodes across the border from every node of a cluster.
+void HierarchicalPathfinder::LinkCluster(int clusterIndex)
+{
+	Cluster& cluster = m_clusters[clusterIndex];
+	cluster.links.assign(cluster.nodes.size() * 2, -1);
+
+	for (size_t n = 0; n < cluster.nodes.size(); ++n)
+	{
+		int linkCount = 0;
+
+		for (int d = 0; (d < 4) && (linkCount < 2); ++d)
+		{
+			GridCoord neighbour = { cluster.nodes[n].x + COLUMN_OFFSETS[d], cluster.nodes[n].y + ROW_OFFSETS[d] };
+
+			if ((neighbour.x < 0) || (neighbour.x >= m_width) || (neighbour.y < 0) || (neighbour.y >= m_height))
+			{
+				continue;
+			}
+
+			int neighbourCluster = GetClusterIndex(neighbour);
+
+			if (neighbourCluster == clusterIndex)
+			{
+				continue;
+			}
+
+			// Entrances are placed the same way from both sides of a border, so the tile across holds a node too.
+			int neighbourNode = FindNode(neighbourCluster, neighbour);
+
+			if (neighbourNode >= 0)
+			{
+				cluster.links[(n * 2) + linkCount++] = (neighbourCluster * m_maxClusterNodes) + neighbourNode;
+			}
+		}
+	}
+}
+
+// Finds the cost from a tile to every tile of its cluster, without leaving the cluster.
+void HierarchicalPathfinder::SearchCluster(const LevelGrid& grid, int clusterIndex, GridCoord from)
+{
+	int left = (clusterIndex % m_clusterColumns) * m_clusterSize;
+	int top = (clusterIndex / m_clusterColumns) * m_clusterSize;
+	int right = std::min(left + m_clusterSize, m_width);
+	int bottom = std::min(top + m_clusterSize, m_height);
+
+	std::fill(m_localDistance.begin(), m_localDistance.end(), FLOW_UNREACHABLE);
+
+	// The same bucket queue as FlowField, over the tiles of one cluster.
+	int bucketCount = static_cast<int>(m_buckets.size());
+	int fromNode = ((from.y - top) * m_clusterSize) + (from.x - left);
+
+	m_localDistance[fromNode] = 0;
+	m_buckets[0].push_back(fromNode);
+	int pending = 1;
+
+	for (int cost = 0; pending > 0; ++cost)
+	{
+		std::vector<int>& bucket = m_buckets[cost % bucketCount];
+
+		for (size_t b = 0; b < bucket.size(); ++b)
+		{
+			int node = bucket[b];
+			--pending;
+
+			if (m_localDistance[node] != cost)
+			{
+				continue;
+			}
+
+			int column = left + (node % m_clusterSize);
+			int row = top + (node / m_clusterSize);
+
+			for (int n = 0; n < 8; ++n)
+			{
+				int nextColumn = column + COLUMN_OFFSETS[n];
+				int nextRow = row + ROW_OFFSETS[n];
+
+				if ((nextColumn < left) || (nextColumn >= right) || (nextRow < top) || (nextRow >= bottom) || (grid.IsSolid(nextColumn, nextRow)))
+				{
+					continue;
+				}
+
+				bool isDiagonal = (n >= 4);
+
+				if ((isDiagonal) && ((grid.IsSolid(nextColumn, row)) || (grid.IsSolid(column, nextRow))))
+				{
+					continue;
+				}
+
+				int next = ((nextRow - top) * m_clusterSize) + (nextColumn - left);
+				int nextCost = cost + (isDiagonal ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST);
+
+				if (nextCost < m_localDistance[next])
+				{
+					m_localDistance[next] = nextCost;
+					m_buckets[nextCost % bucketCount].push_back(next);
+					++pending;
+				}
+			}
+		}
+
+		bucket.clear();
+	}
+}
+
+// Gets the cost to a tile found by the last cluster search.
+int HierarchicalPathfinder::GetLocalDistance(int clusterIndex, GridCoord tile) const
+{
+	int left = (clusterIndex % m_clusterColumns) * m_clusterSize;
+	int top = (clusterIndex / m_clusterColumns) * m_clusterSize;
+
+	return m_localDistance[((tile.y - top) * m_clusterSize) + (tile.x - left)];
+}
+
+// Gets the cluster a tile is in.
+int HierarchicalPathfinder::GetClusterIndex(GridCoord tile) const
+{
+	return ((tile.y / m_clusterSize) * m_clusterColumns) + (tile.x / m_clusterSize);
+}
+
+// Finds the entrance node on a tile.
+int HierarchicalPathfinder::FindNode(int clusterIndex, GridCoord tile) const
+{
+	const std::vector<GridCoord>& nodes = m_clusters[clusterIndex].nodes;
+
+	for (size_t n = 0; n < nodes.size(); ++n)
+	{
+		if (nodes[n] == tile)
+		{
+			return static_cast<int>(n);
+		}
+	}
+
+	return -1;
+}
+
+// Gets the tile of an abstract node.
+GridCoord HierarchicalPathfinder::GetNodeTile(int node) const
+{
+	int startId = static_cast<int>(m_clusters.size()) * m_maxClusterNodes;
+
+	if (node == startId)
+	{
+		return m_start;
+	}
+
+	if (node == startId + 1)
+	{
+		return m_goal;
+	}
+
+	return m_clusters[node / m_maxClusterNodes].nodes[node % m_maxClusterNodes];
+}
+
+// Updates a node's cost and queues it if the new route is cheaper.
+void HierarchicalPathfinder::Relax(int node, int parent, int cost)
+{
+	if (m_stamp[node] == m_generation + 1)
+	{
+		return;
+	}
+
+	if ((m_stamp[node] != m_generation) || (cost < m_G[node]))
+	{
+		if (m_stamp[node] != m_generation)
+		{
+			m_H[node] = Pathfinder::GetHeuristic(GetNodeTile(node), m_goal);
+			m_stamp[node] = m_generation;
+		}
+
+		m_G[node] = cost;
+		m_F[node] = cost + m_H[node];
+		m_parent[node] = parent;
+
+		m_open.push_back({ m_F[node], node });
+		std::push_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+	}
+}
+
+// Starts a new abstract search generation.
+void HierarchicalPathfinder::NextGeneration()
+{
+	// Each search uses two stamps. When they run out, clear the stamps once and start again.
+	if (m_generation >= 0xFFFFFFFDu)
+	{
+		std::fill(m_stamp.begin(), m_stamp.end(), 0);
+		m_generation = 0;
+	}
+
+	m_generation += 2;
+}
@@ -1,18 +1,40 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include "PCH.h"
 #include "Level.h"
 
 // Default constructor.
-Level::Level()
+Level::Level() :
+m_tileSprites(static_cast<int>(TILE::COUNT)),
+m_tileLayer(TILE_SIZE),
+m_screenSize({ 0, 0 }),
+m_origin({ 0, 0 }),
+m_floorSeed(0),
+m_floorNumber(1),
+m_roomNumber(0)
+{
+	std::fill(&m_roomLayout[0][0], &m_roomLayout[0][0] + (FLOOR_LAYOUT_ROWS * FLOOR_LAYOUT_COLUMNS), FLOOR_NO_ROOM);
+}
+
+// Constructor.
+Level::Level(sf::RenderWindow& window) :
+Level(window.getSize())
 {
 }
 
 // Constructor.
-Level::Level(sf::RenderWindow& window) : 
+Level::Level(sf::Vector2u screenSize) :
+m_tileSprites(static_cast<int>(TILE::COUNT)),
+m_tileLayer(TILE_SIZE),
+m_screenSize(screenSize),
 m_origin({ 0, 0 }),
+m_floorSeed(0),
 m_floorNumber(1),
-m_roomNumber(0),
-m_doorTileIndices({ 0, 0 })
+m_roomNumber(0)
 {
+	std::fill(&m_roomLayout[0][0], &m_roomLayout[0][0] + (FLOOR_LAYOUT_ROWS * FLOOR_LAYOUT_COLUMNS), FLOOR_NO_ROOM);
+
 	// Load all tiles.
 	AddTile("Resources/tiles/spr_tile_floor.png", TILE::FLOOR);
 
@@ -41,22 +63,23 @@ m_doorTileIndices({ 0, 0 })
 	AddTile("Resources/tiles/spr_tile_door_unlocked.png", TILE::WALL_DOOR_UNLOCKED);
 
 	// Calculate the top left of the grid.
-	m_origin.x = (window.getSize().x - (GRID_WIDTH * TILE_SIZE));
+	CalculateOrigin();
+}
+
+// Centers the level grid in the screen area.
+void Level::CalculateOrigin()
+{
+	m_origin.x = (static_cast<int>(m_screenSize.x) - (m_grid.GetWidth() * TILE_SIZE));
 	m_origin.x /= 2;
 
-	m_origin.y = (window.getSize().y - (GRID_HEIGHT * TILE_SIZE));
+	m_origin.y = (static_cast<int>(m_screenSize.y) - (m_grid.GetHeight() * TILE_SIZE));
 	m_origin.y /= 2;
+}
 
-	// Store the column and row information for each node.
-	for (int i = 0; i < GRID_WIDTH; i++)
-	{
-		for (int j = 0; j < GRID_HEIGHT; j++)
-		{
-			auto cell = &m_grid[i][j];
-			cell->columnIndex = i;
-			cell->rowIndex = j;
-		}
-	}
+// Gets the headless tile grid of the level.
+const LevelGrid& Level::GetGrid() const
+{
+	return m_grid;
 }
 
 // Create and adds a tile sprite to the list of those available.
@@ -72,6 +95,10 @@ int Level::AddTile(std::string fileName, TILE tileType)
 	else
 	{
 		m_textureIDs[static_cast<int>(tileType)] = textureID;
+		// Tiles share the atlas page, so the tile layer draws them all in one call.
+		const TextureRegion& region = TextureManager::GetRegion(textureID);
+		TextureManager::SetSpriteRegion(m_tileSprites[static_cast<int>(tileType)], textureID);
+		m_tileLayer.SetTileTexture(tileType, *region.texture, region.rect);
 	}
 
 	// Return the ID of the tile.
@@ -81,14 +108,12 @@ int Level::AddTile(std::string fileName, TILE tileType)
 // Checks if a given tile is passable
 bool Level::IsSolid(int i, int j)
 {
-	// Check that the tile is valid
-	if (TileIsValid(i, j))
+	if (m_world)
 	{
-		int tileIndex = static_cast<int>(m_grid[i][j].type);
-		return (((tileIndex != static_cast<int>(TILE::FLOOR)) && (tileIndex != static_cast<int>(TILE::FLOOR_ALT))) && (tileIndex != static_cast<int>(TILE::WALL_DOOR_UNLOCKED)));
+		return m_world->IsSolid(i, j);
 	}
-	else
-		return false;
+
+	return m_grid.IsSolid(i, j);
 }
 
 // Returns the position of the level relative to the application window.
@@ -100,34 +125,78 @@ sf::Vector2f Level::GetPosition() const
 // Returns the id of the given tile in the 2D level array.
 TILE Level::GetTileType(int columnIndex, int rowIndex) const
 {
-	// Check that the parameters are valid.
-	if ((columnIndex >= GRID_WIDTH) || (rowIndex >= GRID_HEIGHT))
+	if (m_world)
 	{
-		return TILE::EMPTY; // failed
+		return m_world->GetTileType(columnIndex, rowIndex);
 	}
 
-	// Fetch the id.
-	return m_grid[columnIndex][rowIndex].type;
+	return m_grid.GetTileType(columnIndex, rowIndex);
 }
 
 // Sets the id of the given tile in the grid.
 void Level::SetTile(int columnIndex, int rowIndex, TILE tileType)
 {
-	// Check that the provided tile index is valid.
-	if ((columnIndex >= GRID_WIDTH) || (rowIndex >= GRID_HEIGHT))
+	// Check that the provided tile index and type are valid.
+	if ((!TileIsValid(columnIndex, rowIndex)) || (tileType >= TILE::COUNT))
 	{
 		return;
 	}
 
-	// check that the sprite index is valid
-	if (tileType >= TILE::COUNT)
+	// Record the tile and the walls around it that may be re-tiled, so derived data can be rebuilt for just that area.
+	bool solidityChanged = (LevelGrid::IsSolidType(GetTileType(columnIndex, rowIndex)) != LevelGrid::IsSolidType(tileType));
+	m_changes.Record(columnIndex - 1, rowIndex - 1, columnIndex + 1, rowIndex + 1, solidityChanged);
+
+	if (m_world)
 	{
+		m_world->SetTileType(columnIndex, rowIndex, tileType);
+
+		// Re-tile the walls around the changed tile so they still join up.
+		for (int j = rowIndex - 1; j <= rowIndex + 1; ++j)
+		{
+			for (int i = columnIndex - 1; i <= columnIndex + 1; ++i)
+			{
+				if (m_world->GetTileType(i, j) <= TILE::WALL_INTERSECTION)
+				{
+					int mask = (LevelGrid::JoinsWalls(m_world->GetTileType(i, j - 1)) ? 1 : 0) |
+						(LevelGrid::JoinsWalls(m_world->GetTileType(i + 1, j)) ? 2 : 0) |
+						(LevelGrid::JoinsWalls(m_world->GetTileType(i, j + 1)) ? 4 : 0) |
+						(LevelGrid::JoinsWalls(m_world->GetTileType(i - 1, j)) ? 8 : 0);
+
+					m_world->SetTileType(i, j, LevelGrid::GetWallVariant(mask));
+				}
+			}
+		}
+
 		return;
 	}
 
-	// change that tiles sprite to the new index
-	m_grid[columnIndex][rowIndex].type = tileType;
-	m_grid[columnIndex][rowIndex].sprite.setTexture(TextureManager::GetTexture(m_textureIDs[static_cast<int>(tileType)]));
+	// Paths through the tile change if it becomes passable or blocked.
+	if (solidityChanged)
+	{
+		m_flowField.Invalidate();
+		m_pathCache.OnTileChanged(columnIndex, rowIndex);
+		m_nextHops.Invalidate();
+		m_pathRequests.OnGridChanged();
+	}
+
+	// Change the tile type. The sprite is picked from the type when drawing.
+	m_grid.SetTileType(columnIndex, rowIndex, tileType);
+
+	// Only the clusters around the tile need their entrances rebuilt.
+	if ((solidityChanged) && (UsesHierarchicalPaths()))
+	{
+		m_hierarchicalPathfinder.OnTileChanged(m_grid, columnIndex, rowIndex);
+	}
+
+	// Re-tile the walls around the changed tile so they still join up.
+	m_grid.AutotileRegion(columnIndex - 1, rowIndex - 1, columnIndex + 1, rowIndex + 1);
+}
+
+// Assigns the correct wall variant to every wall tile in the level.
+void Level::Autotile()
+{
+	m_grid.Autotile();
+	m_changes.Record(0, 0, m_grid.GetWidth() - 1, m_grid.GetHeight() - 1, false);
 }
 
 // Gets the current floor number.
@@ -145,149 +214,372 @@ int Level::GetRoomNumber() const
 // Checks if a given tile is valid.
 bool Level::TileIsValid(int column, int row)
 {
-	bool validColumn, validRow;
-
-	validColumn = ((column >= 0) && (column < GRID_WIDTH));
-	validRow = ((row >= 0) && (row < GRID_HEIGHT));
+	// The endless world has no edges.
+	if (m_world)
+	{
+		return true;
+	}
 
-	return (validColumn && validRow);
+	return m_grid.TileIsValid(column, row);
 }
 
 // Gets the size of the level in terms of tiles.
 sf::Vector2i Level::GetSize() const
 {
-	return sf::Vector2i(GRID_WIDTH, GRID_HEIGHT);
+	return sf::Vector2i(m_grid.GetWidth(), m_grid.GetHeight());
 }
 
 // Gets the tile that the position lies on.
-Tile* Level::GetTile(sf::Vector2f position)
+Tile Level::GetTile(sf::Vector2f position) const
 {
 	// Convert the position to relative to the level grid.
 	position.x -= m_origin.x;
 	position.y -= m_origin.y;
 
-	// Convert to a tile position.
+	// Convert to a tile position. Flooring keeps positions left of or above the grid off it.
 	int tileColumn, tileRow;
 
-	tileColumn = static_cast<int>(position.x) / TILE_SIZE;
-	tileRow = static_cast<int>(position.y) / TILE_SIZE;
+	tileColumn = static_cast<int>(std::floor(position.x / TILE_SIZE));
+	tileRow = static_cast<int>(std::floor(position.y / TILE_SIZE));
+
+	return GetTile(tileColumn, tileRow);
+}
 
-	return &m_grid[tileColumn][tileRow];
+// Gets the position of the center of a tile.
+sf::Vector2f Level::GetActualTileLocation(int columnIndex, int rowIndex) const
+{
+	return sf::Vector2f(static_cast<float>(m_origin.x + (columnIndex * TILE_SIZE) + (TILE_SIZE / 2)), static_cast<float>(m_origin.y + (rowIndex * TILE_SIZE) + (TILE_SIZE / 2)));
 }
 
-// Returns a pointer to the tile at the given index.
-Tile* Level::GetTile(int columnIndex, int rowIndex)
+// Finds a path between two positions in the level.
+bool Level::FindPath(sf::Vector2f from, sf::Vector2f to, std::vector<sf::Vector2f>& path)
 {
-	if (TileIsValid(columnIndex, rowIndex))
+	path.clear();
+
+	// Paths are searched on the fixed level grid only.
+	if (m_world)
 	{
-		return &m_grid[columnIndex][rowIndex];
+		return false;
 	}
-	else
+
+	Tile startTile = GetTile(from);
+	Tile goalTile = GetTile(to);
+	GridCoord start = { startTile.columnIndex, startTile.rowIndex };
+	GridCoord goal = { goalTile.columnIndex, goalTile.rowIndex };
+
+	// Small levels are answered from the next-hop table. While it is being rebuilt after a tile changed, paths are
+	// searched and cached as on larger levels.
+	if (m_nextHops.IsReady())
 	{
-		return nullptr;
+		if (!m_nextHops.FindPath(start, goal, m_pathTiles))
+		{
+			return false;
+		}
 	}
+	else if (UsesHierarchicalPaths())
+	{
+		// Only the leg to the first waypoint is refined. It isn't the whole path, so it isn't cached either.
+		if (!m_hierarchicalPathfinder.FindFirstSegment(m_grid, start, goal, m_pathTiles))
+		{
+			return false;
+		}
+	}
+	else if (!m_pathCache.Lookup(start, goal, m_pathTiles))
+	{
+		auto searchStart = std::chrono::steady_clock::now();
+
+		if (!m_pathfinder.FindJumpPointPath(m_grid, start, goal, m_pathTiles))
+		{
+			return false;
+		}
+
+		auto searchEnd = std::chrono::steady_clock::now();
+		m_pathCache.Store(start, goal, m_pathTiles, std::chrono::duration<double, std::micro>(searchEnd - searchStart).count());
+	}
+
+	for (const GridCoord& tile : m_pathTiles)
+	{
+		path.push_back(GetActualTileLocation(tile.x, tile.y));
+	}
+
+	return true;
 }
 
-// Loads a level from a .txt file.
-bool Level::LoadLevelFromFile(std::string fileName)
+// Gets the cache of path results.
+const PathCache& Level::GetPathCache() const
+{
+	return m_pathCache;
+}
+
+// Gets the journal of changed tiles.
+const ChangeJournal& Level::GetChangeJournal() const
 {
-	// Create all the fields we need.
-	std::ifstream file(fileName);
+	return m_changes;
+}
+
+// Checks if the level is large enough to be searched with hierarchical A*.
+bool Level::UsesHierarchicalPaths() const
+{
+	return (m_grid.GetWidth() * m_grid.GetHeight()) >= HIERARCHICAL_PATH_MIN_TILES;
+}
 
-	// Read level data into 2D int array that describes the level.
-	if (file.is_open())
+// Rebuilds the flow field towards the player if needed.
+void Level::UpdateFlowField(sf::Vector2f playerPosition)
+{
+	// The field is only kept for the fixed level grid.
+	if (m_world)
 	{
-		for (int j = 0; j < GRID_HEIGHT; ++j)
-		{
-			for (int i = 0; i < GRID_WIDTH; ++i)
-			{
-				// Get the cell that we're working on.
-				auto& cell = m_grid[i][j];
+		return;
+	}
+
+	Tile playerTile = GetTile(playerPosition);
+	m_flowField.Update(m_grid, { playerTile.columnIndex, playerTile.rowIndex });
+}
 
-				// Read the character. Out of 4 characters we only want 2nd and 3rd.
-				std::string input;
+// Gets the next step towards the player from a position.
+bool Level::GetFlowStep(sf::Vector2f position, sf::Vector2f& target) const
+{
+	Tile tile = GetTile(position);
+	GridCoord next;
+
+	if ((m_world) || (!m_flowField.GetNextStep(tile.columnIndex, tile.rowIndex, next)))
+	{
+		return false;
+	}
 
-				file.get();
-				input += file.get();
-				input += file.get();
-				file.get();
+	target = GetActualTileLocation(next.x, next.y);
+	return true;
+}
 
-				// Convert string to int.
-				std::stringstream convert(input);
-				int tileID;
-				convert >> tileID;
+// Finds the tiles that can be seen from a position.
+bool Level::ComputeFieldOfView(sf::Vector2f position, int radius, FieldOfView& view) const
+{
+	if (m_world)
+	{
+		view.Clear();
+		return false;
+	}
 
-				// Set type, sprite and position.
-				cell.type = static_cast<TILE>(tileID);
-				cell.sprite.setTexture(TextureManager::GetTexture(m_textureIDs[tileID]));
-				cell.sprite.setPosition(m_origin.x + (TILE_SIZE * i), m_origin.y + (TILE_SIZE * j));
+	Tile tile = GetTile(position);
+	view.Compute(m_grid, { tile.columnIndex, tile.rowIndex }, radius);
+	return true;
+}
 
-				// Check for entry/exit nodes.
-				if (cell.type == TILE::WALL_DOOR_LOCKED)
-				{
-					// Save the location of the exit door.
-					m_doorTileIndices = sf::Vector2i(i, 0);
-				}
-			}
+// Submits a path request that is solved over the coming frames.
+PathTicket Level::RequestPath(sf::Vector2f from, sf::Vector2f to, sf::Vector2f playerPosition)
+{
+	Tile start = GetTile(from);
+	Tile goal = GetTile(to);
+	Tile playerTile = GetTile(playerPosition);
 
-			// Read end line char.
-			file.get();
-		}
+	// Whatever is nearest the player matters most, so the distance from the start to the player, in tiles, is the priority.
+	float columnDistance = static_cast<float>(start.columnIndex - playerTile.columnIndex);
+	float rowDistance = static_cast<float>(start.rowIndex - playerTile.rowIndex);
+	float priority = std::sqrt((columnDistance * columnDistance) + (rowDistance * rowDistance));
 
-		file.close(); //closing the file
+	return m_pathRequests.Submit({ start.columnIndex, start.rowIndex }, { goal.columnIndex, goal.rowIndex }, priority);
+}
 
-		// Create torches at specific locations.
-		sf::Vector2i locations[5];
+// Gets the state of a path request.
+PATH_REQUEST_STATUS Level::GetPathRequestStatus(PathTicket ticket) const
+{
+	return m_pathRequests.GetStatus(ticket);
+}
 
-		locations[0] = { m_origin.x + (3 * TILE_SIZE) + (TILE_SIZE / 2), m_origin.y + (9 * TILE_SIZE) + (TILE_SIZE / 2) };
-		locations[1] = { m_origin.x + (7 * TILE_SIZE) + (TILE_SIZE / 2), m_origin.y + (7 * TILE_SIZE) + (TILE_SIZE / 2) };
-		locations[2] = { m_origin.x + (11 * TILE_SIZE) + (TILE_SIZE / 2), m_origin.y + (11 * TILE_SIZE) + (TILE_SIZE / 2) };
-		locations[3] = { m_origin.x + (13 * TILE_SIZE) + (TILE_SIZE / 2), m_origin.y + (15 * TILE_SIZE) + (TILE_SIZE / 2) };
-		locations[4] = { m_origin.x + (15 * TILE_SIZE) + (TILE_SIZE / 2), m_origin.y + (3 * TILE_SIZE) + (TILE_SIZE / 2) };
+// Takes the result of a finished path request.
+bool Level::TakePathResult(PathTicket ticket, std::vector<sf::Vector2f>& path)
+{
+	path.clear();
 
-		// Spawn torches.
-		for (int i = 0; i < 5; ++i)
-		{
-			std::shared_ptr<Torch> torch = std::make_shared<Torch>();
-			torch->SetPosition(sf::Vector2f(static_cast<float>(locations[i].x), static_cast<float>(locations[i].y)));
-			m_torches.push_back(torch);
-		}
+	if (!m_pathRequests.TakeResult(ticket, m_pathTiles))
+	{
+		return false;
 	}
-	else
+
+	for (const GridCoord& tile : m_pathTiles)
+	{
+		path.push_back(GetActualTileLocation(tile.x, tile.y));
+	}
+
+	return true;
+}
+
+// Spends up to a frame's budget on rebuilding the next-hop table.
+void Level::UpdateNextHopTable(double maxMicroseconds)
+{
+	// The table is only kept for the fixed level grid.
+	if (m_world)
+	{
+		return;
+	}
+
+	m_nextHops.UpdateSliced(m_grid, maxMicroseconds);
+}
+
+// Spends up to a frame's budget on the queued path requests.
+void Level::UpdatePathRequests(int maxExpansions, double maxMicroseconds)
+{
+	// Requests are only solved on the fixed level grid.
+	if (m_world)
+	{
+		return;
+	}
+
+	m_pathRequests.Update(m_grid, maxExpansions, maxMicroseconds);
+}
+
+// Returns the tile at the given index.
+Tile Level::GetTile(int columnIndex, int rowIndex) const
+{
+	return Tile{ GetTileType(columnIndex, rowIndex), columnIndex, rowIndex };
+}
+
+// Loads a level from a .txt or binary level file.
+bool Level::LoadLevelFromFile(std::string fileName)
+{
+	// Read the tile types into the level grid.
+	if (!m_grid.LoadFromFile(fileName))
+	{
+		return false;
+	}
+
+	// A loaded level replaces any endless world.
+	m_world.reset();
+
+	// The loaded level stands in for the first room of its floor.
+	m_floorSeed = m_grid.GetSeed();
+	m_roomNumber = 0;
+	GetFloorLayout();
+
+	OnGridLoaded();
+	return true;
+}
+
+// Re-centers the level and rebuilds the path data and torches for a new grid.
+void Level::OnGridLoaded()
+{
+	// The grid size can differ between levels, so re-center the level and size the path data to match.
+	CalculateOrigin();
+	m_changes.Reset();
+	m_pathfinder.Reserve(m_grid.GetWidth() * m_grid.GetHeight());
+	m_pathTiles.reserve(static_cast<size_t>(m_grid.GetWidth()) * m_grid.GetHeight());
+	m_flowField.Invalidate();
+	m_pathCache.Reset(m_grid.GetWidth(), m_grid.GetHeight());
+	m_pathRequests.OnGridChanged();
+
+	// The next-hop table is rebuilt a slice per frame by UpdateNextHopTable(), so entering a room starts no threads.
+	m_nextHops.Invalidate();
+
+	if (UsesHierarchicalPaths())
+	{
+		m_hierarchicalPathfinder.Build(m_grid);
+	}
+
+	// Spawn torches at the locations stored in the grid. Each flickers with its own stream of the level's seed.
+	m_torches.clear();
+
+	const std::vector<GridCoord>& torchIndices = m_grid.GetTorchIndices();
+	Random torchRandom(m_grid.GetSeed(), RANDOM_STREAM::TORCH);
+
+	for (std::size_t t = 0; t < torchIndices.size(); ++t)
+	{
+		const GridCoord& indices = torchIndices[t];
+		std::shared_ptr<Torch> torch = std::make_shared<Torch>(torchRandom.Split(t));
+		torch->SetPosition(GetActualTileLocation(indices.x, indices.y));
+		m_torches.push_back(torch);
+	}
+}
+
+// Generates or fetches a floor and enters its first room.
+void Level::GenerateFloor(std::uint64_t seed, int floorNumber)
+{
+	m_floorSeed = seed;
+	m_floorNumber = floorNumber;
+	EnterRoom(0);
+}
+
+// Enters a room of the current floor.
+bool Level::EnterRoom(int roomNumber)
+{
+	const FloorLayout& floor = GetFloorLayout();
+
+	if ((roomNumber < 0) || (roomNumber >= static_cast<int>(floor.rooms.size())))
 	{
 		return false;
 	}
 
+	m_grid = floor.rooms[roomNumber].grid;
+	m_world.reset();
+	m_roomNumber = roomNumber;
+
+	OnGridLoaded();
 	return true;
 }
 
+// Moves on to the next room, or down to the next floor.
+void Level::EnterNextRoom(sf::Vector2f& spawnPosition)
+{
+	if (m_roomNumber + 1 < GetFloorLayout().mainPathLength)
+	{
+		EnterRoom(m_roomNumber + 1);
+	}
+	else
+	{
+		GenerateFloor(m_floorSeed, m_floorNumber + 1);
+	}
+
+	// Generating the next floor may have reused the slot the old floor was in, so fetch it again.
+	const FloorRoom& room = GetFloorLayout().rooms[m_roomNumber];
+	spawnPosition = GetActualTileLocation(room.entrance.x, room.entrance.y);
+}
+
+// Gets the room in a cell of the current floor's layout.
+int Level::GetRoomAt(int layoutColumn, int layoutRow) const
+{
+	if ((static_cast<unsigned>(layoutColumn) >= static_cast<unsigned>(FLOOR_LAYOUT_COLUMNS)) || (static_cast<unsigned>(layoutRow) >= static_cast<unsigned>(FLOOR_LAYOUT_ROWS)))
+	{
+		return FLOOR_NO_ROOM;
+	}
+
+	return m_roomLayout[layoutRow][layoutColumn];
+}
+
+// Gets the current floor's layout and copies its cells into the room layout.
+const FloorLayout& Level::GetFloorLayout()
+{
+	const FloorLayout& floor = m_floorLayouts.GetFloor(m_floorSeed, m_floorNumber);
+	std::copy(&floor.cells[0][0], &floor.cells[0][0] + (FLOOR_LAYOUT_ROWS * FLOOR_LAYOUT_COLUMNS), &m_roomLayout[0][0]);
+	return floor;
+}
+
 // Checks if a given tile is a wall block.
 bool Level::IsWall(int i, int j)
 {
-	if (TileIsValid(i, j))
-		return m_grid[i][j].type <= TILE::WALL_INTERSECTION;
-	else
-		return false;
+	if (m_world)
+	{
+		return m_world->GetTileType(i, j) <= TILE::WALL_INTERSECTION;
+	}
+
+	return m_grid.IsWall(i, j);
 }
 
 // Unlocks the door in the level.
 void Level::UnlockDoor()
 {
-	SetTile(m_doorTileIndices.x, m_doorTileIndices.y, TILE::WALL_DOOR_UNLOCKED);
+	GridCoord doorIndices = m_grid.GetDoorIndices();
+	SetTile(doorIndices.x, doorIndices.y, TILE::WALL_DOOR_UNLOCKED);
 }
 
 // Return true if the given tile is a floor tile.
 bool Level::IsFloor(int columnIndex, int rowIndex)
 {
-	Tile* tile = &m_grid[columnIndex][rowIndex];
-
-	return ((tile->type == TILE::FLOOR) || (tile->type == TILE::FLOOR_ALT));
+	return LevelGrid::IsFloorType(GetTileType(columnIndex, rowIndex));
 }
 
 // Return true if the given tile is a floor tile.
 bool Level::IsFloor(const Tile& tile)
 {
-	return ((tile.type == TILE::FLOOR) || (tile.type == TILE::FLOOR_ALT));
+	return LevelGrid::IsFloorType(tile.type);
 }
 
 // Gets the size of the tiles in the level.
@@ -305,18 +597,101 @@ std::vector<std::shared_ptr<Torch>>* Level::GetTorches()
 // Draws the level grid to the given render window.
 void Level::Draw(sf::RenderWindow& window, float timeDelta)
 {
-	// Draw the level tiles.
-	for (int i = 0; i < GRID_WIDTH; i++)
+	// The endless world can't be drawn whole, so only draw the chunks in view.
+	if (m_world)
+	{
+		DrawEndless(window);
+		return;
+	}
+
+	// Draw the level tiles in view with one draw call per texture per chunk. Only tiles changed since the last frame are rebuilt.
+	m_tileLayer.Update(m_grid, m_changes);
+
+	sf::RenderStates states;
+	states.transform.translate(static_cast<float>(m_origin.x), static_cast<float>(m_origin.y));
+	window.draw(m_tileLayer, states);
+
+	// Draw the torches in view.
+	const sf::View& view = window.getView();
+	sf::FloatRect viewArea(view.getCenter() - (view.getSize() / 2.f), view.getSize());
+
+	for (auto& torch : m_torches)
 	{
-		for (int j = 0; j < GRID_HEIGHT; j++)
+		if (torch->GetSprite().getGlobalBounds().intersects(viewArea))
 		{
-			window.draw(m_grid[i][j].sprite);
+			torch->Draw(window, timeDelta);
 		}
 	}
+}
 
-	// Draw all torches.
-	for (auto& torch : m_torches)
+// Switches the level to an endless, chunked dungeon.
+void Level::EnableEndlessMode(std::uint64_t seed, const std::string& spillDirectory)
+{
+	m_world.reset(new ChunkedWorld(seed, MAX_RESIDENT_CHUNKS));
+	m_world->SetSpillDirectory(spillDirectory);
+	m_changes.Reset();
+
+	// Chunks have no fixed torch locations.
+	m_torches.clear();
+}
+
+// Returns true if endless mode is enabled.
+bool Level::IsEndless() const
+{
+	return (m_world != nullptr);
+}
+
+// Gets a position to start on in the endless dungeon.
+sf::Vector2f Level::GetEndlessSpawnPosition()
+{
+	// Search outwards from the centre of the first chunk, ring by ring. Pillars are single tiles, so the first ring
+	// always has floor.
+	int center = CHUNK_SIZE / 2;
+
+	for (int radius = 0; radius < center; ++radius)
+	{
+		for (int j = center - radius; j <= center + radius; ++j)
+		{
+			for (int i = center - radius; i <= center + radius; ++i)
+			{
+				if (LevelGrid::IsFloorType(m_world->GetTileType(i, j)))
+				{
+					return GetActualTileLocation(i, j);
+				}
+			}
+		}
+	}
+
+	return GetActualTileLocation(center, center);
+}
+
+// Streams chunks in and out around the given position.
+void Level::UpdateStreaming(sf::Vector2f position)
+{
+	if (m_world)
+	{
+		Tile tile = GetTile(position);
+		m_world->UpdateResidentArea(tile.columnIndex, tile.rowIndex, STREAMING_RADIUS);
+	}
+}
+
+// Draws the tiles of the endless world that are inside the current view.
+void Level::DrawEndless(sf::RenderWindow& window)
+{
+	const sf::View& view = window.getView();
+	sf::Vector2f topLeft = view.getCenter() - (view.getSize() / 2.f);
+	sf::Vector2f bottomRight = view.getCenter() + (view.getSize() / 2.f);
+
+	Tile first = GetTile(topLeft);
+	Tile last = GetTile(bottomRight);
+
+	for (int j = first.rowIndex; j <= last.rowIndex; j++)
 	{
-		torch->Draw(window, timeDelta);
+		for (int i = first.columnIndex; i <= last.columnIndex; i++)
+		{
+			sf::Sprite& sprite = m_tileSprites[static_cast<int>(m_world->GetTileType(i, j))];
+			sprite.setPosition(static_cast<float>(m_origin.x + (TILE_SIZE * i)), static_cast<float>(m_origin.y + (TILE_SIZE * j)));
+			window.draw(sprite);
+		}
 	}
-}
\ No newline at end of file
+}
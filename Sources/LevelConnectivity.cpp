@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <cstdlib>
+#include "LevelConnectivity.h"
+#include "Util.h"
+
+namespace
+{
+	// The offsets of the four tiles that share an edge with a tile.
+	const int COLUMN_OFFSETS[4] = { 0, 1, 0, -1 };
+	const int ROW_OFFSETS[4] = { -1, 0, 1, 0 };
+}
+
+// Default constructor.
+LevelConnectivity::LevelConnectivity() :
+m_width(0),
+m_height(0),
+m_wordsPerRow(0)
+{
+}
+
+// Labels the connected passable areas of a grid.
+int LevelConnectivity::Label(const LevelGrid& grid)
+{
+	m_width = grid.GetWidth();
+	m_height = grid.GetHeight();
+	m_wordsPerRow = grid.GetWordsPerRow();
+
+	m_runs.clear();
+	m_parents.clear();
+	m_rowRuns.assign(static_cast<size_t>(m_height) + 1, 0);
+
+	for (int row = 0; row < m_height; ++row)
+	{
+		const std::uint64_t* bits = grid.GetSolidRow(row);
+		int rowStart = static_cast<int>(m_runs.size());
+		int above = (row > 0) ? m_rowRuns[row - 1] : rowStart;
+
+		m_rowRuns[row] = rowStart;
+
+		for (int column = FindBit(bits, 0, false); column < m_width; )
+		{
+			int end = FindBit(bits, column, true);
+			int index = static_cast<int>(m_runs.size());
+
+			m_runs.push_back({ row, column, end });
+			m_parents.push_back(index);
+
+			// Runs above that end before this one starts can't touch any later run of this row either.
+			while ((above < rowStart) && (m_runs[above].end <= column))
+			{
+				++above;
+			}
+
+			for (int other = above; (other < rowStart) && (m_runs[other].begin < end); ++other)
+			{
+				int root = FindRoot(index);
+				int otherRoot = FindRoot(other);
+
+				// The lower index becomes the parent, so a root is always met before the runs below it.
+				if (root != otherRoot)
+				{
+					m_parents[std::max(root, otherRoot)] = std::min(root, otherRoot);
+				}
+			}
+
+			column = FindBit(bits, end, false);
+		}
+	}
+
+	m_rowRuns[m_height] = static_cast<int>(m_runs.size());
+
+	// Number the roots in order, and give every other run the number of its root.
+	m_runComponents.resize(m_runs.size());
+	m_componentSizes.clear();
+
+	for (size_t r = 0; r < m_runs.size(); ++r)
+	{
+		int root = FindRoot(static_cast<int>(r));
+
+		if (root == static_cast<int>(r))
+		{
+			m_runComponents[r] = static_cast<int>(m_componentSizes.size());
+			m_componentSizes.push_back(0);
+		}
+		else
+		{
+			m_runComponents[r] = m_runComponents[root];
+		}
+
+		m_componentSizes[m_runComponents[r]] += m_runs[r].end - m_runs[r].begin;
+	}
+
+	return static_cast<int>(m_componentSizes.size());
+}
+
+// Labels a grid and checks that its entrance, door and required tiles can reach each other.
+ConnectivityReport LevelConnectivity::Validate(const LevelGrid& grid, const std::vector<GridCoord>& requiredTiles)
+{
+	ConnectivityReport report = { Label(grid), 0, 0, false };
+
+	// The entrance is always in the outer wall, so only the border is searched for it.
+	int entranceComponent = NO_COMPONENT;
+
+	for (int j = 0; (j < m_height) && (entranceComponent == NO_COMPONENT); ++j)
+	{
+		int step = ((j == 0) || (j == m_height - 1)) ? 1 : std::max(m_width - 1, 1);
+
+		for (int i = 0; i < m_width; i += step)
+		{
+			GridCoord inside;
+
+			if ((grid.GetTileType(i, j) == TILE::WALL_ENTRANCE) && (GetInsideTile(grid, { i, j }, inside)))
+			{
+				entranceComponent = GetComponent(inside.x, inside.y);
+				break;
+			}
+		}
+	}
+
+	GridCoord doorInside;
+	int doorComponent = GetInsideTile(grid, grid.GetDoorIndices(), doorInside) ? GetComponent(doorInside.x, doorInside.y) : NO_COMPONENT;
+
+	report.isValid = (entranceComponent != NO_COMPONENT) && (doorComponent == entranceComponent);
+
+	for (const GridCoord& tile : requiredTiles)
+	{
+		report.isValid = report.isValid && (GetComponent(tile.x, tile.y) == entranceComponent);
+	}
+
+	int passableTileCount = 0;
+
+	for (int size : m_componentSizes)
+	{
+		passableTileCount += size;
+	}
+
+	report.pocketCount = report.componentCount - ((entranceComponent != NO_COMPONENT) ? 1 : 0);
+	report.pocketTileCount = passableTileCount - ((entranceComponent != NO_COMPONENT) ? m_componentSizes[entranceComponent] : 0);
+
+	return report;
+}
+
+// Gets the area a tile is in.
+int LevelConnectivity::GetComponent(int columnIndex, int rowIndex) const
+{
+	int run = FindRun(columnIndex, rowIndex);
+	return (run >= 0) ? m_runComponents[run] : NO_COMPONENT;
+}
+
+// Gets the number of tiles in an area.
+int LevelConnectivity::GetComponentSize(int component) const
+{
+	return m_componentSizes[component];
+}
+
+// Turns every passable tile that can't reach a tile into a wall.
+int LevelConnectivity::FillPockets(LevelGrid& grid, GridCoord keep)
+{
+	int keepComponent = GetComponent(keep.x, keep.y);
+	int filledCount = 0;
+
+	if (keepComponent == NO_COMPONENT)
+	{
+		return 0;
+	}
+
+	for (size_t r = 0; r < m_runs.size(); ++r)
+	{
+		if (m_runComponents[r] == keepComponent)
+		{
+			continue;
+		}
+
+		for (int column = m_runs[r].begin; column < m_runs[r].end; ++column)
+		{
+			grid.SetTileType(column, m_runs[r].row, TILE::WALL_SINGLE);
+		}
+
+		filledCount += m_runs[r].end - m_runs[r].begin;
+	}
+
+	if (filledCount > 0)
+	{
+		Label(grid);
+	}
+
+	return filledCount;
+}
+
+// Carves a corridor from every area that can't reach a tile to the nearest tile that can.
+int LevelConnectivity::CarvePockets(LevelGrid& grid, GridCoord keep)
+{
+	int carvedCount = 0;
+
+	// Join one pocket at a time and label again, as a corridor can run through other pockets on its way.
+	for (;;)
+	{
+		int keepComponent = GetComponent(keep.x, keep.y);
+
+		if ((keepComponent == NO_COMPONENT) || (m_componentSizes.size() < 2))
+		{
+			break;
+		}
+
+		size_t pocket = 0;
+
+		while ((pocket < m_runs.size()) && (m_runComponents[pocket] == keepComponent))
+		{
+			++pocket;
+		}
+
+		// Find the kept tile nearest to the start of the pocket's first run.
+		GridCoord from = { m_runs[pocket].begin, m_runs[pocket].row };
+		GridCoord to = keep;
+		int bestDistance = std::abs(keep.x - from.x) + std::abs(keep.y - from.y);
+
+		for (size_t r = 0; r < m_runs.size(); ++r)
+		{
+			if (m_runComponents[r] != keepComponent)
+			{
+				continue;
+			}
+
+			int column = std::min(std::max(from.x, m_runs[r].begin), m_runs[r].end - 1);
+			int distance = std::abs(column - from.x) + std::abs(m_runs[r].row - from.y);
+
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				to = { column, m_runs[r].row };
+			}
+		}
+
+		// Carve along the pocket's row, then along the kept tile's column.
+		int corridorCount = 0;
+		GridCoord tile = from;
+
+		while (tile != to)
+		{
+			if (tile.x != to.x)
+			{
+				tile.x += (to.x > tile.x) ? 1 : -1;
+			}
+			else
+			{
+				tile.y += (to.y > tile.y) ? 1 : -1;
+			}
+
+			bool isBorder = (tile.x <= 0) || (tile.y <= 0) || (tile.x >= m_width - 1) || (tile.y >= m_height - 1);
+
+			if ((!isBorder) && (grid.IsSolid(tile.x, tile.y)))
+			{
+				grid.SetTileType(tile.x, tile.y, TILE::FLOOR);
+				++corridorCount;
+			}
+		}
+
+		// A pocket that can only be reached through the border is left alone.
+		if (corridorCount == 0)
+		{
+			break;
+		}
+
+		carvedCount += corridorCount;
+		Label(grid);
+	}
+
+	return carvedCount;
+}
+
+// Finds the passable tile next to a wall tile.
+bool LevelConnectivity::GetInsideTile(const LevelGrid& grid, GridCoord tile, GridCoord& inside)
+{
+	for (int n = 0; n < 4; ++n)
+	{
+		GridCoord neighbour = { tile.x + COLUMN_OFFSETS[n], tile.y + ROW_OFFSETS[n] };
+
+		if ((grid.TileIsValid(neighbour.x, neighbour.y)) && (!grid.IsSolid(neighbour.x, neighbour.y)))
+		{
+			inside = neighbour;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Gets the root of a run's set.
+int LevelConnectivity::FindRoot(int run)
+{
+	while (m_parents[run] != run)
+	{
+		m_parents[run] = m_parents[m_parents[run]];
+		run = m_parents[run];
+	}
+
+	return run;
+}
+
+// Finds the first column at or after a column whose solidity bit has the given value.
+int LevelConnectivity::FindBit(const std::uint64_t* bits, int from, bool isSolid) const
+{
+	if (from >= m_width)
+	{
+		return m_width;
+	}
+
+	int word = from >> 6;
+	std::uint64_t value = (isSolid ? bits[word] : ~bits[word]) & (~0ull << (from & 63));
+
+	while (value == 0)
+	{
+		if (++word >= m_wordsPerRow)
+		{
+			return m_width;
+		}
+
+		value = isSolid ? bits[word] : ~bits[word];
+	}
+
+	// The padding bits past the last column are solid, so a search for one can land past the grid.
+	return std::min((word << 6) + CountTrailingZeros(value), m_width);
+}
+
+// Gets the run a tile is in.
+int LevelConnectivity::FindRun(int columnIndex, int rowIndex) const
+{
+	if ((static_cast<unsigned>(columnIndex) >= static_cast<unsigned>(m_width)) || (static_cast<unsigned>(rowIndex) >= static_cast<unsigned>(m_height)))
+	{
+		return -1;
+	}
+
+	// The runs of a row are sorted by column, so the run a tile is in is the last one that starts at or before it.
+	auto first = m_runs.begin() + m_rowRuns[rowIndex];
+	auto last = m_runs.begin() + m_rowRuns[rowIndex + 1];
+	auto run = std::upper_bound(first, last, columnIndex, [](int column, const Run& other) { return column < other.begin; });
+
+	if ((run == first) || ((run - 1)->end <= columnIndex))
+	{
+		return -1;
+	}
+
+	return static_cast<int>((run - 1) - m_runs.begin());
+}
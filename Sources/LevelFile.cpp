@@ -0,0 +1,266 @@
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "LevelFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Rounds an offset up to the next multiple of 8, so the bitmap words are aligned in the mapping.
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + 7) & ~7ull;
+	}
+}
+
+// Default constructor.
+LevelFile::LevelFile() :
+m_data(nullptr),
+m_size(0)
+{
+}
+
+// Destructor.
+LevelFile::~LevelFile()
+{
+	Close();
+}
+
+// Maps a binary level file and validates its header.
+bool LevelFile::Open(const std::string& fileName)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if ((GetFileSizeEx(file, &fileSize)) && (fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(LevelFileHeader))))
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping != nullptr)
+		{
+			// The view keeps the mapping alive, so both handles can be closed straight away.
+			m_data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			m_size = static_cast<std::size_t>(fileSize.QuadPart);
+			CloseHandle(mapping);
+		}
+	}
+
+	CloseHandle(file);
+#else
+	int descriptor = open(fileName.c_str(), O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+
+	if ((fstat(descriptor, &status) == 0) && (status.st_size >= static_cast<off_t>(sizeof(LevelFileHeader))))
+	{
+		// The mapping stays valid after the descriptor is closed.
+		void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+		if (data != MAP_FAILED)
+		{
+			m_data = static_cast<const std::uint8_t*>(data);
+			m_size = static_cast<std::size_t>(status.st_size);
+		}
+	}
+
+	close(descriptor);
+#endif
+
+	if (m_data == nullptr)
+	{
+		m_size = 0;
+		return false;
+	}
+
+	if (!ValidateHeader())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+// Unmaps the file.
+void LevelFile::Close()
+{
+	if (m_data != nullptr)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(m_data);
+#else
+		munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+// Checks if a file is currently mapped.
+bool LevelFile::IsOpen() const
+{
+	return m_data != nullptr;
+}
+
+// Gets the header of the open file.
+const LevelFileHeader& LevelFile::GetHeader() const
+{
+	return *reinterpret_cast<const LevelFileHeader*>(m_data);
+}
+
+// Gets the tile types of a single row.
+const std::uint8_t* LevelFile::GetTypeRow(int rowIndex) const
+{
+	const LevelFileHeader& header = GetHeader();
+	return m_data + header.typeOffset + (static_cast<std::size_t>(rowIndex) * header.width);
+}
+
+// Gets the solidity bits of a single row.
+const std::uint64_t* LevelFile::GetSolidRow(int rowIndex) const
+{
+	const LevelFileHeader& header = GetHeader();
+	return reinterpret_cast<const std::uint64_t*>(m_data + header.solidOffset) + (static_cast<std::size_t>(rowIndex) * header.wordsPerRow);
+}
+
+// Gets the indices of one of the level's torches.
+GridCoord LevelFile::GetTorchIndices(int index) const
+{
+	std::int32_t indices[2];
+	std::memcpy(indices, m_data + GetHeader().torchOffset + (static_cast<std::size_t>(index) * sizeof(indices)), sizeof(indices));
+
+	return { indices[0], indices[1] };
+}
+
+// Checks that the mapped header describes a file that fits inside the mapping.
+bool LevelFile::ValidateHeader() const
+{
+	const LevelFileHeader& header = GetHeader();
+
+	if ((std::memcmp(header.magic, "PCGL", 4) != 0) || (header.version != LEVEL_FILE_VERSION))
+	{
+		return false;
+	}
+
+	if ((header.width > 0xFFFF) || (header.height > 0xFFFF) || (header.wordsPerRow != (header.width + 63) / 64))
+	{
+		return false;
+	}
+
+	// The bitmap is read in place, so it has to be aligned.
+	if ((header.solidOffset & 7) != 0)
+	{
+		return false;
+	}
+
+	std::uint64_t torchBytes = static_cast<std::uint64_t>(header.torchCount) * 8;
+	std::uint64_t typeBytes = static_cast<std::uint64_t>(header.width) * header.height;
+	std::uint64_t solidBytes = static_cast<std::uint64_t>(header.wordsPerRow) * header.height * 8;
+
+	return (FitsInFile(header.torchOffset, torchBytes)) && (FitsInFile(header.typeOffset, typeBytes)) && (FitsInFile(header.solidOffset, solidBytes));
+}
+
+// Checks that a block of the file lies after the header and inside the mapping.
+bool LevelFile::FitsInFile(std::uint64_t offset, std::uint64_t bytes) const
+{
+	// Compared against what is left after the offset, so a huge offset or size can't wrap around and pass.
+	return (offset >= sizeof(LevelFileHeader)) && (offset <= m_size) && (bytes <= m_size - offset);
+}
+
+// Writes a grid to a binary level file.
+bool LevelFile::Write(const std::string& fileName, const LevelGrid& grid)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	return Write(file, grid);
+}
+
+// Writes a grid as a binary level file image to a stream.
+bool LevelFile::Write(std::ostream& stream, const LevelGrid& grid)
+{
+	const std::vector<GridCoord>& torches = grid.GetTorchIndices();
+	GridCoord door = grid.GetDoorIndices();
+
+	LevelFileHeader header;
+	std::memcpy(header.magic, "PCGL", 4);
+	header.version = LEVEL_FILE_VERSION;
+	header.width = static_cast<std::uint32_t>(grid.GetWidth());
+	header.height = static_cast<std::uint32_t>(grid.GetHeight());
+	header.seed = grid.GetSeed();
+	header.doorColumn = door.x;
+	header.doorRow = door.y;
+	header.torchCount = static_cast<std::uint32_t>(torches.size());
+	header.wordsPerRow = static_cast<std::uint32_t>(grid.GetWordsPerRow());
+	header.torchOffset = sizeof(LevelFileHeader);
+	header.typeOffset = header.torchOffset + (static_cast<std::uint64_t>(header.torchCount) * 8);
+	header.solidOffset = AlignOffset(header.typeOffset + (static_cast<std::uint64_t>(header.width) * header.height));
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (const GridCoord& torch : torches)
+	{
+		std::int32_t indices[2] = { torch.x, torch.y };
+		stream.write(reinterpret_cast<const char*>(indices), sizeof(indices));
+	}
+
+	for (int j = 0; j < grid.GetHeight(); ++j)
+	{
+		stream.write(reinterpret_cast<const char*>(grid.GetTypeRow(j)), grid.GetWidth());
+	}
+
+	// Pad up to the aligned start of the bitmap.
+	static const char padding[8] = {};
+	stream.write(padding, static_cast<std::streamsize>(header.solidOffset - (header.typeOffset + (static_cast<std::uint64_t>(header.width) * header.height))));
+
+	for (int j = 0; j < grid.GetHeight(); ++j)
+	{
+		stream.write(reinterpret_cast<const char*>(grid.GetSolidRow(j)), static_cast<std::streamsize>(grid.GetWordsPerRow()) * sizeof(std::uint64_t));
+	}
+
+	return static_cast<bool>(stream);
+}
+
+// Gets the size of the binary level file image of a grid.
+std::uint64_t LevelFile::GetImageSize(int width, int height, int torchCount)
+{
+	std::uint64_t typeOffset = sizeof(LevelFileHeader) + (static_cast<std::uint64_t>(torchCount) * 8);
+	std::uint64_t solidOffset = AlignOffset(typeOffset + (static_cast<std::uint64_t>(width) * height));
+
+	return solidOffset + (static_cast<std::uint64_t>((width + 63) / 64) * height * 8);
+}
+
+// Checks if a path names a binary level file.
+bool LevelFile::IsLevelFileName(const std::string& fileName)
+{
+	std::size_t extensionLength = std::strlen(LEVEL_FILE_EXTENSION);
+
+	return (fileName.size() >= extensionLength) && (fileName.compare(fileName.size() - extensionLength, extensionLength, LEVEL_FILE_EXTENSION) == 0);
+}
@@ -0,0 +1,179 @@
+#include <utility>
+#include "LevelGenerator.h"
+
+// Constructor. Mazes are built on odd cells, so even sizes are rounded down.
+LevelGenerator::LevelGenerator(int width, int height) :
+m_width((width > 5) ? (width - ((width + 1) % 2)) : 5),
+m_height((height > 5) ? (height - ((height + 1) % 2)) : 5),
+m_lastReport({ 0, 0, 0, false })
+{
+}
+
+// Generates a floor into the given grid, and checks it can be completed.
+bool LevelGenerator::Generate(std::uint64_t seed, LevelGrid& grid)
+{
+	Random random(seed, RANDOM_STREAM::LEVEL);
+
+	grid.Resize(m_width, m_height);
+	grid.SetSeed(seed);
+
+	for (int j = 0; j < m_height; ++j)
+	{
+		for (int i = 0; i < m_width; ++i)
+		{
+			grid.SetTileType(i, j, TILE::WALL_SINGLE);
+		}
+	}
+
+	CarveMaze(random, grid);
+	RemoveWalls(random, grid);
+	PlaceFeatures(random, grid);
+
+	// Check the floor before spending any more time on it. Pockets the door can't reach are filled in.
+	m_lastReport = m_connectivity.Validate(grid);
+
+	if (!m_lastReport.isValid)
+	{
+		return false;
+	}
+
+	GridCoord doorInside;
+
+	if ((m_lastReport.pocketCount > 0) && (LevelConnectivity::GetInsideTile(grid, grid.GetDoorIndices(), doorInside)))
+	{
+		m_connectivity.FillPockets(grid, doorInside);
+	}
+
+	PlaceTorches(random, grid);
+
+	// Pick the wall variants last, once every wall is in place.
+	grid.Autotile();
+	return true;
+}
+
+// Gets the report of the last generated floor's connectivity check.
+const ConnectivityReport& LevelGenerator::GetLastReport() const
+{
+	return m_lastReport;
+}
+
+// Gets the width of generated levels.
+int LevelGenerator::GetWidth() const
+{
+	return m_width;
+}
+
+// Gets the height of generated levels.
+int LevelGenerator::GetHeight() const
+{
+	return m_height;
+}
+
+// Carves a maze through a grid of walls.
+void LevelGenerator::CarveMaze(Random& random, LevelGrid& grid)
+{
+	static const GridCoord directions[4] = { { 0, -2 }, { 2, 0 }, { 0, 2 }, { -2, 0 } };
+
+	int cellColumns = (m_width - 1) / 2;
+	int cellRows = (m_height - 1) / 2;
+	GridCoord start = { (random.Range(0, cellColumns - 1) * 2) + 1, (random.Range(0, cellRows - 1) * 2) + 1 };
+
+	m_stack.clear();
+	m_stack.push_back(start);
+	grid.SetTileType(start.x, start.y, TILE::FLOOR);
+
+	while (!m_stack.empty())
+	{
+		GridCoord cell = m_stack.back();
+
+		// Collect the neighbouring cells that haven't been carved yet. Carved cells are floor, uncarved ones are still wall.
+		GridCoord unvisited[4];
+		int unvisitedCount = 0;
+
+		for (const GridCoord& direction : directions)
+		{
+			GridCoord next = { cell.x + direction.x, cell.y + direction.y };
+
+			if ((next.x > 0) && (next.x < m_width - 1) && (next.y > 0) && (next.y < m_height - 1) && (grid.IsSolid(next.x, next.y)))
+			{
+				unvisited[unvisitedCount++] = next;
+			}
+		}
+
+		if (unvisitedCount == 0)
+		{
+			m_stack.pop_back();
+			continue;
+		}
+
+		// Knock down the wall between the two cells and move on.
+		GridCoord next = unvisited[random.Range(0, unvisitedCount - 1)];
+		grid.SetTileType((cell.x + next.x) / 2, (cell.y + next.y) / 2, TILE::FLOOR);
+		grid.SetTileType(next.x, next.y, TILE::FLOOR);
+
+		m_stack.push_back(next);
+	}
+}
+
+// Removes some of the walls between neighbouring corridors.
+void LevelGenerator::RemoveWalls(Random& random, LevelGrid& grid)
+{
+	for (int j = 1; j < m_height - 1; ++j)
+	{
+		for (int i = 1; i < m_width - 1; ++i)
+		{
+			// Only walls between two cells can be removed. The walls at even, even positions hold the maze together.
+			if (((i % 2) == (j % 2)) || (!grid.IsSolid(i, j)))
+			{
+				continue;
+			}
+
+			if (random.Range(0, 7) == 0)
+			{
+				grid.SetTileType(i, j, TILE::FLOOR);
+			}
+		}
+	}
+}
+
+// Places the door and entrance.
+void LevelGenerator::PlaceFeatures(Random& random, LevelGrid& grid)
+{
+	int cellColumns = (m_width - 1) / 2;
+
+	// The door and entrance sit in the outer walls above and below a cell, so they always open onto floor.
+	GridCoord door = { (random.Range(0, cellColumns - 1) * 2) + 1, 0 };
+	grid.SetTileType(door.x, door.y, TILE::WALL_DOOR_LOCKED);
+	grid.SetDoorIndices(door);
+
+	grid.SetTileType((random.Range(0, cellColumns - 1) * 2) + 1, m_height - 1, TILE::WALL_ENTRANCE);
+}
+
+// Places the torches on the floor.
+void LevelGenerator::PlaceTorches(Random& random, LevelGrid& grid)
+{
+	// Pick distinct floor tiles for the torches with a partial shuffle.
+	m_floorTiles.clear();
+
+	for (int j = 1; j < m_height - 1; ++j)
+	{
+		for (int i = 1; i < m_width - 1; ++i)
+		{
+			if (grid.IsFloor(i, j))
+			{
+				m_floorTiles.push_back({ i, j });
+			}
+		}
+	}
+
+	int torchCount = (static_cast<int>(m_floorTiles.size()) < LEVEL_TORCH_COUNT) ? static_cast<int>(m_floorTiles.size()) : LEVEL_TORCH_COUNT;
+
+	for (int t = 0; t < torchCount; ++t)
+	{
+		int pick = random.Range(t, static_cast<int>(m_floorTiles.size()) - 1);
+		std::swap(m_floorTiles[t], m_floorTiles[pick]);
+	}
+
+	m_floorTiles.resize(torchCount);
+	grid.SetTorchIndices(m_floorTiles);
+}
@@ -0,0 +1,660 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "LevelGrid.h"
+#include "LevelFile.h"
+
+namespace
+{
+	// The wall tile drawn for each set of joining neighbours: 1 = up, 2 = right, 4 = down, 8 = left.
+	constexpr TILE WallVariantForMask(int mask)
+	{
+		switch (mask)
+		{
+		case 1: return TILE::WALL_TOP_END;
+		case 2: return TILE::WALL_SIDE_RIGHT_END;
+		case 3: return TILE::WALL_BOTTOM_LEFT;
+		case 4: return TILE::WALL_BOTTOM_END;
+		case 5: return TILE::WALL_SIDE;
+		case 6: return TILE::WALL_TOP_LEFT;
+		case 7: return TILE::WALL_SIDE_LEFT_T;
+		case 8: return TILE::WALL_SIDE_LEFT_END;
+		case 9: return TILE::WALL_BOTTOM_RIGHT;
+		case 10: return TILE::WALL_TOP;
+		case 11: return TILE::WALL_BOTTOM_T;
+		case 12: return TILE::WALL_TOP_RIGHT;
+		case 13: return TILE::WALL_SIDE_RIGHT_T;
+		case 14: return TILE::WALL_TOP_T;
+		case 15: return TILE::WALL_INTERSECTION;
+		default: return TILE::WALL_SINGLE;
+		}
+	}
+
+	// Lookup table of WallVariantForMask, built at compile time.
+	struct WallVariantTable {
+		std::uint8_t variants[16];
+
+		constexpr WallVariantTable() :
+		variants()
+		{
+			for (int mask = 0; mask < 16; ++mask)
+			{
+				variants[mask] = static_cast<std::uint8_t>(WallVariantForMask(mask));
+			}
+		}
+	};
+
+	constexpr WallVariantTable WALL_VARIANTS;
+
+	static_assert(WALL_VARIANTS.variants[0] == static_cast<std::uint8_t>(TILE::WALL_SINGLE), "Unexpected wall variant table.");
+	static_assert(WALL_VARIANTS.variants[15] == static_cast<std::uint8_t>(TILE::WALL_INTERSECTION), "Unexpected wall variant table.");
+}
+
+// Default constructor.
+LevelGrid::LevelGrid() :
+LevelGrid(GRID_WIDTH, GRID_HEIGHT)
+{
+}
+
+// Constructor.
+LevelGrid::LevelGrid(int width, int height) :
+m_width(0),
+m_height(0),
+m_wordsPerRow(0),
+m_wordsPerColumn(0),
+m_doorIndices({ 0, 0 }),
+m_seed(0)
+{
+	Resize(width, height);
+}
+
+// Resizes the grid, resetting every cell to empty.
+void LevelGrid::Resize(int width, int height)
+{
+	m_width = (width > 0) ? width : 0;
+	m_height = (height > 0) ? height : 0;
+	m_wordsPerRow = (m_width + 63) / 64;
+	m_wordsPerColumn = (m_height + 63) / 64;
+
+	// Empty tiles are solid, so every bit of the bitmap starts set.
+	m_types.assign(static_cast<size_t>(m_width) * m_height, static_cast<std::uint8_t>(TILE::EMPTY));
+	m_solid.assign(static_cast<size_t>(m_wordsPerRow) * m_height, ~0ull);
+	m_solidColumns.assign(static_cast<size_t>(m_wordsPerColumn) * m_width, ~0ull);
+}
+
+// Gets the width of the grid in tiles.
+int LevelGrid::GetWidth() const
+{
+	return m_width;
+}
+
+// Gets the height of the grid in tiles.
+int LevelGrid::GetHeight() const
+{
+	return m_height;
+}
+
+// Checks if a given tile is valid.
+bool LevelGrid::TileIsValid(int column, int row) const
+{
+	// A single unsigned compare covers both the negative and the too large case.
+	return (static_cast<unsigned>(column) < static_cast<unsigned>(m_width)) && (static_cast<unsigned>(row) < static_cast<unsigned>(m_height));
+}
+
+// Gets the offset of the given tile in the type array.
+int LevelGrid::GetIndex(int columnIndex, int rowIndex) const
+{
+	return (rowIndex * m_width) + columnIndex;
+}
+
+// Sets or clears the solidity bit of the given tile.
+void LevelGrid::SetSolidBit(int columnIndex, int rowIndex, bool isSolid)
+{
+	std::uint64_t& word = m_solid[(rowIndex * m_wordsPerRow) + (columnIndex >> 6)];
+	std::uint64_t mask = 1ull << (columnIndex & 63);
+	std::uint64_t& columnWord = m_solidColumns[(columnIndex * m_wordsPerColumn) + (rowIndex >> 6)];
+	std::uint64_t columnMask = 1ull << (rowIndex & 63);
+
+	if (isSolid)
+	{
+		word |= mask;
+		columnWord |= columnMask;
+	}
+	else
+	{
+		word &= ~mask;
+		columnWord &= ~columnMask;
+	}
+}
+
+// Returns the type of the given tile.
+TILE LevelGrid::GetTileType(int columnIndex, int rowIndex) const
+{
+	if (!TileIsValid(columnIndex, rowIndex))
+	{
+		return TILE::EMPTY;
+	}
+
+	return static_cast<TILE>(m_types[GetIndex(columnIndex, rowIndex)]);
+}
+
+// Sets the type of the given tile.
+void LevelGrid::SetTileType(int columnIndex, int rowIndex, TILE tileType)
+{
+	if ((!TileIsValid(columnIndex, rowIndex)) || (tileType >= TILE::COUNT))
+	{
+		return;
+	}
+
+	m_types[GetIndex(columnIndex, rowIndex)] = static_cast<std::uint8_t>(tileType);
+	SetSolidBit(columnIndex, rowIndex, IsSolidType(tileType));
+}
+
+// Checks if a given tile is passable.
+bool LevelGrid::IsSolid(int columnIndex, int rowIndex) const
+{
+	if (TileIsValid(columnIndex, rowIndex))
+	{
+		return ((m_solid[(rowIndex * m_wordsPerRow) + (columnIndex >> 6)] >> (columnIndex & 63)) & 1ull) != 0;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+// Return true if the given tile is a floor tile.
+bool LevelGrid::IsFloor(int columnIndex, int rowIndex) const
+{
+	return IsFloorType(GetTileType(columnIndex, rowIndex));
+}
+
+// Checks if a given tile is a wall block.
+bool LevelGrid::IsWall(int columnIndex, int rowIndex) const
+{
+	if (TileIsValid(columnIndex, rowIndex))
+	{
+		return m_types[GetIndex(columnIndex, rowIndex)] <= static_cast<std::uint8_t>(TILE::WALL_INTERSECTION);
+	}
+	else
+	{
+		return false;
+	}
+}
+
+// Assigns the correct wall variant to every wall tile.
+void LevelGrid::Autotile()
+{
+	if ((m_width == 0) || (m_height == 0))
+	{
+		return;
+	}
+
+	// A rolling window of the joining bitmaps of the rows above, at, and below the current row.
+	std::vector<std::uint64_t> window(static_cast<size_t>(m_wordsPerRow) * 3);
+	std::uint64_t* above = &window[0];
+	std::uint64_t* current = &window[m_wordsPerRow];
+	std::uint64_t* below = &window[static_cast<size_t>(m_wordsPerRow) * 2];
+
+	PackJoinRow(-1, above);
+	PackJoinRow(0, current);
+
+	for (int j = 0; j < m_height; ++j)
+	{
+		PackJoinRow(j + 1, below);
+
+		std::uint8_t* types = &m_types[static_cast<size_t>(j) * m_width];
+
+		for (int w = 0; w < m_wordsPerRow; ++w)
+		{
+			// Shift the row so bit i of each word holds the state of the neighbour of tile i.
+			std::uint64_t walls = current[w];
+			std::uint64_t left = (walls << 1) | ((w > 0) ? (current[w - 1] >> 63) : 0);
+			std::uint64_t right = (walls >> 1) | ((w + 1 < m_wordsPerRow) ? (current[w + 1] << 63) : 0);
+			std::uint64_t up = above[w];
+			std::uint64_t down = below[w];
+
+			while (walls != 0)
+			{
+				int bit = CountTrailingZeros(walls);
+				walls &= walls - 1;
+
+				std::uint8_t& type = types[(w * 64) + bit];
+
+				// Doors and entrances join walls but keep their own type.
+				if (type <= static_cast<std::uint8_t>(TILE::WALL_INTERSECTION))
+				{
+					int mask = static_cast<int>(((up >> bit) & 1) | (((right >> bit) & 1) << 1) | (((down >> bit) & 1) << 2) | (((left >> bit) & 1) << 3));
+					type = WALL_VARIANTS.variants[mask];
+				}
+			}
+		}
+
+		// Rotate the window down a row.
+		std::uint64_t* recycled = above;
+		above = current;
+		current = below;
+		below = recycled;
+	}
+}
+
+// Assigns the correct wall variant to the wall tiles inside a rectangle.
+void LevelGrid::AutotileRegion(int firstColumn, int firstRow, int lastColumn, int lastRow)
+{
+	firstColumn = (firstColumn > 0) ? firstColumn : 0;
+	firstRow = (firstRow > 0) ? firstRow : 0;
+	lastColumn = (lastColumn < m_width - 1) ? lastColumn : m_width - 1;
+	lastRow = (lastRow < m_height - 1) ? lastRow : m_height - 1;
+
+	for (int j = firstRow; j <= lastRow; ++j)
+	{
+		for (int i = firstColumn; i <= lastColumn; ++i)
+		{
+			std::uint8_t& type = m_types[GetIndex(i, j)];
+
+			if (type <= static_cast<std::uint8_t>(TILE::WALL_INTERSECTION))
+			{
+				int mask = (JoinsWalls(GetTileType(i, j - 1)) ? 1 : 0) |
+					(JoinsWalls(GetTileType(i + 1, j)) ? 2 : 0) |
+					(JoinsWalls(GetTileType(i, j + 1)) ? 4 : 0) |
+					(JoinsWalls(GetTileType(i - 1, j)) ? 8 : 0);
+
+				type = WALL_VARIANTS.variants[mask];
+			}
+		}
+	}
+}
+
+// Packs the tiles of a row that walls join to into a bitmap.
+void LevelGrid::PackJoinRow(int rowIndex, std::uint64_t* bits) const
+{
+	for (int w = 0; w < m_wordsPerRow; ++w)
+	{
+		bits[w] = 0;
+	}
+
+	if ((rowIndex < 0) || (rowIndex >= m_height))
+	{
+		return;
+	}
+
+	const std::uint8_t* types = GetTypeRow(rowIndex);
+
+	for (int w = 0; w < m_wordsPerRow; ++w)
+	{
+		int first = w * 64;
+		int count = ((m_width - first) < 64) ? (m_width - first) : 64;
+		std::uint64_t word = 0;
+
+		for (int b = 0; b < count; ++b)
+		{
+			word |= static_cast<std::uint64_t>(types[first + b] < static_cast<std::uint8_t>(TILE::FLOOR)) << b;
+		}
+
+		bits[w] = word;
+	}
+}
+
+// Gets the tile types of a single row.
+const std::uint8_t* LevelGrid::GetTypeRow(int rowIndex) const
+{
+	return &m_types[static_cast<size_t>(rowIndex) * m_width];
+}
+
+// Gets the solidity bits of a single row.
+const std::uint64_t* LevelGrid::GetSolidRow(int rowIndex) const
+{
+	return &m_solid[static_cast<size_t>(rowIndex) * m_wordsPerRow];
+}
+
+// Gets the number of words in each row of the solidity bitmap.
+int LevelGrid::GetWordsPerRow() const
+{
+	return m_wordsPerRow;
+}
+
+// Gets the solidity bits of a single column.
+const std::uint64_t* LevelGrid::GetSolidColumn(int columnIndex) const
+{
+	return &m_solidColumns[static_cast<size_t>(columnIndex) * m_wordsPerColumn];
+}
+
+// Gets the number of words in each column of the column by column solidity bitmap.
+int LevelGrid::GetWordsPerColumn() const
+{
+	return m_wordsPerColumn;
+}
+
+// Loads the grid from a level file, picking the format from its extension.
+bool LevelGrid::LoadFromFile(const std::string& fileName)
+{
+	if (LevelFile::IsLevelFileName(fileName))
+	{
+		LevelFile file;
+		return (file.Open(fileName)) && (LoadFromLevelFile(file));
+	}
+
+	return LoadFromTextFile(fileName);
+}
+
+// Loads the grid from a .txt file.
+bool LevelGrid::LoadFromTextFile(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Read the whole file in one go, as the size of the grid comes from the file.
+	std::string text;
+	file.seekg(0, std::ios::end);
+	std::streamoff fileSize = file.tellg();
+
+	if (fileSize <= 0)
+	{
+		return false;
+	}
+
+	text.resize(static_cast<size_t>(fileSize));
+	file.seekg(0, std::ios::beg);
+	file.read(&text[0], static_cast<std::streamsize>(text.size()));
+
+	// Find the start and length of every line holding tiles, and read the torch lines, e.g. "torch 3 9".
+	std::vector<std::pair<size_t, size_t>> lines;
+	std::vector<GridCoord> torches;
+	size_t lineStart = 0;
+
+	while (lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		lineEnd = (lineEnd == std::string::npos) ? text.size() : lineEnd;
+
+		size_t lineLength = lineEnd - lineStart;
+
+		if ((lineLength > 0) && (text[lineEnd - 1] == '\r'))
+		{
+			--lineLength;
+		}
+
+		if (std::memchr(&text[lineStart], '[', lineLength) != nullptr)
+		{
+			lines.push_back({ lineStart, lineLength });
+		}
+		else if ((lineLength > 6) && (text.compare(lineStart, 6, "torch ") == 0))
+		{
+			const char* lineEndPointer = &text[lineStart] + lineLength;
+			char* columnEnd = nullptr;
+			char* rowEnd = nullptr;
+			long column = std::strtol(&text[lineStart + 6], &columnEnd, 10);
+			long row = std::strtol(columnEnd, &rowEnd, 10);
+
+			// Both numbers have to be on the line itself.
+			if ((rowEnd != columnEnd) && (rowEnd <= lineEndPointer))
+			{
+				torches.push_back({ static_cast<int>(column), static_cast<int>(row) });
+			}
+		}
+
+		lineStart = lineEnd + 1;
+	}
+
+	if (lines.empty())
+	{
+		return false;
+	}
+
+	// Every tile takes 4 characters, e.g. [19].
+	int width = static_cast<int>(lines[0].second / 4);
+	int height = static_cast<int>(lines.size());
+
+	Resize(width, height);
+	m_seed = 0;
+
+	for (int j = 0; j < height; ++j)
+	{
+		const char* row = &text[lines[j].first];
+		int rowLength = static_cast<int>(lines[j].second);
+
+		for (int i = 0; (i < width) && ((i * 4) + 3 <= rowLength); ++i)
+		{
+			// Out of 4 characters we only want 2nd and 3rd.
+			char tens = row[(i * 4) + 1];
+			char units = row[(i * 4) + 2];
+			int tileID = static_cast<int>(TILE::EMPTY);
+
+			if ((tens >= '0') && (tens <= '9') && (units >= '0') && (units <= '9'))
+			{
+				tileID = ((tens - '0') * 10) + (units - '0');
+			}
+
+			if (tileID >= static_cast<int>(TILE::COUNT))
+			{
+				tileID = static_cast<int>(TILE::EMPTY);
+			}
+
+			SetTileType(i, j, static_cast<TILE>(tileID));
+
+			// Save the location of the exit door.
+			if (static_cast<TILE>(tileID) == TILE::WALL_DOOR_LOCKED)
+			{
+				m_doorIndices = { i, j };
+			}
+		}
+	}
+
+	// Torches are stored with the level. Any that fall outside it are dropped.
+	m_torchIndices.clear();
+
+	for (const GridCoord& torch : torches)
+	{
+		if (TileIsValid(torch.x, torch.y))
+		{
+			m_torchIndices.push_back(torch);
+		}
+	}
+
+	return true;
+}
+
+// Saves the grid as a text file.
+bool LevelGrid::SaveToTextFile(const std::string& fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Build each row in one buffer, 4 characters per tile, e.g. [19].
+	std::string row(static_cast<size_t>(m_width) * 4, ' ');
+
+	for (int j = 0; j < m_height; ++j)
+	{
+		const std::uint8_t* types = GetTypeRow(j);
+
+		for (int i = 0; i < m_width; ++i)
+		{
+			row[(i * 4)] = '[';
+			row[(i * 4) + 1] = static_cast<char>('0' + (types[i] / 10));
+			row[(i * 4) + 2] = static_cast<char>('0' + (types[i] % 10));
+			row[(i * 4) + 3] = ']';
+		}
+
+		// Rows are separated by new lines, without one after the last row.
+		if (j > 0)
+		{
+			file.put('\n');
+		}
+
+		file.write(row.data(), static_cast<std::streamsize>(row.size()));
+	}
+
+	// Torches follow the rows, one per line.
+	for (const GridCoord& torch : m_torchIndices)
+	{
+		file << "\ntorch " << torch.x << ' ' << torch.y;
+	}
+
+	return static_cast<bool>(file);
+}
+
+// Loads the grid from a mapped binary level file.
+bool LevelGrid::LoadFromLevelFile(const LevelFile& file)
+{
+	if (!file.IsOpen())
+	{
+		return false;
+	}
+
+	const LevelFileHeader& header = file.GetHeader();
+	int width = static_cast<int>(header.width);
+	int height = static_cast<int>(header.height);
+
+	int wordsPerRow = static_cast<int>(header.wordsPerRow);
+
+	// Check everything before touching the grid, so a bad file leaves it unchanged. The door and torches have to be
+	// on the grid, every tile type has to be known, and the solidity bitmap has to agree with the types, since the
+	// rest of the game trusts it without looking at the types again.
+	if ((static_cast<std::uint32_t>(header.doorColumn) >= header.width) || (static_cast<std::uint32_t>(header.doorRow) >= header.height))
+	{
+		return false;
+	}
+
+	for (int t = 0; t < static_cast<int>(header.torchCount); ++t)
+	{
+		GridCoord torch = file.GetTorchIndices(t);
+
+		if ((static_cast<std::uint32_t>(torch.x) >= header.width) || (static_cast<std::uint32_t>(torch.y) >= header.height))
+		{
+			return false;
+		}
+	}
+
+	for (int j = 0; j < height; ++j)
+	{
+		const std::uint8_t* types = file.GetTypeRow(j);
+		const std::uint64_t* solid = file.GetSolidRow(j);
+
+		for (int w = 0; w < wordsPerRow; ++w)
+		{
+			// Bits past the last column are set, as Resize() leaves them.
+			std::uint64_t expected = ~0ull;
+			int lastColumn = ((w * 64) + 64 < width) ? ((w * 64) + 64) : width;
+
+			for (int i = w * 64; i < lastColumn; ++i)
+			{
+				if (types[i] >= static_cast<std::uint8_t>(TILE::COUNT))
+				{
+					return false;
+				}
+
+				if (!IsSolidType(static_cast<TILE>(types[i])))
+				{
+					expected &= ~(1ull << (i & 63));
+				}
+			}
+
+			if (solid[w] != expected)
+			{
+				return false;
+			}
+		}
+	}
+
+	Resize(width, height);
+
+	// Both arrays are stored in the same layout as the grid, so each is a single copy.
+	if (height > 0)
+	{
+		std::memcpy(&m_types[0], file.GetTypeRow(0), m_types.size());
+		std::memcpy(&m_solid[0], file.GetSolidRow(0), m_solid.size() * sizeof(std::uint64_t));
+	}
+
+	// The file only stores the rows, so transpose them into the column copy. Resize() left every bit set.
+	for (int j = 0; j < height; ++j)
+	{
+		const std::uint64_t* row = GetSolidRow(j);
+
+		for (int i = 0; i < width; ++i)
+		{
+			if (((row[i >> 6] >> (i & 63)) & 1ull) == 0)
+			{
+				m_solidColumns[(i * m_wordsPerColumn) + (j >> 6)] &= ~(1ull << (j & 63));
+			}
+		}
+	}
+
+	m_seed = header.seed;
+	m_doorIndices = { header.doorColumn, header.doorRow };
+	m_torchIndices.resize(header.torchCount);
+
+	for (int t = 0; t < static_cast<int>(header.torchCount); ++t)
+	{
+		m_torchIndices[t] = file.GetTorchIndices(t);
+	}
+
+	return true;
+}
+
+// Gets the indices of the door tile.
+GridCoord LevelGrid::GetDoorIndices() const
+{
+	return m_doorIndices;
+}
+
+// Sets the indices of the door tile.
+void LevelGrid::SetDoorIndices(GridCoord doorIndices)
+{
+	m_doorIndices = doorIndices;
+}
+
+// Gets the indices of all torch tiles.
+const std::vector<GridCoord>& LevelGrid::GetTorchIndices() const
+{
+	return m_torchIndices;
+}
+
+// Sets the indices of all torch tiles.
+void LevelGrid::SetTorchIndices(const std::vector<GridCoord>& torchIndices)
+{
+	m_torchIndices = torchIndices;
+}
+
+// Gets the seed the grid was generated from.
+std::uint64_t LevelGrid::GetSeed() const
+{
+	return m_seed;
+}
+
+// Sets the seed the grid was generated from.
+void LevelGrid::SetSeed(std::uint64_t seed)
+{
+	m_seed = seed;
+}
+
+// Return true if the given tile type is a floor type.
+bool LevelGrid::IsFloorType(TILE tileType)
+{
+	return ((tileType == TILE::FLOOR) || (tileType == TILE::FLOOR_ALT));
+}
+
+// Return true if the given tile type blocks movement.
+bool LevelGrid::IsSolidType(TILE tileType)
+{
+	return ((!IsFloorType(tileType)) && (tileType != TILE::WALL_DOOR_UNLOCKED));
+}
+
+// Return true if walls next to the given tile type should join up with it.
+bool LevelGrid::JoinsWalls(TILE tileType)
+{
+	return (tileType < TILE::FLOOR);
+}
+
+// Gets the wall variant that fits a set of joining neighbours.
+TILE LevelGrid::GetWallVariant(int mask)
+{
+	return static_cast<TILE>(WALL_VARIANTS.variants[mask & 15]);
+}
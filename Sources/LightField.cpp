@@ -0,0 +1,399 @@
+#include <algorithm>
+#include "LightField.h"
+
+namespace
+{
+	// Gets the level of one channel of a colour.
+	int GetChannel(LightColor color, int channel)
+	{
+		switch (channel)
+		{
+		case 0: return color.red;
+		case 1: return color.green;
+		default: return color.blue;
+		}
+	}
+}
+
+// Default constructor.
+LightField::LightField() :
+m_width(0),
+m_height(0),
+m_lastVisitCount(0)
+{
+}
+
+// Sizes the field to a grid and removes every light.
+void LightField::Reset(const LevelGrid& grid)
+{
+	m_width = grid.GetWidth();
+	m_height = grid.GetHeight();
+
+	size_t levelCount = static_cast<size_t>(m_width) * m_height * LIGHT_CHANNEL_COUNT;
+	m_levels.assign(levelCount, 0);
+	m_emission.assign(levelCount, 0);
+	m_firstLights.assign(static_cast<size_t>(m_width) * m_height, -1);
+
+	m_lights.clear();
+	m_freeIds.clear();
+	m_lastVisitCount = 0;
+}
+
+// Adds a light.
+int LightField::AddLight(const LevelGrid& grid, GridCoord tile, LightColor color)
+{
+	int id;
+
+	if (m_freeIds.empty())
+	{
+		id = static_cast<int>(m_lights.size());
+		m_lights.push_back(Light());
+	}
+	else
+	{
+		id = m_freeIds.back();
+		m_freeIds.pop_back();
+	}
+
+	m_lights[id] = { GetTileIndex(tile), color, -1 };
+	m_lastVisitCount = 0;
+
+	// A light off the grid is parked: it keeps its id but lights nothing until it moves back on.
+	if (m_lights[id].tile >= 0)
+	{
+		LinkLight(id);
+		UpdateEmission(grid, m_lights[id].tile);
+	}
+
+	return id;
+}
+
+// Moves a light to another tile.
+void LightField::MoveLight(const LevelGrid& grid, int id, GridCoord tile)
+{
+	int oldTile = m_lights[id].tile;
+	int newTile = GetTileIndex(tile);
+
+	if (newTile == oldTile)
+	{
+		return;
+	}
+
+	m_lastVisitCount = 0;
+
+	if (oldTile >= 0)
+	{
+		UnlinkLight(id);
+	}
+
+	m_lights[id].tile = newTile;
+
+	if (newTile >= 0)
+	{
+		LinkLight(id);
+	}
+
+	if (oldTile >= 0)
+	{
+		UpdateEmission(grid, oldTile);
+	}
+
+	if (newTile >= 0)
+	{
+		UpdateEmission(grid, newTile);
+	}
+}
+
+// Changes the colour of a light.
+void LightField::SetLightColor(const LevelGrid& grid, int id, LightColor color)
+{
+	Light& light = m_lights[id];
+
+	if ((light.color.red == color.red) && (light.color.green == color.green) && (light.color.blue == color.blue))
+	{
+		return;
+	}
+
+	light.color = color;
+	m_lastVisitCount = 0;
+
+	if (light.tile >= 0)
+	{
+		UpdateEmission(grid, light.tile);
+	}
+}
+
+// Removes a light.
+void LightField::RemoveLight(const LevelGrid& grid, int id)
+{
+	m_freeIds.push_back(id);
+	m_lastVisitCount = 0;
+
+	if (m_lights[id].tile >= 0)
+	{
+		UnlinkLight(id);
+		UpdateEmission(grid, m_lights[id].tile);
+	}
+}
+
+// Brings a tile up to date after it became passable or blocked.
+void LightField::UpdateTile(const LevelGrid& grid, int columnIndex, int rowIndex)
+{
+	if ((columnIndex < 0) || (columnIndex >= m_width) || (rowIndex < 0) || (rowIndex >= m_height))
+	{
+		return;
+	}
+
+	int tile = (rowIndex * m_width) + columnIndex;
+	bool isPassable = IsPassable(grid, tile);
+	int neighbors[4];
+	int neighborCount = GetNeighbors(tile, neighbors);
+
+	m_lastVisitCount = 0;
+
+	for (int channel = 0; channel < LIGHT_CHANNEL_COUNT; ++channel)
+	{
+		if (isPassable)
+		{
+			// The tile can now carry the light around it.
+			const std::uint8_t* levels = &m_levels[static_cast<size_t>(channel) * m_width * m_height];
+			m_floodQueue.push_back(tile);
+
+			for (int n = 0; n < neighborCount; ++n)
+			{
+				if (levels[neighbors[n]] > 0)
+				{
+					m_floodQueue.push_back(neighbors[n]);
+				}
+			}
+		}
+		else
+		{
+			// The tile no longer carries light, so whatever it lit has to find another way.
+			ClearFrom(channel, tile);
+		}
+
+		Flood(grid, channel);
+	}
+}
+
+// Gets the light on a tile.
+LightColor LightField::GetLight(int columnIndex, int rowIndex) const
+{
+	if ((columnIndex < 0) || (columnIndex >= m_width) || (rowIndex < 0) || (rowIndex >= m_height))
+	{
+		return { 0, 0, 0 };
+	}
+
+	size_t tile = (static_cast<size_t>(rowIndex) * m_width) + columnIndex;
+	size_t channelSize = static_cast<size_t>(m_width) * m_height;
+
+	return { m_levels[tile], m_levels[channelSize + tile], m_levels[(2 * channelSize) + tile] };
+}
+
+// Gets the number of lights.
+int LightField::GetLightCount() const
+{
+	return static_cast<int>(m_lights.size() - m_freeIds.size());
+}
+
+// Gets the number of tiles the last change visited.
+int LightField::GetLastVisitCount() const
+{
+	return m_lastVisitCount;
+}
+
+// Gets the index of a tile.
+int LightField::GetTileIndex(GridCoord tile) const
+{
+	if ((tile.x < 0) || (tile.x >= m_width) || (tile.y < 0) || (tile.y >= m_height))
+	{
+		return -1;
+	}
+
+	return (tile.y * m_width) + tile.x;
+}
+
+// Adds a light to the list of lights on its tile.
+void LightField::LinkLight(int id)
+{
+	Light& light = m_lights[id];
+	light.nextLight = m_firstLights[light.tile];
+	m_firstLights[light.tile] = id;
+}
+
+// Removes a light from the list of lights on its tile.
+void LightField::UnlinkLight(int id)
+{
+	int* link = &m_firstLights[m_lights[id].tile];
+
+	while (*link != id)
+	{
+		link = &m_lights[*link].nextLight;
+	}
+
+	*link = m_lights[id].nextLight;
+	m_lights[id].nextLight = -1;
+}
+
+// Recomputes the light given off on a tile from the lights on it, and floods the difference.
+void LightField::UpdateEmission(const LevelGrid& grid, int tile)
+{
+	size_t channelSize = static_cast<size_t>(m_width) * m_height;
+
+	for (int channel = 0; channel < LIGHT_CHANNEL_COUNT; ++channel)
+	{
+		// Lights sharing a tile don't add up; the brightest wins.
+		int emission = 0;
+
+		for (int id = m_firstLights[tile]; id >= 0; id = m_lights[id].nextLight)
+		{
+			emission = std::max(emission, GetChannel(m_lights[id].color, channel));
+		}
+
+		std::uint8_t& tileEmission = m_emission[(channel * channelSize) + tile];
+		std::uint8_t& tileLevel = m_levels[(channel * channelSize) + tile];
+		int oldEmission = tileEmission;
+		tileEmission = static_cast<std::uint8_t>(std::min(emission, LIGHT_LEVEL_MAX));
+
+		if (tileEmission < oldEmission)
+		{
+			ClearFrom(channel, tile);
+		}
+		else if (tileEmission > tileLevel)
+		{
+			tileLevel = tileEmission;
+			m_floodQueue.push_back(tile);
+		}
+
+		Flood(grid, channel);
+	}
+}
+
+// Clears the light of one channel on a tile and every tile it lit, then queues what still lights them.
+void LightField::ClearFrom(int channel, int tile)
+{
+	size_t channelOffset = static_cast<size_t>(channel) * m_width * m_height;
+	std::uint8_t* levels = &m_levels[channelOffset];
+	const std::uint8_t* emission = &m_emission[channelOffset];
+
+	m_clearQueue.clear();
+	m_clearQueue.push_back({ tile, levels[tile] });
+	levels[tile] = 0;
+	m_floodQueue.push_back(tile);
+
+	// A tile only got its light from a cleared neighbour if it was dimmer. Those are cleared in turn. Brighter ones
+	// are lit from elsewhere, and flood back into the cleared area afterwards.
+	for (size_t head = 0; head < m_clearQueue.size(); ++head)
+	{
+		RemovedLight removed = m_clearQueue[head];
+		int neighbors[4];
+		int neighborCount = GetNeighbors(removed.tile, neighbors);
+		++m_lastVisitCount;
+
+		for (int n = 0; n < neighborCount; ++n)
+		{
+			int neighbor = neighbors[n];
+			int level = levels[neighbor];
+
+			if (level == 0)
+			{
+				continue;
+			}
+
+			if (level < removed.level)
+			{
+				m_clearQueue.push_back({ neighbor, level });
+				levels[neighbor] = 0;
+
+				if (emission[neighbor] > 0)
+				{
+					m_floodQueue.push_back(neighbor);
+				}
+			}
+			else
+			{
+				m_floodQueue.push_back(neighbor);
+			}
+		}
+	}
+
+	// Lights inside the cleared area start shining again once it's all dark, so nothing is cleared twice.
+	for (int queued : m_floodQueue)
+	{
+		levels[queued] = std::max(levels[queued], emission[queued]);
+	}
+}
+
+// Floods one channel outwards from every queued tile.
+void LightField::Flood(const LevelGrid& grid, int channel)
+{
+	std::uint8_t* levels = &m_levels[static_cast<size_t>(channel) * m_width * m_height];
+
+	for (size_t head = 0; head < m_floodQueue.size(); ++head)
+	{
+		int tile = m_floodQueue[head];
+		int spreadLevel = levels[tile] - 1;
+		++m_lastVisitCount;
+
+		if (spreadLevel <= 0)
+		{
+			continue;
+		}
+
+		int neighbors[4];
+		int neighborCount = GetNeighbors(tile, neighbors);
+
+		for (int n = 0; n < neighborCount; ++n)
+		{
+			int neighbor = neighbors[n];
+
+			if ((levels[neighbor] < spreadLevel) && (IsPassable(grid, neighbor)))
+			{
+				levels[neighbor] = static_cast<std::uint8_t>(spreadLevel);
+				m_floodQueue.push_back(neighbor);
+			}
+		}
+	}
+
+	m_floodQueue.clear();
+}
+
+// Checks if light can pass through a tile.
+bool LightField::IsPassable(const LevelGrid& grid, int tile) const
+{
+	int rowIndex = tile / m_width;
+	int columnIndex = tile - (rowIndex * m_width);
+
+	return ((grid.GetSolidRow(rowIndex)[columnIndex >> 6] >> (columnIndex & 63)) & 1) == 0;
+}
+
+// Gets the tiles next to a tile that are on the grid.
+int LightField::GetNeighbors(int tile, int* neighbors) const
+{
+	int rowIndex = tile / m_width;
+	int columnIndex = tile - (rowIndex * m_width);
+	int count = 0;
+
+	if (rowIndex > 0)
+	{
+		neighbors[count++] = tile - m_width;
+	}
+
+	if (columnIndex < m_width - 1)
+	{
+		neighbors[count++] = tile + 1;
+	}
+
+	if (rowIndex < m_height - 1)
+	{
+		neighbors[count++] = tile + m_width;
+	}
+
+	if (columnIndex > 0)
+	{
+		neighbors[count++] = tile - 1;
+	}
+
+	return count;
+}
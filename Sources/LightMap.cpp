@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cmath>
+#include "LightMap.h"
+
+// Default constructor.
+LightMap::LightMap() :
+m_left(0.f),
+m_top(0.f),
+m_cellSize(1.f),
+m_columns(0),
+m_rows(0),
+m_playerCells({ 0, 0, -1, -1 })
+{
+	m_torchCellStarts.push_back(0);
+}
+
+// Lays the grid over an area and removes every torch.
+void LightMap::Reset(float left, float top, float cellSize, int columns, int rows)
+{
+	m_left = left;
+	m_top = top;
+	m_cellSize = (cellSize > 0.f) ? cellSize : 1.f;
+	m_columns = std::max(columns, 0);
+	m_rows = std::max(rows, 0);
+
+	m_playerDarkness.assign(static_cast<size_t>(m_columns) * m_rows, LIGHT_MAX_DARKNESS);
+	m_torchFactors.assign(static_cast<size_t>(m_columns) * m_rows, 1.f);
+	m_columnDistances.resize(m_columns);
+	m_playerCells = { 0, 0, -1, -1 };
+
+	ClearTorches();
+}
+
+// Removes every torch, keeping the grid.
+void LightMap::ClearTorches()
+{
+	for (int cell : m_bakedCells)
+	{
+		m_torchFactors[cell] = 1.f;
+	}
+
+	m_torchCellStarts.assign(1, 0);
+	m_bakedCells.clear();
+	m_bakedShares.clear();
+}
+
+// Adds a torch, baking its share of the darkness of every cell it lights.
+int LightMap::AddTorch(float x, float y, const FieldOfView* view)
+{
+	CellRange cells = GetCellRange(x, y, TORCH_LIGHT_RADIUS);
+	float radiusSquared = TORCH_LIGHT_RADIUS * TORCH_LIGHT_RADIUS;
+
+	for (int row = cells.firstRow; row <= cells.lastRow; ++row)
+	{
+		float dy = (m_top + (row * m_cellSize)) - y;
+
+		for (int column = cells.firstColumn; column <= cells.lastColumn; ++column)
+		{
+			float dx = (m_left + (column * m_cellSize)) - x;
+			float distanceSquared = (dx * dx) + (dy * dy);
+
+			// The torch takes the most darkness at its own position, and none at the edge of its light or behind walls.
+			if ((distanceSquared < radiusSquared) && ((!view) || (view->IsCornerVisible(column, row))))
+			{
+				m_bakedCells.push_back((row * m_columns) + column);
+				m_bakedShares.push_back(1.f - (std::sqrt(distanceSquared) / TORCH_LIGHT_RADIUS));
+			}
+		}
+	}
+
+	m_torchCellStarts.push_back(static_cast<int>(m_bakedCells.size()));
+	return GetTorchCount() - 1;
+}
+
+// Brings the darkness of every cell up to date.
+void LightMap::Update(float playerX, float playerY, const float* torchBrightness, const FieldOfView* playerView)
+{
+	// Cells the player lit last time and doesn't reach any more go back to full darkness.
+	CellRange oldCells = m_playerCells;
+	m_playerCells = GetCellRange(playerX, playerY, PLAYER_LIGHT_OUTER_RADIUS);
+
+	for (int row = oldCells.firstRow; row <= oldCells.lastRow; ++row)
+	{
+		float* darkness = &m_playerDarkness[row * m_columns];
+
+		for (int column = oldCells.firstColumn; column <= oldCells.lastColumn; ++column)
+		{
+			darkness[column] = LIGHT_MAX_DARKNESS;
+		}
+	}
+
+	// The player's light fades linearly between the two radii. Only cells in the fade need a square root.
+	float innerSquared = PLAYER_LIGHT_INNER_RADIUS * PLAYER_LIGHT_INNER_RADIUS;
+	float outerSquared = PLAYER_LIGHT_OUTER_RADIUS * PLAYER_LIGHT_OUTER_RADIUS;
+	float fadeScale = LIGHT_MAX_DARKNESS / (PLAYER_LIGHT_OUTER_RADIUS - PLAYER_LIGHT_INNER_RADIUS);
+
+	for (int column = m_playerCells.firstColumn; column <= m_playerCells.lastColumn; ++column)
+	{
+		float dx = (m_left + (column * m_cellSize)) - playerX;
+		m_columnDistances[column] = dx * dx;
+	}
+
+	for (int row = m_playerCells.firstRow; row <= m_playerCells.lastRow; ++row)
+	{
+		float dy = (m_top + (row * m_cellSize)) - playerY;
+		float dySquared = dy * dy;
+		float* darkness = &m_playerDarkness[row * m_columns];
+
+		for (int column = m_playerCells.firstColumn; column <= m_playerCells.lastColumn; ++column)
+		{
+			float distanceSquared = m_columnDistances[column] + dySquared;
+
+			if ((playerView) && (!playerView->IsCornerVisible(column, row)))
+			{
+				darkness[column] = LIGHT_MAX_DARKNESS;
+			}
+			else if (distanceSquared < innerSquared)
+			{
+				darkness[column] = 0.f;
+			}
+			else if (distanceSquared < outerSquared)
+			{
+				darkness[column] = (std::sqrt(distanceSquared) - PLAYER_LIGHT_INNER_RADIUS) * fadeScale;
+			}
+			else
+			{
+				darkness[column] = LIGHT_MAX_DARKNESS;
+			}
+		}
+	}
+
+	// Apply each torch's flicker to its baked shares. Overlapping torches multiply, and no torch can make a cell
+	// darker than the player left it.
+	for (int cell : m_bakedCells)
+	{
+		m_torchFactors[cell] = 1.f;
+	}
+
+	for (int t = 0; t < GetTorchCount(); ++t)
+	{
+		float brightness = torchBrightness[t];
+
+		for (int b = m_torchCellStarts[t]; b < m_torchCellStarts[t + 1]; ++b)
+		{
+			m_torchFactors[m_bakedCells[b]] *= std::max(1.f - (m_bakedShares[b] * brightness), 0.f);
+		}
+	}
+}
+
+// Gets the darkness of a cell as of the last update.
+float LightMap::GetDarkness(int column, int row) const
+{
+	int cell = (row * m_columns) + column;
+	return m_playerDarkness[cell] * m_torchFactors[cell];
+}
+
+// Gets the number of cell columns.
+int LightMap::GetColumnCount() const
+{
+	return m_columns;
+}
+
+// Gets the number of cell rows.
+int LightMap::GetRowCount() const
+{
+	return m_rows;
+}
+
+// Gets the number of torches.
+int LightMap::GetTorchCount() const
+{
+	return static_cast<int>(m_torchCellStarts.size()) - 1;
+}
+
+// Gets the cells whose corner is within a distance of a point, clamped to the grid.
+LightMap::CellRange LightMap::GetCellRange(float x, float y, float radius) const
+{
+	CellRange cells;
+	cells.firstColumn = std::max(0, static_cast<int>(std::ceil((x - radius - m_left) / m_cellSize)));
+	cells.firstRow = std::max(0, static_cast<int>(std::ceil((y - radius - m_top) / m_cellSize)));
+	cells.lastColumn = std::min(m_columns - 1, static_cast<int>(std::floor((x + radius - m_left) / m_cellSize)));
+	cells.lastRow = std::min(m_rows - 1, static_cast<int>(std::floor((y + radius - m_top) / m_cellSize)));
+
+	return cells;
+}
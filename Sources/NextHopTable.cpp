@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <chrono>
+#include "NextHopTable.h"
+#include "BatchRunner.h"
+
+// Default constructor.
+NextHopTable::NextHopTable() :
+m_width(0),
+m_height(0),
+m_isDirty(true),
+m_nextTarget(0)
+{
+}
+
+// Rebuilds the table if it is out of date.
+bool NextHopTable::Update(const LevelGrid& grid, int threadCount)
+{
+	if (!Resize(grid))
+	{
+		return false;
+	}
+
+	if (!m_isDirty)
+	{
+		return true;
+	}
+
+	int width = m_width;
+	int tileCount = m_width * m_height;
+	m_isDirty = false;
+	m_nextTarget = tileCount;
+
+	// Every worker builds its own field, then copies it into the target's row of the table.
+	BatchRunner runner(threadCount);
+	std::vector<FlowField> fields(runner.GetThreadCount());
+
+	runner.Run(static_cast<std::uint64_t>(tileCount), [&](int workerIndex, std::uint64_t taskIndex)
+	{
+		int target = static_cast<int>(taskIndex);
+		FlowField& field = fields[workerIndex];
+
+		field.Invalidate();
+		field.Update(grid, { target % width, target / width });
+
+		const std::uint8_t* directions = field.GetDirections();
+		std::copy(directions, directions + tileCount, m_directions.begin() + (static_cast<size_t>(target) * tileCount));
+	});
+
+	return true;
+}
+
+// Carries on rebuilding the table for up to a time budget.
+bool NextHopTable::UpdateSliced(const LevelGrid& grid, double maxMicroseconds)
+{
+	if (!Resize(grid))
+	{
+		return false;
+	}
+
+	if (!m_isDirty)
+	{
+		return true;
+	}
+
+	int tileCount = m_width * m_height;
+	auto start = std::chrono::steady_clock::now();
+
+	while (m_nextTarget < tileCount)
+	{
+		m_field.Invalidate();
+		m_field.Update(grid, { m_nextTarget % m_width, m_nextTarget / m_width });
+
+		const std::uint8_t* directions = m_field.GetDirections();
+		std::copy(directions, directions + tileCount, m_directions.begin() + (static_cast<size_t>(m_nextTarget) * tileCount));
+		++m_nextTarget;
+
+		if ((maxMicroseconds > 0.0) && (std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() >= maxMicroseconds))
+		{
+			break;
+		}
+	}
+
+	m_isDirty = (m_nextTarget < tileCount);
+	return !m_isDirty;
+}
+
+// Marks the table as out of date.
+void NextHopTable::Invalidate()
+{
+	m_isDirty = true;
+	m_nextTarget = 0;
+}
+
+// Checks if the table is up to date.
+bool NextHopTable::IsReady() const
+{
+	return (!m_isDirty) && (m_width > 0);
+}
+
+// Gets the tile to step to from one tile to get closer to another.
+bool NextHopTable::GetNextStep(GridCoord from, GridCoord to, GridCoord& next) const
+{
+	int fromIndex = GetTileIndex(from);
+	int toIndex = GetTileIndex(to);
+
+	if ((fromIndex < 0) || (toIndex < 0))
+	{
+		return false;
+	}
+
+	std::uint8_t direction = m_directions[(static_cast<size_t>(toIndex) * (m_width * m_height)) + fromIndex];
+
+	if (direction == FLOW_NO_DIRECTION)
+	{
+		return false;
+	}
+
+	next = FlowField::Step(from, direction);
+	return true;
+}
+
+// Walks the table from one tile to another.
+bool NextHopTable::FindPath(GridCoord from, GridCoord to, std::vector<GridCoord>& path) const
+{
+	path.clear();
+
+	if ((GetTileIndex(from) < 0) || (GetTileIndex(to) < 0))
+	{
+		return false;
+	}
+
+	GridCoord tile = from;
+
+	while (tile != to)
+	{
+		if (!GetNextStep(tile, to, tile))
+		{
+			path.clear();
+			return false;
+		}
+
+		path.push_back(tile);
+	}
+
+	return true;
+}
+
+// Gets the memory the table takes.
+size_t NextHopTable::GetByteCount() const
+{
+	return m_directions.size();
+}
+
+// Gets the index of a tile in the table.
+int NextHopTable::GetTileIndex(GridCoord tile) const
+{
+	if ((m_isDirty) || (static_cast<unsigned>(tile.x) >= static_cast<unsigned>(m_width)) || (static_cast<unsigned>(tile.y) >= static_cast<unsigned>(m_height)))
+	{
+		return -1;
+	}
+
+	return (tile.y * m_width) + tile.x;
+}
+
+// Sizes the table to a grid.
+bool NextHopTable::Resize(const LevelGrid& grid)
+{
+	int width = grid.GetWidth();
+	int height = grid.GetHeight();
+	int tileCount = width * height;
+
+	if (tileCount > NEXT_HOP_MAX_TILES)
+	{
+		m_width = 0;
+		m_height = 0;
+		m_directions.clear();
+		return false;
+	}
+
+	if ((width != m_width) || (height != m_height))
+	{
+		m_width = width;
+		m_height = height;
+		m_directions.resize(static_cast<size_t>(tileCount) * tileCount);
+		Invalidate();
+	}
+
+	return true;
+}
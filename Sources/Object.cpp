@@ -10,6 +10,7 @@ m_frameCount(0),
 m_currentFrame(0),
 m_frameWidth(0),
 m_frameHeight(0),
+m_frameOrigin(0, 0),
 m_timeDelta(0)
 {
 }
@@ -17,8 +18,20 @@ m_timeDelta(0)
 // Gives the object the given sprite.
 bool Object::SetSprite(sf::Texture& texture, bool isSmooth, int frames, int frameSpeed)
 {
-	// Create a sprite from the loaded texture.
-	m_sprite.setTexture(texture);
+	sf::Vector2u texSize = texture.getSize();
+	return SetSprite(TextureRegion{ &texture, sf::IntRect(0, 0, texSize.x, texSize.y), -1 }, isSmooth, frames, frameSpeed);
+}
+
+// Gives the object the sprite held in a region of a texture.
+bool Object::SetSprite(const TextureRegion& region, bool isSmooth, int frames, int frameSpeed)
+{
+	if (!region.texture)
+	{
+		return false;
+	}
+
+	// Create a sprite from the texture.
+	m_sprite.setTexture(*region.texture);
 
 	// Set animation speed.
 	m_animationSpeed = frameSpeed;
@@ -27,24 +40,16 @@ bool Object::SetSprite(sf::Texture& texture, bool isSmooth, int frames, int fram
 	m_frameCount = frames;
 
 	// Calculate frame dimensions.
-	sf::Vector2u texSize = m_sprite.getTexture()->getSize();
-	m_frameWidth = texSize.x / m_frameCount;
-	m_frameHeight = texSize.y;
+	m_frameOrigin = sf::Vector2i(region.rect.left, region.rect.top);
+	m_frameWidth = region.rect.width / m_frameCount;
+	m_frameHeight = region.rect.height;
 
-	// Check if animated or static.
-	if (frames > 1)
-	{
-		// Set sprite as animated.
-		m_isAnimated = true;
+	// Set the sprite as animated if it has more than one frame.
+	m_isAnimated = (frames > 1);
+	m_currentFrame = 0;
 
-		// Set the texture rect of the first frame.
-		m_sprite.setTextureRect(sf::IntRect(0, 0, m_frameWidth, m_frameHeight));
-	}
-	else
-	{
-		// Set sprite as non animated.
-		m_isAnimated = false;
-	}
+	// Set the texture rect of the first frame. The texture may be shared, so this is needed even without animation.
+	m_sprite.setTextureRect(sf::IntRect(m_frameOrigin.x, m_frameOrigin.y, m_frameWidth, m_frameHeight));
 
 	// Set the origin of the sprite.
 	m_sprite.setOrigin(m_frameWidth / 2.f, m_frameHeight / 2.f);
@@ -52,6 +57,19 @@ bool Object::SetSprite(sf::Texture& texture, bool isSmooth, int frames, int fram
 	return true;
 }
 
+// Swaps the sprite's frames for another strip, keeping the current frame.
+void Object::SetFrameRegion(const TextureRegion& region)
+{
+	if (!region.texture)
+	{
+		return;
+	}
+
+	m_sprite.setTexture(*region.texture);
+	m_frameOrigin = sf::Vector2i(region.rect.left, region.rect.top);
+	m_sprite.setTextureRect(sf::IntRect(m_frameOrigin.x + (m_frameWidth * m_currentFrame), m_frameOrigin.y, m_frameWidth, m_frameHeight));
+}
+
 // Returns the object's sprite.
 sf::Sprite& Object::GetSprite()
 {
@@ -90,7 +108,7 @@ void Object::SetAnimated(bool isAnimated)
 	else
 	{
 		// set the texture rect of the first frame
-		m_sprite.setTextureRect(sf::IntRect(0, 0, m_frameWidth, m_frameHeight));
+		m_sprite.setTextureRect(sf::IntRect(m_frameOrigin.x, m_frameOrigin.y, m_frameWidth, m_frameHeight));
 	}
 }
 
@@ -124,7 +142,7 @@ void Object::NextFrame()
 		m_currentFrame++;
 
 	// update the texture rect
-	m_sprite.setTextureRect(sf::IntRect(m_frameWidth * m_currentFrame, 0, m_frameWidth, m_frameHeight));
+	m_sprite.setTextureRect(sf::IntRect(m_frameOrigin.x + (m_frameWidth * m_currentFrame), m_frameOrigin.y, m_frameWidth, m_frameHeight));
 }
 
 // Gets the frame count of the object.
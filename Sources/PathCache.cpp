@@ -0,0 +1,149 @@
+#include "PathCache.h"
+#include "Random.h"
+
+// Default constructor.
+PathCache::PathCache() :
+m_width(0),
+m_height(0),
+m_regionColumns(0),
+m_slots(PATH_CACHE_SLOT_COUNT)
+{
+	ClearStats();
+}
+
+// Sizes the cache for a grid and forgets every stored path.
+void PathCache::Reset(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_regionColumns = (width + PATH_CACHE_REGION_SIZE - 1) / PATH_CACHE_REGION_SIZE;
+
+	int regionRows = (height + PATH_CACHE_REGION_SIZE - 1) / PATH_CACHE_REGION_SIZE;
+	m_regionVersions.assign(static_cast<size_t>(m_regionColumns) * regionRows, 0);
+
+	for (Slot& slot : m_slots)
+	{
+		slot.isValid = false;
+	}
+}
+
+// Bumps the walkability version of the region a tile is in.
+void PathCache::OnTileChanged(int columnIndex, int rowIndex)
+{
+	if ((static_cast<unsigned>(columnIndex) < static_cast<unsigned>(m_width)) && (static_cast<unsigned>(rowIndex) < static_cast<unsigned>(m_height)))
+	{
+		++m_regionVersions[GetRegionIndex({ columnIndex, rowIndex })];
+	}
+}
+
+// Looks up a stored path.
+bool PathCache::Lookup(GridCoord start, GridCoord goal, std::vector<GridCoord>& path)
+{
+	Slot& slot = GetSlot(start, goal);
+
+	if ((!slot.isValid) || (slot.start != start) || (slot.goal != goal))
+	{
+		++m_stats.missCount;
+		return false;
+	}
+
+	for (const RegionVersion& region : slot.regions)
+	{
+		if (m_regionVersions[region.region] != region.version)
+		{
+			slot.isValid = false;
+			++m_stats.staleCount;
+			return false;
+		}
+	}
+
+	path.assign(slot.path.begin(), slot.path.end());
+	++m_stats.hitCount;
+	return true;
+}
+
+// Stores a path found by a search.
+void PathCache::Store(GridCoord start, GridCoord goal, const std::vector<GridCoord>& path, double searchMicroseconds)
+{
+	m_stats.searchMicroseconds += searchMicroseconds;
+	++m_stats.storeCount;
+
+	if ((static_cast<unsigned>(start.x) >= static_cast<unsigned>(m_width)) || (static_cast<unsigned>(start.y) >= static_cast<unsigned>(m_height)))
+	{
+		return;
+	}
+
+	Slot& slot = GetSlot(start, goal);
+	slot.isValid = true;
+	slot.start = start;
+	slot.goal = goal;
+	slot.path.assign(path.begin(), path.end());
+	slot.regions.clear();
+
+	AddRegion(slot, start);
+	GridCoord previous = start;
+
+	for (const GridCoord& tile : path)
+	{
+		// A diagonal step also depends on the two tiles at its corners, which can lie in other regions.
+		if ((tile.x != previous.x) && (tile.y != previous.y))
+		{
+			AddRegion(slot, { tile.x, previous.y });
+			AddRegion(slot, { previous.x, tile.y });
+		}
+
+		AddRegion(slot, tile);
+		previous = tile;
+	}
+}
+
+// Gets the counters.
+const PathCacheStats& PathCache::GetStats() const
+{
+	return m_stats;
+}
+
+// Estimates the search time hits have saved.
+double PathCache::GetSavedMicroseconds() const
+{
+	if (m_stats.storeCount == 0)
+	{
+		return 0.0;
+	}
+
+	return (m_stats.searchMicroseconds / m_stats.storeCount) * m_stats.hitCount;
+}
+
+// Clears the counters.
+void PathCache::ClearStats()
+{
+	m_stats = PathCacheStats{ 0, 0, 0, 0.0, 0 };
+}
+
+// Gets the slot a tile pair is stored in.
+PathCache::Slot& PathCache::GetSlot(GridCoord start, GridCoord goal)
+{
+	std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint16_t>(start.x)) << 48) |
+		(static_cast<std::uint64_t>(static_cast<std::uint16_t>(start.y)) << 32) |
+		(static_cast<std::uint64_t>(static_cast<std::uint16_t>(goal.x)) << 16) |
+		static_cast<std::uint64_t>(static_cast<std::uint16_t>(goal.y));
+
+	return m_slots[Random::Mix(key) % m_slots.size()];
+}
+
+// Gets the region a tile is in.
+int PathCache::GetRegionIndex(GridCoord tile) const
+{
+	return ((tile.y / PATH_CACHE_REGION_SIZE) * m_regionColumns) + (tile.x / PATH_CACHE_REGION_SIZE);
+}
+
+// Adds the region a tile is in to a slot, unless it is already the last one added.
+void PathCache::AddRegion(Slot& slot, GridCoord tile) const
+{
+	int region = GetRegionIndex(tile);
+
+	if ((slot.regions.empty()) || (slot.regions.back().region != region))
+	{
+		slot.regions.push_back({ region, m_regionVersions[region] });
+	}
+}
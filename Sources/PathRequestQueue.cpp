@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <chrono>
+#include "PathRequestQueue.h"
+
+// Default constructor.
+PathRequestQueue::PathRequestQueue() :
+m_activeTicket(INVALID_PATH_TICKET),
+m_restartActive(false),
+m_nextOrder(0),
+m_lastExpandedNodeCount(0)
+{
+}
+
+// Submits a path request.
+PathTicket PathRequestQueue::Submit(GridCoord start, GridCoord goal, float priority)
+{
+	int slot;
+
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		// Slot indices have to fit in the low 16 bits of a ticket.
+		if (m_requests.size() >= 0xFFFF)
+		{
+			return INVALID_PATH_TICKET;
+		}
+
+		slot = static_cast<int>(m_requests.size());
+		m_requests.push_back(Request{ 0, PATH_REQUEST_STATUS::INVALID, { 0, 0 }, { 0, 0 }, std::vector<GridCoord>() });
+	}
+
+	Request& request = m_requests[slot];
+	request.serial = static_cast<std::uint16_t>(request.serial + 1);
+	request.status = PATH_REQUEST_STATUS::PENDING;
+	request.start = start;
+	request.goal = goal;
+	request.path.clear();
+
+	PathTicket ticket = (static_cast<PathTicket>(request.serial) << 16) | static_cast<PathTicket>(slot + 1);
+
+	m_pending.push_back({ priority, m_nextOrder++, ticket });
+	std::push_heap(m_pending.begin(), m_pending.end(), PendingRequestCompare());
+
+	return ticket;
+}
+
+// Cancels a request.
+void PathRequestQueue::Cancel(PathTicket ticket)
+{
+	if (GetRequest(ticket) != nullptr)
+	{
+		// A cancelled request left in the pending heap is skipped when it reaches the top.
+		Release(ticket);
+	}
+}
+
+// Gets the state of a request.
+PATH_REQUEST_STATUS PathRequestQueue::GetStatus(PathTicket ticket) const
+{
+	const Request* request = GetRequest(ticket);
+	return (request != nullptr) ? request->status : PATH_REQUEST_STATUS::INVALID;
+}
+
+// Takes the result of a finished request.
+bool PathRequestQueue::TakeResult(PathTicket ticket, std::vector<GridCoord>& path)
+{
+	path.clear();
+	Request* request = GetRequest(ticket);
+
+	if ((request == nullptr) || (request->status == PATH_REQUEST_STATUS::PENDING) || (request->status == PATH_REQUEST_STATUS::SEARCHING))
+	{
+		return false;
+	}
+
+	bool isFound = (request->status == PATH_REQUEST_STATUS::FOUND);
+
+	if (isFound)
+	{
+		path.assign(request->path.begin(), request->path.end());
+	}
+
+	Release(ticket);
+	return isFound;
+}
+
+// Works through the requests until the frame's budget is spent.
+void PathRequestQueue::Update(const LevelGrid& grid, int maxExpansions, double maxMicroseconds)
+{
+	auto start = std::chrono::steady_clock::now();
+	int expansions = 0;
+
+	m_lastExpandedNodeCount = 0;
+
+	while (expansions < maxExpansions)
+	{
+		if (maxMicroseconds > 0.0)
+		{
+			double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			if (elapsed >= maxMicroseconds)
+			{
+				break;
+			}
+		}
+
+		Request* active = GetRequest(m_activeTicket);
+
+		// The active request may have been cancelled since the last slice.
+		if (active == nullptr)
+		{
+			m_activeTicket = INVALID_PATH_TICKET;
+
+			if (m_pending.empty())
+			{
+				break;
+			}
+
+			std::pop_heap(m_pending.begin(), m_pending.end(), PendingRequestCompare());
+			PathTicket ticket = m_pending.back().ticket;
+			m_pending.pop_back();
+
+			active = GetRequest(ticket);
+
+			if (active == nullptr)
+			{
+				continue;
+			}
+
+			m_activeTicket = ticket;
+			m_restartActive = true;
+		}
+
+		PATH_STATUS status = PATH_STATUS::SEARCHING;
+
+		if (m_restartActive)
+		{
+			active->status = PATH_REQUEST_STATUS::SEARCHING;
+			status = m_pathfinder.BeginSearch(grid, active->start, active->goal);
+			m_restartActive = false;
+		}
+
+		if (status == PATH_STATUS::SEARCHING)
+		{
+			int expandedBefore = m_pathfinder.GetExpandedNodeCount();
+			int slice = std::min(PATH_REQUEST_SLICE_SIZE, maxExpansions - expansions);
+
+			status = m_pathfinder.ContinueSearch(grid, slice, active->path);
+
+			// Count at least one expansion per slice, so a search that only pops stale entries still uses budget.
+			expansions += std::max(1, m_pathfinder.GetExpandedNodeCount() - expandedBefore);
+		}
+
+		if (status != PATH_STATUS::SEARCHING)
+		{
+			active->status = (status == PATH_STATUS::FOUND) ? PATH_REQUEST_STATUS::FOUND : PATH_REQUEST_STATUS::NOT_FOUND;
+			m_activeTicket = INVALID_PATH_TICKET;
+		}
+	}
+
+	m_lastExpandedNodeCount = expansions;
+}
+
+// Restarts the search in progress.
+void PathRequestQueue::OnGridChanged()
+{
+	m_restartActive = (m_activeTicket != INVALID_PATH_TICKET);
+}
+
+// Gets the number of unfinished requests.
+int PathRequestQueue::GetPendingCount() const
+{
+	int pendingCount = 0;
+
+	for (const Request& request : m_requests)
+	{
+		if ((request.status == PATH_REQUEST_STATUS::PENDING) || (request.status == PATH_REQUEST_STATUS::SEARCHING))
+		{
+			++pendingCount;
+		}
+	}
+
+	return pendingCount;
+}
+
+// Gets the number of nodes the last update expanded.
+int PathRequestQueue::GetLastExpandedNodeCount() const
+{
+	return m_lastExpandedNodeCount;
+}
+
+// Gets the request a ticket refers to.
+PathRequestQueue::Request* PathRequestQueue::GetRequest(PathTicket ticket)
+{
+	return const_cast<Request*>(static_cast<const PathRequestQueue*>(this)->GetRequest(ticket));
+}
+
+// Gets the request a ticket refers to.
+const PathRequestQueue::Request* PathRequestQueue::GetRequest(PathTicket ticket) const
+{
+	int slot = static_cast<int>(ticket & 0xFFFF) - 1;
+
+	if ((slot < 0) || (slot >= static_cast<int>(m_requests.size())))
+	{
+		return nullptr;
+	}
+
+	const Request& request = m_requests[slot];
+
+	if ((request.serial != (ticket >> 16)) || (request.status == PATH_REQUEST_STATUS::INVALID))
+	{
+		return nullptr;
+	}
+
+	return &request;
+}
+
+// Releases a request's slot so it can be reused.
+void PathRequestQueue::Release(PathTicket ticket)
+{
+	int slot = static_cast<int>(ticket & 0xFFFF) - 1;
+
+	m_requests[slot].status = PATH_REQUEST_STATUS::INVALID;
+	m_freeSlots.push_back(slot);
+
+	if (ticket == m_activeTicket)
+	{
+		m_activeTicket = INVALID_PATH_TICKET;
+	}
+}
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <climits>
+#include "Pathfinder.h"
+#include "Util.h"
+
+// Default constructor.
+Pathfinder::Pathfinder() :
+m_generation(0),
+m_expandedNodeCount(0),
+m_status(PATH_STATUS::NOT_FOUND),
+m_start({ -1, -1 }),
+m_goal({ -1, -1 })
+{
+}
+
+// Sizes the node pool and open list.
+void Pathfinder::Reserve(int tileCount)
+{
+	if (static_cast<int>(m_scratch.stamp.size()) < tileCount)
+	{
+		m_scratch.Resize(tileCount);
+		m_generation = 0;
+	}
+
+	// Nodes can be pushed more than once, but rarely more than a few times.
+	if (static_cast<int>(m_open.capacity()) < tileCount * 2)
+	{
+		m_open.reserve(static_cast<size_t>(tileCount) * 2);
+	}
+}
+
+// Finds the shortest path between two tiles.
+bool Pathfinder::FindPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path)
+{
+	path.clear();
+
+	PATH_STATUS status = BeginSearch(grid, start, goal);
+
+	if (status == PATH_STATUS::SEARCHING)
+	{
+		status = ContinueSearch(grid, grid.GetWidth() * grid.GetHeight(), path);
+	}
+
+	return (status == PATH_STATUS::FOUND);
+}
+
+// Starts an A* search that is run in slices.
+PATH_STATUS Pathfinder::BeginSearch(const LevelGrid& grid, GridCoord start, GridCoord goal)
+{
+	m_expandedNodeCount = 0;
+	m_start = start;
+	m_goal = goal;
+	m_open.clear();
+
+	if ((!grid.TileIsValid(start.x, start.y)) || (!grid.TileIsValid(goal.x, goal.y)) || (grid.IsSolid(goal.x, goal.y)))
+	{
+		m_status = PATH_STATUS::NOT_FOUND;
+		return m_status;
+	}
+
+	if (start == goal)
+	{
+		m_status = PATH_STATUS::FOUND;
+		return m_status;
+	}
+
+	int width = grid.GetWidth();
+	Reserve(width * grid.GetHeight());
+	NextGeneration();
+
+	int startNode = (start.y * width) + start.x;
+
+	m_scratch.H[startNode] = GetHeuristic(start, goal);
+	m_scratch.G[startNode] = 0;
+	m_scratch.F[startNode] = m_scratch.H[startNode];
+	m_scratch.parentNode[startNode] = -1;
+	m_scratch.stamp[startNode] = m_generation;
+
+	m_open.push_back({ m_scratch.F[startNode], m_scratch.H[startNode], startNode });
+
+	m_status = PATH_STATUS::SEARCHING;
+	return m_status;
+}
+
+// Runs the current search for up to a number of node expansions.
+PATH_STATUS Pathfinder::ContinueSearch(const LevelGrid& grid, int maxExpansions, std::vector<GridCoord>& path)
+{
+	static const int columnOffsets[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	static const int rowOffsets[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+	path.clear();
+
+	if (m_status != PATH_STATUS::SEARCHING)
+	{
+		return m_status;
+	}
+
+	int width = grid.GetWidth();
+	std::uint32_t openStamp = m_generation;
+	std::uint32_t closedStamp = m_generation + 1;
+
+	int* H = m_scratch.H.data();
+	int* G = m_scratch.G.data();
+	int* F = m_scratch.F.data();
+	int* parentNode = m_scratch.parentNode.data();
+	std::uint32_t* stamp = m_scratch.stamp.data();
+
+	int startNode = (m_start.y * width) + m_start.x;
+	int goalNode = (m_goal.y * width) + m_goal.x;
+	int expansionLimit = (maxExpansions > INT_MAX - m_expandedNodeCount) ? INT_MAX : (m_expandedNodeCount + maxExpansions);
+
+	while (!m_open.empty())
+	{
+		if (m_expandedNodeCount >= expansionLimit)
+		{
+			return m_status;
+		}
+
+		std::pop_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+		OpenNode current = m_open.back();
+		m_open.pop_back();
+
+		// Skip entries that were superseded by a cheaper route, or whose node is already closed.
+		if ((stamp[current.node] == closedStamp) || (current.F != F[current.node]))
+		{
+			continue;
+		}
+
+		stamp[current.node] = closedStamp;
+		++m_expandedNodeCount;
+
+		if (current.node == goalNode)
+		{
+			// Walk back along the parents, then flip the path so it starts next to the start tile.
+			for (int node = goalNode; node != startNode; node = parentNode[node])
+			{
+				path.push_back({ node % width, node / width });
+			}
+
+			std::reverse(path.begin(), path.end());
+			m_status = PATH_STATUS::FOUND;
+			return m_status;
+		}
+
+		int column = current.node % width;
+		int row = current.node / width;
+
+		for (int n = 0; n < 8; ++n)
+		{
+			int nextColumn = column + columnOffsets[n];
+			int nextRow = row + rowOffsets[n];
+
+			if ((!grid.TileIsValid(nextColumn, nextRow)) || (grid.IsSolid(nextColumn, nextRow)))
+			{
+				continue;
+			}
+
+			bool isDiagonal = (n >= 4);
+
+			// Diagonal moves need both tiles they pass between to be open, so paths can't clip wall corners.
+			if ((isDiagonal) && ((grid.IsSolid(nextColumn, row)) || (grid.IsSolid(column, nextRow))))
+			{
+				continue;
+			}
+
+			int next = (nextRow * width) + nextColumn;
+
+			if (stamp[next] == closedStamp)
+			{
+				continue;
+			}
+
+			int cost = G[current.node] + (isDiagonal ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST);
+
+			if ((stamp[next] != openStamp) || (cost < G[next]))
+			{
+				if (stamp[next] != openStamp)
+				{
+					H[next] = GetHeuristic({ nextColumn, nextRow }, m_goal);
+					stamp[next] = openStamp;
+				}
+
+				G[next] = cost;
+				F[next] = cost + H[next];
+				parentNode[next] = current.node;
+
+				m_open.push_back({ F[next], H[next], next });
+				std::push_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+			}
+		}
+	}
+
+	m_status = PATH_STATUS::NOT_FOUND;
+	return m_status;
+}
+
+// Finds the shortest path between two tiles with Jump Point Search.
+bool Pathfinder::FindJumpPointPath(const LevelGrid& grid, GridCoord start, GridCoord goal, std::vector<GridCoord>& path)
+{
+	static const int columnOffsets[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	static const int rowOffsets[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+	path.clear();
+	m_expandedNodeCount = 0;
+
+	// The jump point search shares the scratch arrays, so a sliced search can't be continued after it.
+	m_status = PATH_STATUS::NOT_FOUND;
+
+	if ((!grid.TileIsValid(start.x, start.y)) || (!grid.TileIsValid(goal.x, goal.y)) || (grid.IsSolid(goal.x, goal.y)))
+	{
+		return false;
+	}
+
+	if (start == goal)
+	{
+		return true;
+	}
+
+	int width = grid.GetWidth();
+	Reserve(width * grid.GetHeight());
+	NextGeneration();
+
+	std::uint32_t openStamp = m_generation;
+	std::uint32_t closedStamp = m_generation + 1;
+
+	int* H = m_scratch.H.data();
+	int* G = m_scratch.G.data();
+	int* F = m_scratch.F.data();
+	int* parentNode = m_scratch.parentNode.data();
+	std::uint32_t* stamp = m_scratch.stamp.data();
+
+	int startNode = (start.y * width) + start.x;
+	int goalNode = (goal.y * width) + goal.x;
+
+	H[startNode] = GetHeuristic(start, goal);
+	G[startNode] = 0;
+	F[startNode] = H[startNode];
+	parentNode[startNode] = -1;
+	stamp[startNode] = openStamp;
+
+	m_open.clear();
+	m_open.push_back({ F[startNode], H[startNode], startNode });
+
+	while (!m_open.empty())
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+		OpenNode current = m_open.back();
+		m_open.pop_back();
+
+		// Skip entries that were superseded by a cheaper route, or whose node is already closed.
+		if ((stamp[current.node] == closedStamp) || (current.F != F[current.node]))
+		{
+			continue;
+		}
+
+		stamp[current.node] = closedStamp;
+		++m_expandedNodeCount;
+
+		if (current.node == goalNode)
+		{
+			// Walk back along the jump points, filling in the straight or diagonal run of tiles between each pair.
+			for (int node = goalNode; node != startNode; node = parentNode[node])
+			{
+				GridCoord tile = { node % width, node / width };
+				GridCoord parent = { parentNode[node] % width, parentNode[node] / width };
+				int columnStep = (parent.x > tile.x) ? 1 : ((parent.x < tile.x) ? -1 : 0);
+				int rowStep = (parent.y > tile.y) ? 1 : ((parent.y < tile.y) ? -1 : 0);
+
+				for (; tile != parent; tile = { tile.x + columnStep, tile.y + rowStep })
+				{
+					path.push_back(tile);
+				}
+			}
+
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		GridCoord tile = { current.node % width, current.node / width };
+		int directions[8];
+		int directionCount = 0;
+
+		if (parentNode[current.node] < 0)
+		{
+			for (int n = 0; n < 8; ++n)
+			{
+				directions[directionCount++] = n;
+			}
+		}
+		else
+		{
+			// Only look on in the direction of travel, plus the sides a straight move may have to turn into.
+			int parent = parentNode[current.node];
+			int columnStep = (tile.x > parent % width) ? 1 : ((tile.x < parent % width) ? -1 : 0);
+			int rowStep = (tile.y > parent / width) ? 1 : ((tile.y < parent / width) ? -1 : 0);
+
+			for (int n = 0; n < 8; ++n)
+			{
+				bool isForward = (columnOffsets[n] == columnStep) && (rowOffsets[n] == rowStep);
+				bool isDiagonalTurn = (columnStep != 0) && (rowStep != 0) && (((columnOffsets[n] == columnStep) && (rowOffsets[n] == 0)) || ((columnOffsets[n] == 0) && (rowOffsets[n] == rowStep)));
+				bool isStraightTurn = ((columnStep == 0) || (rowStep == 0)) && (((columnStep != 0) && (columnOffsets[n] != -columnStep) && (rowOffsets[n] != 0)) || ((rowStep != 0) && (rowOffsets[n] != -rowStep) && (columnOffsets[n] != 0)));
+
+				if ((isForward) || (isDiagonalTurn) || (isStraightTurn))
+				{
+					directions[directionCount++] = n;
+				}
+			}
+		}
+
+		for (int d = 0; d < directionCount; ++d)
+		{
+			GridCoord jumpPoint;
+
+			if (!Jump(grid, tile, columnOffsets[directions[d]], rowOffsets[directions[d]], goal, jumpPoint))
+			{
+				continue;
+			}
+
+			int next = (jumpPoint.y * width) + jumpPoint.x;
+
+			if (stamp[next] == closedStamp)
+			{
+				continue;
+			}
+
+			// Jump points lie on a straight or diagonal line from the tile, so the octile distance is the exact cost.
+			int cost = G[current.node] + GetHeuristic(tile, jumpPoint);
+
+			if ((stamp[next] != openStamp) || (cost < G[next]))
+			{
+				if (stamp[next] != openStamp)
+				{
+					H[next] = GetHeuristic(jumpPoint, goal);
+					stamp[next] = openStamp;
+				}
+
+				G[next] = cost;
+				F[next] = cost + H[next];
+				parentNode[next] = current.node;
+
+				m_open.push_back({ F[next], H[next], next });
+				std::push_heap(m_open.begin(), m_open.end(), OpenNodeCompare());
+			}
+		}
+	}
+
+	return false;
+}
+
+// Gets the number of nodes the last search expanded.
+int Pathfinder::GetExpandedNodeCount() const
+{
+	return m_expandedNodeCount;
+}
+
+// Gets the estimated cost between two tiles.
+int Pathfinder::GetHeuristic(GridCoord from, GridCoord to)
+{
+	int dx = (from.x > to.x) ? (from.x - to.x) : (to.x - from.x);
+	int dy = (from.y > to.y) ? (from.y - to.y) : (to.y - from.y);
+	int diagonal = (dx < dy) ? dx : dy;
+
+	// Take as many diagonal steps as possible, then go straight.
+	return (PATH_STRAIGHT_COST * (dx + dy)) + ((PATH_DIAGONAL_COST - (2 * PATH_STRAIGHT_COST)) * diagonal);
+}
+
+// Jumps from a tile in one direction until a jump point is found or the way is blocked.
+bool Pathfinder::Jump(const LevelGrid& grid, GridCoord from, int columnStep, int rowStep, GridCoord goal, GridCoord& jumpPoint)
+{
+	int width = grid.GetWidth();
+	int height = grid.GetHeight();
+
+	if (rowStep == 0)
+	{
+		int column = ScanLine(grid.GetSolidRow(from.y), (from.y > 0) ? grid.GetSolidRow(from.y - 1) : nullptr,
+			(from.y < height - 1) ? grid.GetSolidRow(from.y + 1) : nullptr, grid.GetWordsPerRow(), from.x, columnStep, (goal.y == from.y) ? goal.x : -1);
+
+		jumpPoint = { column, from.y };
+		return (column >= 0);
+	}
+
+	if (columnStep == 0)
+	{
+		int row = ScanLine(grid.GetSolidColumn(from.x), (from.x > 0) ? grid.GetSolidColumn(from.x - 1) : nullptr,
+			(from.x < width - 1) ? grid.GetSolidColumn(from.x + 1) : nullptr, grid.GetWordsPerColumn(), from.y, rowStep, (goal.x == from.x) ? goal.y : -1);
+
+		jumpPoint = { from.x, row };
+		return (row >= 0);
+	}
+
+	// Step diagonally until the goal, or a tile where a straight jump finds a jump point, or a blocked corner.
+	GridCoord tile = from;
+
+	for (;;)
+	{
+		GridCoord next = { tile.x + columnStep, tile.y + rowStep };
+
+		if ((!grid.TileIsValid(next.x, next.y)) || (grid.IsSolid(next.x, next.y)) || (grid.IsSolid(next.x, tile.y)) || (grid.IsSolid(tile.x, next.y)))
+		{
+			return false;
+		}
+
+		tile = next;
+		GridCoord straightJumpPoint;
+
+		if ((tile == goal) || (Jump(grid, tile, columnStep, 0, goal, straightJumpPoint)) || (Jump(grid, tile, 0, rowStep, goal, straightJumpPoint)))
+		{
+			jumpPoint = tile;
+			return true;
+		}
+	}
+}
+
+// Scans a straight line of a solidity bitmap for the next jump point.
+int Pathfinder::ScanLine(const std::uint64_t* line, const std::uint64_t* before, const std::uint64_t* after, int wordCount, int from, int step, int goal)
+{
+	int position = from + step;
+
+	if (position < 0)
+	{
+		return -1;
+	}
+
+	const std::uint64_t* sides[2] = { before, after };
+
+	for (int w = position >> 6; (w >= 0) && (w < wordCount); w += step)
+	{
+		std::uint64_t blocked = line[w];
+		std::uint64_t stops = blocked;
+
+		// A side tile that is open while the one behind it is solid forces a turn. Lines outside the grid count as solid.
+		for (int s = 0; s < 2; ++s)
+		{
+			if (sides[s] == nullptr)
+			{
+				continue;
+			}
+
+			std::uint64_t side = sides[s][w];
+			std::uint64_t behind;
+
+			if (step > 0)
+			{
+				behind = (side << 1) | ((w > 0) ? (sides[s][w - 1] >> 63) : 1ull);
+			}
+			else
+			{
+				behind = (side >> 1) | (((w + 1 < wordCount) ? (sides[s][w + 1] & 1ull) : 1ull) << 63);
+			}
+
+			stops |= ~side & behind;
+		}
+
+		if ((goal >= 0) && ((goal >> 6) == w))
+		{
+			stops |= 1ull << (goal & 63);
+		}
+
+		// Ignore the bits behind the start of the scan.
+		if (w == (position >> 6))
+		{
+			int bit = position & 63;
+			stops &= (step > 0) ? (~0ull << bit) : (~0ull >> (63 - bit));
+		}
+
+		if (stops != 0)
+		{
+			int bit = (step > 0) ? CountTrailingZeros(stops) : (63 - CountLeadingZeros(stops));
+			return (((blocked >> bit) & 1ull) != 0) ? -1 : ((w * 64) + bit);
+		}
+	}
+
+	return -1;
+}
+
+// Starts a new search generation.
+void Pathfinder::NextGeneration()
+{
+	// Each search uses two stamps. When they run out, clear the stamps once and start again.
+	if (m_generation >= 0xFFFFFFFDu)
+	{
+		std::fill(m_scratch.stamp.begin(), m_scratch.stamp.end(), 0);
+		m_generation = 0;
+	}
+
+	m_generation += 2;
+}
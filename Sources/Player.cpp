@@ -20,13 +20,13 @@ m_canTakeDamage(true)
 	m_textureIDs[static_cast<int>(ANIMATION_STATE::IDLE_LEFT)] = TextureManager::AddTexture("Resources/players/warrior/spr_warrior_idle_left.png");
 
 	// Set initial sprite.
-	SetSprite(TextureManager::GetTexture(m_textureIDs[static_cast<int>(ANIMATION_STATE::WALK_UP)]), false, 8, 12);
+	SetSprite(TextureManager::GetRegion(m_textureIDs[static_cast<int>(ANIMATION_STATE::WALK_UP)]), false, 8, 12);
 	m_currentTextureIndex = static_cast<int>(ANIMATION_STATE::WALK_UP);
 	m_sprite.setOrigin(sf::Vector2f(13.f, 18.f));
 
 	// Create the player's aim sprite.
 	int textureID = TextureManager::AddTexture("Resources/ui/spr_aim.png");
-	m_aimSprite.setTexture(TextureManager::GetTexture(textureID));
+	TextureManager::SetSpriteRegion(m_aimSprite, textureID);
 	m_aimSprite.setOrigin(sf::Vector2f(16.5f, 16.5f));
 	m_aimSprite.setScale(2.f, 2.f);
 
@@ -114,7 +114,7 @@ void Player::Update(float timeDelta, Level& level)
 	if (m_currentTextureIndex != static_cast<int>(animState))
 	{
 		m_currentTextureIndex = static_cast<int>(animState);
-		m_sprite.setTexture(TextureManager::GetTexture(m_textureIDs[m_currentTextureIndex]));
+		SetFrameRegion(TextureManager::GetRegion(m_textureIDs[m_currentTextureIndex]));
 	}
 
 	// set animation speed
@@ -130,7 +130,7 @@ void Player::Update(float timeDelta, Level& level)
 			{
 				m_currentTextureIndex += 4;
 			}
-			m_sprite.setTexture(TextureManager::GetTexture(m_textureIDs[m_currentTextureIndex]));
+			SetFrameRegion(TextureManager::GetRegion(m_textureIDs[m_currentTextureIndex]));
 
 			// Stop movement animations.
 			SetAnimated(false);
@@ -146,7 +146,7 @@ void Player::Update(float timeDelta, Level& level)
 			{
 				m_currentTextureIndex -= 4;
 			}
-			m_sprite.setTexture(TextureManager::GetTexture(m_textureIDs[m_currentTextureIndex]));
+			SetFrameRegion(TextureManager::GetRegion(m_textureIDs[m_currentTextureIndex]));
 
 			// Start movement animations.
 			SetAnimated(true);
@@ -233,7 +233,7 @@ void Player::Damage(int damage)
 bool Player::CausesCollision(sf::Vector2f movement, Level& level)
 {
 	// Get the tiles that the four corners other player are overlapping with.
-	Tile* overlappingTiles[4];
+	Tile overlappingTiles[4];
 	sf::Vector2f newPosition = m_position + movement;
 
 	// Top left.
@@ -251,7 +251,7 @@ bool Player::CausesCollision(sf::Vector2f movement, Level& level)
 	// If any of the overlapping tiles are solid there was a collision.
 	for (int i = 0; i < 4; i++)
 	{
-		if (level.IsSolid(overlappingTiles[i]->columnIndex, overlappingTiles[i]->rowIndex))
+		if (level.IsSolid(overlappingTiles[i].columnIndex, overlappingTiles[i].rowIndex))
 			return true;
 	}
 
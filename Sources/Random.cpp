@@ -0,0 +1,72 @@
+#include "Random.h"
+
+// Default constructor.
+Random::Random() :
+Random(0, static_cast<std::uint64_t>(0))
+{
+}
+
+// Constructor.
+Random::Random(std::uint64_t seed, std::uint64_t streamId) :
+m_key(Mix(seed ^ Mix((streamId + 1) * RANDOM_GAMMA))),
+m_counter(0)
+{
+}
+
+// Constructor.
+Random::Random(std::uint64_t seed, RANDOM_STREAM stream) :
+Random(seed, static_cast<std::uint64_t>(stream))
+{
+}
+
+// Derives an independent child stream.
+Random Random::Split(std::uint64_t id) const
+{
+	return Random(m_key, id);
+}
+
+// Gets a value of the stream by its position.
+std::uint64_t Random::Peek(std::uint64_t counter) const
+{
+	return Mix(m_key + (counter * RANDOM_GAMMA));
+}
+
+// Gets a random integer in an inclusive range.
+int Random::Range(int min, int max)
+{
+	if (max <= min)
+	{
+		return min;
+	}
+
+	// Scale the top 32 bits into the range with a multiply instead of a modulo.
+	std::uint64_t span = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1;
+	return static_cast<int>(static_cast<std::int64_t>(min) + static_cast<std::int64_t>(((Next() >> 32) * span) >> 32));
+}
+
+// Gets a random float in the range [0, 1).
+float Random::NextFloat()
+{
+	// 24 bits fill the mantissa of a float exactly.
+	return static_cast<float>(Next() >> 40) * (1.f / 16777216.f);
+}
+
+// Fills a buffer with the next values of the stream.
+void Random::FillBuffer(std::uint64_t* buffer, std::size_t count)
+{
+	std::uint64_t key = m_key;
+	std::uint64_t counter = m_counter;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		buffer[i] = Mix(key + ((counter + i) * RANDOM_GAMMA));
+	}
+
+	m_counter += count;
+}
+
+// Gets the number of values drawn from the stream so far.
+std::uint64_t Random::GetCounter() const
+{
+	return m_counter;
+}
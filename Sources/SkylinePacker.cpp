@@ -0,0 +1,162 @@
+#include <climits>
+#include "SkylinePacker.h"
+
+// Constructor.
+SkylinePacker::SkylinePacker(int width, int height) :
+m_width(width),
+m_height(height),
+m_usedArea(0)
+{
+	Reset();
+}
+
+// Empties the page.
+void SkylinePacker::Reset()
+{
+	m_skyline.clear();
+	m_skyline.push_back({ 0, 0, m_width });
+	m_usedArea = 0;
+}
+
+// Places a rectangle on the page.
+bool SkylinePacker::Insert(int width, int height, GridCoord& position)
+{
+	if ((width <= 0) || (height <= 0))
+	{
+		return false;
+	}
+
+	int bestIndex = -1;
+	int bestBottom = INT_MAX;
+	int bestWidth = INT_MAX;
+	int bestY = 0;
+
+	// Take the spot where the rectangle's bottom edge is lowest. Ties go to the narrowest segment, so wide
+	// segments are kept for wide rectangles.
+	for (int s = 0; s < static_cast<int>(m_skyline.size()); ++s)
+	{
+		int y;
+
+		if (!Fit(s, width, height, y))
+		{
+			continue;
+		}
+
+		int bottom = y + height;
+
+		if ((bottom < bestBottom) || ((bottom == bestBottom) && (m_skyline[s].width < bestWidth)))
+		{
+			bestIndex = s;
+			bestBottom = bottom;
+			bestWidth = m_skyline[s].width;
+			bestY = y;
+		}
+	}
+
+	if (bestIndex < 0)
+	{
+		return false;
+	}
+
+	position = { m_skyline[bestIndex].x, bestY };
+	AddSkylineLevel(bestIndex, bestY, width, height);
+	m_usedArea += static_cast<std::uint64_t>(width) * height;
+
+	return true;
+}
+
+// Gets the width of the page.
+int SkylinePacker::GetWidth() const
+{
+	return m_width;
+}
+
+// Gets the height of the page.
+int SkylinePacker::GetHeight() const
+{
+	return m_height;
+}
+
+// Gets how much of the page the placed rectangles cover.
+double SkylinePacker::GetOccupancy() const
+{
+	double area = static_cast<double>(m_width) * m_height;
+	return (area > 0.0) ? (m_usedArea / area) : 0.0;
+}
+
+// Finds the row a rectangle would sit on if its left edge was at a segment.
+bool SkylinePacker::Fit(int index, int width, int height, int& y) const
+{
+	if (m_skyline[index].x + width > m_width)
+	{
+		return false;
+	}
+
+	// The rectangle rests on the highest segment it spans.
+	int remaining = width;
+	y = 0;
+
+	for (int s = index; remaining > 0; ++s)
+	{
+		if (m_skyline[s].y > y)
+		{
+			y = m_skyline[s].y;
+		}
+
+		if (y + height > m_height)
+		{
+			return false;
+		}
+
+		remaining -= m_skyline[s].width;
+	}
+
+	return true;
+}
+
+// Raises the skyline under a placed rectangle.
+void SkylinePacker::AddSkylineLevel(int index, int y, int width, int height)
+{
+	Segment level = { m_skyline[index].x, y + height, width };
+	m_skyline.insert(m_skyline.begin() + index, level);
+
+	// Cut the segments the rectangle now covers down to the part sticking out past its right edge.
+	int right = level.x + level.width;
+	std::size_t next = index + 1;
+
+	while (next < m_skyline.size())
+	{
+		Segment& segment = m_skyline[next];
+
+		if (segment.x >= right)
+		{
+			break;
+		}
+
+		int segmentRight = segment.x + segment.width;
+
+		if (segmentRight <= right)
+		{
+			m_skyline.erase(m_skyline.begin() + next);
+			continue;
+		}
+
+		segment.width = segmentRight - right;
+		segment.x = right;
+		break;
+	}
+
+	// Merge neighbours at the same height.
+	for (std::size_t s = 0; s + 1 < m_skyline.size();)
+	{
+		if (m_skyline[s].y == m_skyline[s + 1].y)
+		{
+			m_skyline[s].width += m_skyline[s + 1].width;
+			m_skyline.erase(m_skyline.begin() + s + 1);
+		}
+		else
+		{
+			++s;
+		}
+	}
+}
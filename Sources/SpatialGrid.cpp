@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+#include "SpatialGrid.h"
+
+// Constructor.
+SpatialGrid::SpatialGrid(float cellSize) :
+m_cellSize((cellSize > 0.f) ? cellSize : 1.f),
+m_left(0.f),
+m_top(0.f),
+m_columns(1),
+m_rows(1),
+m_cells(1),
+m_count(0)
+{
+}
+
+// Sets the area the cells cover, and removes every object.
+void SpatialGrid::Reset(float left, float top, float width, float height)
+{
+	m_left = left;
+	m_top = top;
+	m_columns = std::max(1, static_cast<int>(std::ceil(width / m_cellSize)));
+	m_rows = std::max(1, static_cast<int>(std::ceil(height / m_cellSize)));
+
+	// Only grow, so cells keep the memory they already have.
+	if (m_cells.size() < static_cast<size_t>(m_columns) * m_rows)
+	{
+		m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+	}
+
+	Clear();
+}
+
+// Removes every object, keeping the area.
+void SpatialGrid::Clear()
+{
+	for (std::vector<int>& cell : m_cells)
+	{
+		cell.clear();
+	}
+
+	m_count = 0;
+}
+
+// Adds an object.
+void SpatialGrid::Insert(int id, float x, float y)
+{
+	m_cells[(GetRow(y) * m_columns) + GetColumn(x)].push_back(id);
+	++m_count;
+}
+
+// Finds the objects in the cells a rectangle touches.
+void SpatialGrid::Query(float left, float top, float right, float bottom, std::vector<int>& ids) const
+{
+	ids.clear();
+
+	int lastColumn = GetColumn(right);
+	int lastRow = GetRow(bottom);
+
+	for (int row = GetRow(top); row <= lastRow; ++row)
+	{
+		for (int column = GetColumn(left); column <= lastColumn; ++column)
+		{
+			const std::vector<int>& cell = m_cells[(row * m_columns) + column];
+			ids.insert(ids.end(), cell.begin(), cell.end());
+		}
+	}
+
+	// Callers draw in id order, so objects overlap the same way whichever cells they were found in.
+	std::sort(ids.begin(), ids.end());
+}
+
+// Gets the number of objects in the grid.
+int SpatialGrid::GetCount() const
+{
+	return m_count;
+}
+
+// Gets the column of the cell a horizontal position is in, clamped to the area.
+int SpatialGrid::GetColumn(float x) const
+{
+	float column = std::floor((x - m_left) / m_cellSize);
+	return static_cast<int>(std::min(std::max(column, 0.f), static_cast<float>(m_columns - 1)));
+}
+
+// Gets the row of the cell a vertical position is in, clamped to the area.
+int SpatialGrid::GetRow(float y) const
+{
+	float row = std::floor((y - m_top) / m_cellSize);
+	return static_cast<int>(std::min(std::max(row, 0.f), static_cast<float>(m_rows - 1)));
+}
@@ -1,7 +1,11 @@
+#include <algorithm>
 #include "PCH.h"
 
 std::map<std::string, std::pair<int, std::unique_ptr<sf::Texture>>> TextureManager::m_textures;
 int TextureManager::m_currentId = -1;
+std::map<int, TextureRegion> TextureManager::m_regions;
+std::vector<std::unique_ptr<sf::Texture>> TextureManager::m_atlasPages;
+std::vector<SkylinePacker> TextureManager::m_atlasPackers;
 
 // Default Constructor.
 TextureManager::TextureManager()
@@ -22,13 +26,21 @@ int TextureManager::AddTexture(std::string filePath)
 	// At this point the texture doesn't exists, so we'll create and add it.
 	m_currentId++;
 
+	// Load the image first, so it can be copied onto an atlas page without reading the texture back.
+	sf::Image image;
+	if (!image.loadFromFile(filePath))
+	{
+		return -1;
+	}
+
 	std::unique_ptr<sf::Texture> texture = std::make_unique<sf::Texture>();
-	if (!texture->loadFromFile(filePath))
+	if (!texture->loadFromImage(image))
 	{
 		return -1;
 	}
 
 	m_textures.insert(std::make_pair(filePath, std::make_pair(m_currentId, std::move(texture))));
+	m_regions[m_currentId] = PackImage(m_currentId, image);
 
 	// Return the texture.
 	return m_currentId;
@@ -37,6 +49,9 @@ int TextureManager::AddTexture(std::string filePath)
 // Removes a texture from the manager from a given id.
 void TextureManager::RemoveTexture(int textureID)
 {
+	// The image's space on its atlas page isn't reused.
+	m_regions.erase(textureID);
+
 	for (auto it = m_textures.begin(); it != m_textures.end(); ++it)
 	{
 		if (it->second.first == textureID)
@@ -57,3 +72,80 @@ sf::Texture& TextureManager::GetTexture(int textureID)
 		}
 	}
 }
+
+// Gets where an image lives on the atlas.
+const TextureRegion& TextureManager::GetRegion(int textureID)
+{
+	static const TextureRegion missingRegion = { nullptr, sf::IntRect(), -1 };
+
+	auto it = m_regions.find(textureID);
+	return (it != m_regions.end()) ? it->second : missingRegion;
+}
+
+// Points a sprite at an image's region.
+void TextureManager::SetSpriteRegion(sf::Sprite& sprite, int textureID)
+{
+	const TextureRegion& region = GetRegion(textureID);
+
+	if (region.texture)
+	{
+		sprite.setTexture(*region.texture);
+		sprite.setTextureRect(region.rect);
+	}
+}
+
+// Gets the number of atlas pages created so far.
+int TextureManager::GetAtlasPageCount()
+{
+	return static_cast<int>(m_atlasPages.size());
+}
+
+// Gets an atlas page.
+const sf::Texture& TextureManager::GetAtlasPage(int page)
+{
+	return *m_atlasPages[page];
+}
+
+// Copies an image onto an atlas page.
+TextureRegion TextureManager::PackImage(int textureID, const sf::Image& image)
+{
+	int pageSize = std::min(ATLAS_PAGE_SIZE, static_cast<int>(sf::Texture::getMaximumSize()));
+	sf::Vector2u imageSize = image.getSize();
+	int width = static_cast<int>(imageSize.x);
+	int height = static_cast<int>(imageSize.y);
+
+	// Images that can't share a page keep drawing from their own texture.
+	if ((width + (2 * ATLAS_PADDING) > pageSize) || (height + (2 * ATLAS_PADDING) > pageSize))
+	{
+		return TextureRegion{ &GetTexture(textureID), sf::IntRect(0, 0, width, height), -1 };
+	}
+
+	GridCoord position;
+	int page = 0;
+
+	while ((page < static_cast<int>(m_atlasPackers.size())) &&
+		(!m_atlasPackers[page].Insert(width + (2 * ATLAS_PADDING), height + (2 * ATLAS_PADDING), position)))
+	{
+		++page;
+	}
+
+	// Nothing had room, so start a new page. It starts transparent, so the padding around each image is too.
+	if (page == static_cast<int>(m_atlasPackers.size()))
+	{
+		sf::Image blank;
+		blank.create(pageSize, pageSize, sf::Color::Transparent);
+
+		std::unique_ptr<sf::Texture> atlasPage = std::make_unique<sf::Texture>();
+		atlasPage->loadFromImage(blank);
+
+		m_atlasPages.push_back(std::move(atlasPage));
+		m_atlasPackers.push_back(SkylinePacker(pageSize, pageSize));
+		m_atlasPackers.back().Insert(width + (2 * ATLAS_PADDING), height + (2 * ATLAS_PADDING), position);
+	}
+
+	int x = position.x + ATLAS_PADDING;
+	int y = position.y + ATLAS_PADDING;
+	m_atlasPages[page]->update(image, x, y);
+
+	return TextureRegion{ m_atlasPages[page].get(), sf::IntRect(x, y, width, height), page };
+}
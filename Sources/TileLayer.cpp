@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include "PCH.h"
+#include "TileLayer.h"
+
+namespace
+{
+	// Every quad is two triangles.
+	const int VERTICES_PER_QUAD = 6;
+}
+
+// Constructor.
+TileLayer::TileLayer(int tileSize) :
+m_tileSize(tileSize),
+m_width(0),
+m_height(0),
+m_chunkColumns(0),
+m_chunkRows(0),
+m_version(0),
+m_isDirty(true)
+{
+	std::fill(std::begin(m_typeTextures), std::end(m_typeTextures), -1);
+}
+
+// Sets the part of a texture a tile type is drawn with.
+void TileLayer::SetTileTexture(TILE tileType, const sf::Texture& texture, const sf::IntRect& textureRect)
+{
+	auto it = std::find(m_textures.begin(), m_textures.end(), &texture);
+
+	if (it == m_textures.end())
+	{
+		it = m_textures.insert(m_textures.end(), &texture);
+	}
+
+	m_typeTextures[static_cast<int>(tileType)] = static_cast<int>(it - m_textures.begin());
+	m_typeRects[static_cast<int>(tileType)] = textureRect;
+	m_isDirty = true;
+}
+
+// Rebuilds the quads of every tile.
+void TileLayer::Build(const LevelGrid& grid)
+{
+	m_width = grid.GetWidth();
+	m_height = grid.GetHeight();
+	m_chunkColumns = (m_width + TILE_LAYER_CHUNK_SIZE - 1) / TILE_LAYER_CHUNK_SIZE;
+	m_chunkRows = (m_height + TILE_LAYER_CHUNK_SIZE - 1) / TILE_LAYER_CHUNK_SIZE;
+	m_isDirty = false;
+
+	// Pages are reused from the last build, so their vertex arrays keep their memory.
+	m_pages.resize(static_cast<size_t>(m_chunkColumns) * m_chunkRows * m_textures.size());
+
+	for (size_t p = 0; p < m_pages.size(); ++p)
+	{
+		Page& page = m_pages[p];
+		page.texture = m_textures[p % m_textures.size()];
+		page.vertices.setPrimitiveType(sf::Triangles);
+		page.vertices.clear();
+		page.tiles.clear();
+	}
+
+	m_tileTypes.resize(static_cast<size_t>(m_width) * m_height);
+	m_tileQuads.assign(static_cast<size_t>(m_width) * m_height, -1);
+
+	for (int j = 0; j < m_height; ++j)
+	{
+		const std::uint8_t* types = grid.GetTypeRow(j);
+
+		for (int i = 0; i < m_width; ++i)
+		{
+			AddQuad((j * m_width) + i, types[i]);
+		}
+	}
+}
+
+// Brings the quads up to date with the recorded changes.
+void TileLayer::Update(const LevelGrid& grid, const ChangeJournal& journal)
+{
+	bool isCurrent = (!m_isDirty) && (grid.GetWidth() == m_width) && (grid.GetHeight() == m_height) &&
+		(journal.GetChangesSince(m_version, m_changes));
+
+	if (!isCurrent)
+	{
+		Build(grid);
+		m_version = journal.GetVersion();
+		return;
+	}
+
+	for (const DirtyRegion& region : m_changes)
+	{
+		int firstColumn = std::max(region.firstColumn, 0);
+		int lastColumn = std::min(region.lastColumn, m_width - 1);
+
+		for (int j = std::max(region.firstRow, 0); j <= std::min(region.lastRow, m_height - 1); ++j)
+		{
+			const std::uint8_t* types = grid.GetTypeRow(j);
+
+			for (int i = firstColumn; i <= lastColumn; ++i)
+			{
+				int tile = (j * m_width) + i;
+
+				if (types[i] != m_tileTypes[tile])
+				{
+					RemoveQuad(tile);
+					AddQuad(tile, types[i]);
+				}
+			}
+		}
+	}
+
+	m_version = journal.GetVersion();
+}
+
+// Gets the number of draw calls the layer takes.
+int TileLayer::GetDrawCallCount() const
+{
+	int drawCallCount = 0;
+
+	for (const Page& page : m_pages)
+	{
+		drawCallCount += (page.vertices.getVertexCount() > 0) ? 1 : 0;
+	}
+
+	return drawCallCount;
+}
+
+// Draws the pages of the chunks the target's view overlaps.
+void TileLayer::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	if (m_pages.empty())
+	{
+		return;
+	}
+
+	// Bring the view into the layer's own coordinates, then find the chunks under it.
+	const sf::View& view = target.getView();
+	sf::FloatRect viewArea(view.getCenter() - (view.getSize() / 2.f), view.getSize());
+	sf::FloatRect area = states.transform.getInverse().transformRect(viewArea);
+
+	float chunkSize = static_cast<float>(m_tileSize * TILE_LAYER_CHUNK_SIZE);
+	int firstColumn = std::max(0, static_cast<int>(std::floor(area.left / chunkSize)));
+	int firstRow = std::max(0, static_cast<int>(std::floor(area.top / chunkSize)));
+	int lastColumn = std::min(m_chunkColumns - 1, static_cast<int>(std::floor((area.left + area.width) / chunkSize)));
+	int lastRow = std::min(m_chunkRows - 1, static_cast<int>(std::floor((area.top + area.height) / chunkSize)));
+	int textureCount = static_cast<int>(m_textures.size());
+
+	for (int row = firstRow; row <= lastRow; ++row)
+	{
+		for (int column = firstColumn; column <= lastColumn; ++column)
+		{
+			int firstPage = ((row * m_chunkColumns) + column) * textureCount;
+
+			for (int p = firstPage; p < firstPage + textureCount; ++p)
+			{
+				const Page& page = m_pages[p];
+
+				if (page.vertices.getVertexCount() > 0)
+				{
+					states.texture = page.texture;
+					target.draw(page.vertices, states);
+				}
+			}
+		}
+	}
+}
+
+// Adds the quad of a tile to the page of its type.
+void TileLayer::AddQuad(int tile, std::uint8_t tileType)
+{
+	m_tileTypes[tile] = tileType;
+
+	int texture = (tileType < static_cast<int>(TILE::COUNT)) ? m_typeTextures[tileType] : -1;
+
+	if (texture < 0)
+	{
+		m_tileQuads[tile] = -1;
+		return;
+	}
+
+	Page& page = m_pages[GetPageIndex(tile, texture)];
+	const sf::IntRect& rect = m_typeRects[tileType];
+
+	float left = static_cast<float>((tile % m_width) * m_tileSize);
+	float top = static_cast<float>((tile / m_width) * m_tileSize);
+	float right = left + rect.width;
+	float bottom = top + rect.height;
+
+	float textureLeft = static_cast<float>(rect.left);
+	float textureTop = static_cast<float>(rect.top);
+	float textureRight = static_cast<float>(rect.left + rect.width);
+	float textureBottom = static_cast<float>(rect.top + rect.height);
+
+	m_tileQuads[tile] = static_cast<int>(page.tiles.size());
+	page.tiles.push_back(tile);
+
+	page.vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(textureLeft, textureTop)));
+	page.vertices.append(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(textureRight, textureTop)));
+	page.vertices.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(textureRight, textureBottom)));
+	page.vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(textureLeft, textureTop)));
+	page.vertices.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(textureRight, textureBottom)));
+	page.vertices.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(textureLeft, textureBottom)));
+}
+
+// Removes the quad of a tile from its page.
+void TileLayer::RemoveQuad(int tile)
+{
+	int quad = m_tileQuads[tile];
+
+	if (quad < 0)
+	{
+		return;
+	}
+
+	Page& page = m_pages[GetPageIndex(tile, m_typeTextures[m_tileTypes[tile]])];
+	int lastQuad = static_cast<int>(page.tiles.size()) - 1;
+
+	if (quad != lastQuad)
+	{
+		for (int v = 0; v < VERTICES_PER_QUAD; ++v)
+		{
+			page.vertices[(quad * VERTICES_PER_QUAD) + v] = page.vertices[(lastQuad * VERTICES_PER_QUAD) + v];
+		}
+
+		page.tiles[quad] = page.tiles[lastQuad];
+		m_tileQuads[page.tiles[quad]] = quad;
+	}
+
+	page.tiles.pop_back();
+	page.vertices.resize(static_cast<size_t>(lastQuad) * VERTICES_PER_QUAD);
+	m_tileQuads[tile] = -1;
+}
+
+// Gets the page a tile's quad goes in.
+int TileLayer::GetPageIndex(int tile, int texture) const
+{
+	int chunk = ((((tile / m_width) / TILE_LAYER_CHUNK_SIZE) * m_chunkColumns) + ((tile % m_width) / TILE_LAYER_CHUNK_SIZE));
+	return (chunk * static_cast<int>(m_textures.size())) + texture;
+}
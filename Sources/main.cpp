@@ -1,15 +1,15 @@
+#include <string>
 #include "PCH.h"
 #include "Game.h"
 
-// Entry point of the application.
-int main()
+// Entry point of the application. Pass --endless to play in an endless dungeon instead of the level file.
+int main(int argc, char* argv[])
 {
-	// Set a random seed.
-	srand(42);
+	bool isEndless = (argc > 1) && (std::string(argv[1]) == "--endless");
 
-	// Create the main game object.
+	// Create the main game object. Every random stream in the game is derived from its seed.
 	sf::RenderWindow window(sf::VideoMode::getDesktopMode(), "Roguelike Template", sf::Style::Fullscreen);
-	Game game(&window);
+	Game game(&window, 42, isEndless);
 
 	// Initialize and run the game object.
 	game.Initialize();